@@ -114,6 +114,18 @@ Additional information:
   #define BUFFER_SIZE_DOWN                                16    // Size of the buffer for terminal input to target from host (Usually keyboard input)
 #endif
 
+#ifndef   SEGGER_RTT_BUFFER_SIZE_POW2
+  #define SEGGER_RTT_BUFFER_SIZE_POW2                     0     // 1: All up-buffers have a power of 2 size, offsets wrap by a mask
+#endif
+
+#ifndef   SEGGER_RTT_STATS
+  #define SEGGER_RTT_STATS                                0     // 1: Count statistics of each up-buffer in _SEGGER_RTT_Stats
+#endif
+
+#ifndef   SEGGER_RTT_POSTMORTEM
+  #define SEGGER_RTT_POSTMORTEM                           0     // 1: Up-buffer in no-init RAM which keeps its content over a reset
+#endif
+
 #ifndef   SEGGER_RTT_MAX_NUM_UP_BUFFERS
   #define SEGGER_RTT_MAX_NUM_UP_BUFFERS                    2    // Number of up-buffers (T->H) available on this target
 #endif
@@ -208,7 +220,7 @@ Additional information:
   #define SEGGER_RTT_ALIGN(Var, Alignment) Var
 #endif
 
-#if defined(SEGGER_RTT_SECTION) || defined (SEGGER_RTT_BUFFER_SECTION)
+#if defined(SEGGER_RTT_SECTION) || defined (SEGGER_RTT_BUFFER_SECTION) || SEGGER_RTT_POSTMORTEM
   #if ((defined __GNUC__) || (defined __clang__))
     #define SEGGER_RTT_PUT_SECTION(Var, Section) __attribute__ ((section (Section))) Var
   #elif (defined __ICCARM__) || (defined __ICCRX__)
@@ -248,6 +260,25 @@ Additional information:
   #define SEGGER_RTT_PUT_BUFFER_SECTION(Var) Var
 #endif
 
+//
+// Power of 2 up-buffers: <WrOff> and <RdOff> still stay in [0, SizeOfBuffer) as J-Link expects,
+// but wrap-around and free space are computed by masking, without compare and branch.
+//
+#if SEGGER_RTT_BUFFER_SIZE_POW2
+  #if (BUFFER_SIZE_UP & (BUFFER_SIZE_UP - 1))
+    #error "SEGGER_RTT_BUFFER_SIZE_POW2 needs a power of 2 BUFFER_SIZE_UP"
+  #endif
+  #define SEGGER_RTT__WRAP(pRing, Off)          ((Off) & ((pRing)->SizeOfBuffer - 1u))
+  #define SEGGER_RTT__FREE(pRing, RdOff, WrOff) (((RdOff) - (WrOff) - 1u) & ((pRing)->SizeOfBuffer - 1u))
+#endif
+
+#if SEGGER_RTT_POSTMORTEM
+  #define SEGGER_RTT_POSTMORTEM_MAGIC           0x4D505452u   // "RTPM"
+  #if SEGGER_RTT_BUFFER_SIZE_POW2 && (SEGGER_RTT_POSTMORTEM_SIZE & (SEGGER_RTT_POSTMORTEM_SIZE - 1))
+    #error "SEGGER_RTT_BUFFER_SIZE_POW2 needs a power of 2 SEGGER_RTT_POSTMORTEM_SIZE"
+  #endif
+#endif
+
 /*********************************************************************
 *
 *       Static const data
@@ -281,8 +312,43 @@ static unsigned char _aTerminalId[16] = { '0', '1', '2', '3', '4', '5', '6', '7'
   SEGGER_RTT_PUT_BUFFER_SECTION(SEGGER_RTT_BUFFER_ALIGN(static char _acDownBuffer[BUFFER_SIZE_DOWN]));
 #endif
 
+#if SEGGER_RTT_STATS
+SEGGER_RTT_PUT_CB_SECTION(SEGGER_RTT_STATS_CB _SEGGER_RTT_Stats);   // Next to the control block, so the host finds it in the same memory
+#endif
+
+#if SEGGER_RTT_POSTMORTEM
+SEGGER_RTT_PUT_SECTION(SEGGER_RTT_BUFFER_ALIGN(SEGGER_RTT_POSTMORTEM_CB _SEGGER_RTT_PostMortem), SEGGER_RTT_POSTMORTEM_SECTION);  // Not initialized by the startup code nor by SEGGER_RTT_Init()
+static unsigned _PostMortemIndex;     // Up-buffer of _SEGGER_RTT_PostMortem, 0: not configured
+static unsigned _PostMortemSeq;       // <Seq> of the last saved state
+#endif
+
 static unsigned char _ActiveTerminal;
 
+#if SEGGER_RTT_LOCKFREE
+static unsigned _aUpResState[SEGGER_RTT_MAX_NUM_UP_BUFFERS];     // Reservation word of SEGGER_RTT_WriteLockFree(): [31:16] reserve offset, [15:8] lap, [7:0] writers in progress
+#endif
+
+#if ((defined __GNUC__) || (defined __clang__)) && (defined __linux__)
+pthread_mutex_t SEGGER_RTT_Mutex = PTHREAD_MUTEX_INITIALIZER;     // Used by SEGGER_RTT_LOCK() on Linux host builds, see SEGGER_RTT_Conf.h
+
+/*********************************************************************
+*
+*       _InitMutex()
+*
+*  Function description
+*    Makes SEGGER_RTT_Mutex recursive before main(), so SEGGER_RTT_LOCK()
+*    nests like the interrupt lock of the target.
+*/
+__attribute__((constructor)) static void _InitMutex(void) {
+  pthread_mutexattr_t Attr;
+
+  pthread_mutexattr_init(&Attr);
+  pthread_mutexattr_settype(&Attr, PTHREAD_MUTEX_RECURSIVE);
+  pthread_mutex_init(&SEGGER_RTT_Mutex, &Attr);
+  pthread_mutexattr_destroy(&Attr);
+}
+#endif
+
 /*********************************************************************
 *
 *       Static functions
@@ -312,6 +378,9 @@ static unsigned char _ActiveTerminal;
 static void _DoInit(void) {
   volatile SEGGER_RTT_CB* p;   // Volatile to make sure that compiler cannot change the order of accesses to the control block
   static const char _aInitStr[] = "\0\0\0\0\0\0TTR REGGES";  // Init complete ID string to make sure that things also work if RTT is linked to a no-init memory area
+#if SEGGER_RTT_STATS
+  static const char _aStatsStr[] = "\0\0\0\0\0\0STATS TTR";  // ID of _SEGGER_RTT_Stats, copied backwards like the one of the control block
+#endif
   unsigned i;
   //
   // Initialize control block
@@ -338,6 +407,16 @@ static void _DoInit(void) {
   p->aDown[0].RdOff         = 0u;
   p->aDown[0].WrOff         = 0u;
   p->aDown[0].Flags         = SEGGER_RTT_MODE_DEFAULT;
+#if SEGGER_RTT_STATS
+  //
+  // Initialize statistics before the control block is complete, so the host never sees a control block without them
+  //
+  memset(&_SEGGER_RTT_Stats, 0, sizeof(_SEGGER_RTT_Stats));
+  _SEGGER_RTT_Stats.MaxNumUpBuffers = SEGGER_RTT_MAX_NUM_UP_BUFFERS;
+  for (i = 0; i < sizeof(_aStatsStr) - 1; ++i) {
+    _SEGGER_RTT_Stats.acID[i] = _aStatsStr[sizeof(_aStatsStr) - 2 - i];
+  }
+#endif
   //
   // Finish initialization of the control block.
   // Copy Id string backwards to make sure that "SEGGER RTT" is not found in initializer memory (usually flash),
@@ -382,11 +461,15 @@ static unsigned _WriteBlocking(SEGGER_RTT_BUFFER_UP* pRing, const char* pBuffer,
   WrOff = pRing->WrOff;
   do {
     RdOff = pRing->RdOff;                         // May be changed by host (debug probe) in the meantime
+#if SEGGER_RTT_BUFFER_SIZE_POW2
+    NumBytesToWrite = SEGGER_RTT__FREE(pRing, RdOff, WrOff);
+#else
     if (RdOff > WrOff) {
       NumBytesToWrite = RdOff - WrOff - 1u;
     } else {
       NumBytesToWrite = pRing->SizeOfBuffer - (WrOff - RdOff + 1u);
     }
+#endif
     NumBytesToWrite = MIN(NumBytesToWrite, (pRing->SizeOfBuffer - WrOff));      // Number of bytes that can be written until buffer wrap-around
     NumBytesToWrite = MIN(NumBytesToWrite, NumBytes);
     pDst = (pRing->pBuffer + WrOff) + SEGGER_RTT_UNCACHED_OFF;
@@ -404,9 +487,13 @@ static unsigned _WriteBlocking(SEGGER_RTT_BUFFER_UP* pRing, const char* pBuffer,
     NumBytes        -= NumBytesToWrite;
     WrOff           += NumBytesToWrite;
 #endif
+#if SEGGER_RTT_BUFFER_SIZE_POW2
+    WrOff = SEGGER_RTT__WRAP(pRing, WrOff);
+#else
     if (WrOff == pRing->SizeOfBuffer) {
       WrOff = 0u;
     }
+#endif
     RTT__DMB();                     // Force data write to be complete before writing the <WrOff>, in case CPU is allowed to change the order of memory accesses
     pRing->WrOff = WrOff;
   } while (NumBytes);
@@ -531,14 +618,211 @@ static unsigned _GetAvailWriteSpace(SEGGER_RTT_BUFFER_UP* pRing) {
   //
   RdOff = pRing->RdOff;
   WrOff = pRing->WrOff;
+#if SEGGER_RTT_BUFFER_SIZE_POW2
+  r = SEGGER_RTT__FREE(pRing, RdOff, WrOff);
+#else
   if (RdOff <= WrOff) {
     r = pRing->SizeOfBuffer - 1u - WrOff + RdOff;
   } else {
     r = RdOff - WrOff - 1u;
   }
+#endif
   return r;
 }
 
+#if SEGGER_RTT_STATS
+/*********************************************************************
+*
+*       _StatsWrite()
+*
+*  Function description
+*    Counts a write to an up-buffer in _SEGGER_RTT_Stats.
+*    A message of which nothing has been stored is dropped,
+*    one of which a part has been stored is trimmed.
+*
+*  Parameters
+*    BufferIndex      Index of the up-buffer.
+*    pRing            Ring buffer which has been written.
+*    NumBytes         Number of bytes of the message.
+*    NumBytesWritten  Number of bytes which have been stored.
+*/
+static void _StatsWrite(unsigned BufferIndex, SEGGER_RTT_BUFFER_UP* pRing, unsigned NumBytes, unsigned NumBytesWritten) {
+  SEGGER_RTT_BUFFER_STATS* pStats;
+  unsigned                 Fill;
+
+  pStats = &_SEGGER_RTT_Stats.aUp[BufferIndex];
+  if (NumBytesWritten == 0u) {
+    if (NumBytes != 0u) {
+      pStats->NumMsgDropped++;
+      pStats->NumMsgLost++;
+      pStats->NumBytesDropped += NumBytes;
+    }
+    return;
+  }
+  pStats->NumBytesWritten += NumBytesWritten;
+  pStats->NumBytesTrimmed += NumBytes - NumBytesWritten;
+  Fill = pRing->SizeOfBuffer - 1u - _GetAvailWriteSpace(pRing);
+  if (Fill > pStats->MaxFill) {
+    pStats->MaxFill = Fill;
+  }
+}
+
+/*********************************************************************
+*
+*       _StatsMarkLost()
+*
+*  Function description
+*    Writes "--- N messages lost ---\n" into an up-buffer with SEGGER_RTT_FLAG_MARK_LOST
+*    once there is space for it after messages have been dropped,
+*    so the reader sees where the gap is.
+*
+*  Parameters
+*    BufferIndex  Index of the up-buffer.
+*    pRing        Ring buffer to post to.
+*
+*  Return value
+*    == 0 - Marker is pending and does not fit yet, the next message must be dropped too to keep the marker in front of the gap.
+*    == 1 - OK, the next message may be written.
+*/
+static unsigned _StatsMarkLost(unsigned BufferIndex, SEGGER_RTT_BUFFER_UP* pRing) {
+  static const char _acHead[] = "--- ";
+  static const char _acTail[] = " messages lost ---\n";
+  SEGGER_RTT_BUFFER_STATS* pStats;
+  char                     ac[sizeof(_acHead) - 1u + 10u + sizeof(_acTail) - 1u];
+  char                     acDigits[10];
+  unsigned                 NumDigits;
+  unsigned                 NumBytes;
+  unsigned                 v;
+
+  pStats = &_SEGGER_RTT_Stats.aUp[BufferIndex];
+  v = pStats->NumMsgLost;
+  if ((v == 0u) || ((pRing->Flags & SEGGER_RTT_FLAG_MARK_LOST) == 0u)) {
+    return 1u;
+  }
+  NumDigits = 0u;
+  do {
+    acDigits[NumDigits++] = (char)('0' + v % 10u);
+    v /= 10u;
+  } while (v != 0u);
+  memcpy(ac, _acHead, sizeof(_acHead) - 1u);
+  NumBytes = sizeof(_acHead) - 1u;
+  while (NumDigits != 0u) {
+    ac[NumBytes++] = acDigits[--NumDigits];
+  }
+  memcpy(&ac[NumBytes], _acTail, sizeof(_acTail) - 1u);
+  NumBytes += sizeof(_acTail) - 1u;
+  if (_GetAvailWriteSpace(pRing) < NumBytes) {
+    return 0u;
+  }
+  _WriteNoCheck(pRing, ac, NumBytes);
+  pStats->NumBytesWritten += NumBytes;
+  pStats->NumMsgLost = 0u;
+  return 1u;
+}
+#endif
+
+#if SEGGER_RTT_POSTMORTEM
+/*********************************************************************
+*
+*       _PostMortemCrc()
+*
+*  Function description
+*    CRC-32 (IEEE 802.3) of the header of the post-mortem buffer and one state slot.
+*    Computed by nibble, so it needs a table of 16 entries only.
+*
+*  Parameters
+*    pPM      Post-mortem buffer.
+*    pState   State slot.
+*
+*  Return value
+*    CRC of <Magic>, <SizeOfBuffer>, <Seq>, <WrOff> and <RdOff>.
+*/
+static unsigned _PostMortemCrc(const volatile SEGGER_RTT_POSTMORTEM_CB* pPM, const volatile SEGGER_RTT_POSTMORTEM_STATE* pState) {
+  static const unsigned _aCrcTab[16] = {
+    0x00000000u, 0x1DB71064u, 0x3B6E20C8u, 0x26D930ACu, 0x76DC4190u, 0x6B6B51F4u, 0x4DB26158u, 0x5005713Cu,
+    0xEDB88320u, 0xF00F9344u, 0xD6D6A3E8u, 0xCB61B38Cu, 0x9B64C2B0u, 0x86D3D2D4u, 0xA00AE278u, 0xBDBDF21Cu
+  };
+  unsigned aWord[5];
+  unsigned Crc;
+  unsigned Shift;
+  unsigned i;
+
+  aWord[0] = pPM->Magic;
+  aWord[1] = pPM->SizeOfBuffer;
+  aWord[2] = pState->Seq;
+  aWord[3] = pState->WrOff;
+  aWord[4] = pState->RdOff;
+  Crc = 0xFFFFFFFFu;
+  for (i = 0; i < 5u; ++i) {
+    for (Shift = 0; Shift < 32u; Shift += 4u) {   // Low nibble first, same as the bytes of a little endian word
+      Crc = (Crc >> 4) ^ _aCrcTab[(Crc ^ (aWord[i] >> Shift)) & 0xFu];
+    }
+  }
+  return ~Crc;
+}
+
+/*********************************************************************
+*
+*       _PostMortemSave()
+*
+*  Function description
+*    Saves <WrOff> and <RdOff> of the post-mortem up-buffer into the older state slot.
+*    The CRC is written last, so a slot cut by a reset is found invalid and the other one is used.
+*
+*  Parameters
+*    pPM      Post-mortem buffer.
+*    pRing    Up-buffer of it in the control block.
+*/
+static void _PostMortemSave(volatile SEGGER_RTT_POSTMORTEM_CB* pPM, const SEGGER_RTT_BUFFER_UP* pRing) {
+  volatile SEGGER_RTT_POSTMORTEM_STATE* pState;
+  unsigned                              Seq;
+  unsigned                              Crc;
+
+  Seq           = ++_PostMortemSeq;
+  pState        = &pPM->aState[Seq & 1u];
+  pState->Seq   = Seq;
+  pState->WrOff = pRing->WrOff;
+  pState->RdOff = pRing->RdOff;
+  Crc           = _PostMortemCrc(pPM, pState);
+  RTT__DMB();                       // Force order of memory accesses for cores that may perform out-of-order memory accesses
+  pState->Crc   = Crc;
+}
+
+/*********************************************************************
+*
+*       _PostMortemFind()
+*
+*  Function description
+*    Finds the last valid state of the post-mortem buffer after a reset.
+*
+*  Parameters
+*    pPM      Post-mortem buffer.
+*
+*  Return value
+*    != NULL - Last saved state.
+*    == NULL - No valid state, e.g. after power-on or if the RAM has been overwritten.
+*/
+static const volatile SEGGER_RTT_POSTMORTEM_STATE* _PostMortemFind(const volatile SEGGER_RTT_POSTMORTEM_CB* pPM) {
+  const volatile SEGGER_RTT_POSTMORTEM_STATE* pState;
+  const volatile SEGGER_RTT_POSTMORTEM_STATE* pFound;
+  unsigned                                    i;
+
+  if ((pPM->Magic != SEGGER_RTT_POSTMORTEM_MAGIC) || (pPM->SizeOfBuffer != SEGGER_RTT_POSTMORTEM_SIZE)) {
+    return NULL;
+  }
+  pFound = NULL;
+  for (i = 0; i < 2u; ++i) {
+    pState = &pPM->aState[i];
+    if ((pState->Crc == _PostMortemCrc(pPM, pState)) && (pState->WrOff < SEGGER_RTT_POSTMORTEM_SIZE) && (pState->RdOff < SEGGER_RTT_POSTMORTEM_SIZE)) {
+      if ((pFound == NULL) || ((int)(pState->Seq - pFound->Seq) > 0)) {
+        pFound = pState;
+      }
+    }
+  }
+  return pFound;
+}
+#endif
+
 /*********************************************************************
 *
 *       Public code
@@ -827,6 +1111,8 @@ unsigned SEGGER_RTT_Read(unsigned BufferIndex, void* pBuffer, unsigned BufferSiz
 *        Either by calling SEGGER_RTT_Init() or calling another RTT API function first.
 *    (3) Do not use SEGGER_RTT_WriteWithOverwriteNoLock if a J-Link 
 *        connection reads RTT data.
+*    (4) With SEGGER_RTT_STATS, overwritten bytes are counted as dropped.
+*        No "messages lost" marker is written, message boundaries of the overwritten data are not known.
 */
 void SEGGER_RTT_WriteWithOverwriteNoLock(unsigned BufferIndex, const void* pBuffer, unsigned NumBytes) {
   const char*           pData;
@@ -848,6 +1134,24 @@ void SEGGER_RTT_WriteWithOverwriteNoLock(unsigned BufferIndex, const void* pBuff
   } else {
     Avail = pRing->RdOff - pRing->WrOff - 1u + pRing->SizeOfBuffer;
   }
+#if SEGGER_RTT_STATS
+  {
+    SEGGER_RTT_BUFFER_STATS* pStats;
+    unsigned                 Fill;
+
+    pStats = &_SEGGER_RTT_Stats.aUp[BufferIndex];
+    pStats->NumBytesWritten += NumBytes;
+    if (NumBytes > Avail) {
+      pStats->NumBytesDropped += NumBytes - Avail;      // Overwritten before the host has read them
+      Fill = pRing->SizeOfBuffer - 1u;
+    } else {
+      Fill = pRing->SizeOfBuffer - 1u - Avail + NumBytes;
+    }
+    if (Fill > pStats->MaxFill) {
+      pStats->MaxFill = Fill;
+    }
+  }
+#endif
   if (NumBytes > Avail) {
     pRing->RdOff += (NumBytes - Avail);
     while (pRing->RdOff >= pRing->SizeOfBuffer) {
@@ -901,6 +1205,91 @@ void SEGGER_RTT_WriteWithOverwriteNoLock(unsigned BufferIndex, const void* pBuff
   } while (NumBytes);
 }
 
+#if SEGGER_RTT_POSTMORTEM
+/*********************************************************************
+*
+*       SEGGER_RTT_WritePostMortemNoLock
+*
+*  Function description
+*    Stores a specified number of characters in the post-mortem up-buffer,
+*    overwriting the oldest data if it does not fit,
+*    then saves the state of the buffer to find it again after a reset.
+*    SEGGER_RTT_WritePostMortemNoLock does not lock the application.
+*
+*  Parameters
+*    pBuffer      Pointer to character array. Does not need to point to a \0 terminated string.
+*    NumBytes     Number of bytes to be stored.
+*
+*  Return value
+*    Number of bytes which have been stored, 0 if SEGGER_RTT_ConfigPostMortem() has not been called.
+*
+*  Notes
+*    (1) Written like SEGGER_RTT_WriteWithOverwriteNoLock(), a host reading
+*        while the oldest data is overwritten may get a part of it twice.
+*    (2) The oldest data is dropped and the state saved before it is overwritten,
+*        so a reset in the middle of the write loses this write only.
+*    (3) Of more than SizeOfBuffer - 1 bytes, only the last ones are stored.
+*/
+unsigned SEGGER_RTT_WritePostMortemNoLock(const void* pBuffer, unsigned NumBytes) {
+  volatile SEGGER_RTT_POSTMORTEM_CB* pPM;
+  SEGGER_RTT_BUFFER_UP*              pRing;
+  const char*                        pData;
+  unsigned                           Avail;
+  unsigned                           RdOff;
+
+  if (_PostMortemIndex == 0u) {
+    return 0u;
+  }
+  pData = (const char*)pBuffer;
+  pPM   = (volatile SEGGER_RTT_POSTMORTEM_CB*)((char*)&_SEGGER_RTT_PostMortem + SEGGER_RTT_UNCACHED_OFF);
+  pRing = (SEGGER_RTT_BUFFER_UP*)((char*)&_SEGGER_RTT.aUp[_PostMortemIndex] + SEGGER_RTT_UNCACHED_OFF);  // Access uncached to make sure we see changes made by the J-Link side and all of our changes go into HW directly
+  if (NumBytes > pRing->SizeOfBuffer - 1u) {
+    pData    += NumBytes - (pRing->SizeOfBuffer - 1u);
+    NumBytes  = pRing->SizeOfBuffer - 1u;
+  }
+  Avail = _GetAvailWriteSpace(pRing);
+  if (NumBytes > Avail) {
+    RdOff = pRing->RdOff + NumBytes - Avail;
+    if (RdOff >= pRing->SizeOfBuffer) {
+      RdOff -= pRing->SizeOfBuffer;
+    }
+    pRing->RdOff = RdOff;
+    _PostMortemSave(pPM, pRing);
+#if SEGGER_RTT_STATS
+    _SEGGER_RTT_Stats.aUp[_PostMortemIndex].NumBytesDropped += NumBytes - Avail;
+#endif
+  }
+  SEGGER_RTT_WriteWithOverwriteNoLock(_PostMortemIndex, pData, NumBytes);
+  _PostMortemSave(pPM, pRing);
+  return NumBytes;
+}
+
+/*********************************************************************
+*
+*       SEGGER_RTT_WritePostMortem
+*
+*  Function description
+*    Stores a specified number of characters in the post-mortem up-buffer.
+*    SEGGER_RTT_WritePostMortem locks the application
+*    and calls SEGGER_RTT_WritePostMortemNoLock().
+*
+*  Parameters
+*    pBuffer      Pointer to character array. Does not need to point to a \0 terminated string.
+*    NumBytes     Number of bytes to be stored.
+*
+*  Return value
+*    Number of bytes which have been stored.
+*/
+unsigned SEGGER_RTT_WritePostMortem(const void* pBuffer, unsigned NumBytes) {
+  unsigned Status;
+
+  SEGGER_RTT_LOCK();
+  Status = SEGGER_RTT_WritePostMortemNoLock(pBuffer, NumBytes);
+  SEGGER_RTT_UNLOCK();
+  return Status;
+}
+#endif
+
 /*********************************************************************
 *
 *       SEGGER_RTT_WriteSkipNoLock
@@ -927,9 +1316,30 @@ void SEGGER_RTT_WriteWithOverwriteNoLock(unsigned BufferIndex, const void* pBuff
 *    (2) For performance reasons this function does not call Init()
 *        and may only be called after RTT has been initialized.
 *        Either by calling SEGGER_RTT_Init() or calling another RTT API function first.
+*    (3) With SEGGER_RTT_STATS the write is counted by a wrapper,
+*        the copy below keeps its early returns.
 */
 #if (RTT_USE_ASM == 0)
+#if SEGGER_RTT_STATS
+static unsigned _WriteSkipNoLock(unsigned BufferIndex, const void* pBuffer, unsigned NumBytes);
+
+unsigned SEGGER_RTT_WriteSkipNoLock(unsigned BufferIndex, const void* pBuffer, unsigned NumBytes) {
+  SEGGER_RTT_BUFFER_UP* pRing;
+  unsigned              r;
+
+  pRing = (SEGGER_RTT_BUFFER_UP*)((char*)&_SEGGER_RTT.aUp[BufferIndex] + SEGGER_RTT_UNCACHED_OFF);  // Access uncached to make sure we see changes made by the J-Link side and all of our changes go into HW directly
+  r = _StatsMarkLost(BufferIndex, pRing);
+  if (r != 0u) {
+    r = _WriteSkipNoLock(BufferIndex, pBuffer, NumBytes);
+  }
+  _StatsWrite(BufferIndex, pRing, NumBytes, (r != 0u) ? NumBytes : 0u);
+  return r;
+}
+
+static unsigned _WriteSkipNoLock(unsigned BufferIndex, const void* pBuffer, unsigned NumBytes) {
+#else
 unsigned SEGGER_RTT_WriteSkipNoLock(unsigned BufferIndex, const void* pBuffer, unsigned NumBytes) {
+#endif
   const char*           pData;
   SEGGER_RTT_BUFFER_UP* pRing;
   unsigned              Avail;
@@ -951,6 +1361,32 @@ unsigned SEGGER_RTT_WriteSkipNoLock(unsigned BufferIndex, const void* pBuffer, u
   pRing = (SEGGER_RTT_BUFFER_UP*)((char*)&_SEGGER_RTT.aUp[BufferIndex] + SEGGER_RTT_UNCACHED_OFF);  // Access uncached to make sure we see changes made by the J-Link side and all of our changes go into HW directly
   RdOff = pRing->RdOff;
   WrOff = pRing->WrOff;
+#if SEGGER_RTT_BUFFER_SIZE_POW2
+  //
+  // Power of 2 size: Free space by one mask, then only "wraps or not" is left
+  //
+  Avail = SEGGER_RTT__FREE(pRing, RdOff, WrOff);
+  if (Avail < NumBytes) {                               // Case 3) or 5)
+    return 0;
+  }
+  Rem  = pRing->SizeOfBuffer - WrOff;                   // Space until end of buffer
+  pDst = (pRing->pBuffer + WrOff) + SEGGER_RTT_UNCACHED_OFF;
+  if (Rem > NumBytes) {                                 // Case 1) or 4)
+    memcpy((void*)pDst, pData, NumBytes);
+    RTT__DMB();                     // Force data write to be complete before writing the <WrOff>, in case CPU is allowed to change the order of memory accesses
+    pRing->WrOff = WrOff + NumBytes;
+    return 1;
+  }
+  memcpy((void*)pDst, pData, Rem);                      // Case 2)
+  NumBytes -= Rem;
+  if (NumBytes) {
+    pDst = pRing->pBuffer + SEGGER_RTT_UNCACHED_OFF;
+    memcpy((void*)pDst, pData + Rem, NumBytes);
+  }
+  RTT__DMB();                     // Force data write to be complete before writing the <WrOff>, in case CPU is allowed to change the order of memory accesses
+  pRing->WrOff = NumBytes;
+  return 1;
+#else
   if (RdOff <= WrOff) {                                 // Case 1), 2) or 3)
     Avail = pRing->SizeOfBuffer - WrOff - 1u;           // Space until wrap-around (assume 1 byte not usable for case that RdOff == 0)
     if (Avail >= NumBytes) {                            // Case 1)?
@@ -988,9 +1424,324 @@ CopyStraight:
     }
   }
   return 0;     // No space in buffer
+#endif
 }
 #endif
 
+/*********************************************************************
+*
+*       SEGGER_RTT_ReserveNoLock
+*
+*  Function description
+*    Reserves space in an "Up"-buffer, so that the caller can format or
+*    serialize data directly into the ring buffer instead of staging it
+*    in a buffer of its own. The data becomes visible to the host by
+*    calling SEGGER_RTT_CommitNoLock().
+*    SEGGER_RTT_ReserveNoLock does not lock the application.
+*
+*  Parameters
+*    BufferIndex  Index of "Up"-buffer to be used (e.g. 0 for "Terminal").
+*    NumBytes     Number of bytes to be reserved.
+*    pRes         Pointer to the reservation, receives the 1 or 2 spans which may be written.
+*
+*  Return value
+*    Number of bytes which have been reserved.
+*
+*  Notes
+*    (1) Space is reserved according to buffer flags:
+*          SKIP:  NumBytes or 0
+*          TRIM:  As much as fits, up to NumBytes
+*          BLOCK: Waits until NumBytes are free. NumBytes is limited to SizeOfBuffer - 1.
+*    (2) Reserve and commit must be done in the same locked region,
+*        e.g. SEGGER_RTT_LOCK(); SEGGER_RTT_ReserveNoLock(); ...; SEGGER_RTT_CommitNoLock(); SEGGER_RTT_UNLOCK();
+*    (3) For performance reasons this function does not call Init()
+*        and may only be called after RTT has been initialized.
+*        Either by calling SEGGER_RTT_Init() or calling another RTT API function first.
+*/
+unsigned SEGGER_RTT_ReserveNoLock(unsigned BufferIndex, unsigned NumBytes, SEGGER_RTT_RESERVATION* pRes) {
+  SEGGER_RTT_BUFFER_UP* pRing;
+  unsigned              Avail;
+  unsigned              WrOff;
+  unsigned              Rem;
+
+  pRing = (SEGGER_RTT_BUFFER_UP*)((char*)&_SEGGER_RTT.aUp[BufferIndex] + SEGGER_RTT_UNCACHED_OFF);  // Access uncached to make sure we see changes made by the J-Link side and all of our changes go into HW directly
+#if SEGGER_RTT_STATS
+  if (_StatsMarkLost(BufferIndex, pRing) == 0u) {
+    _StatsWrite(BufferIndex, pRing, NumBytes, 0u);
+    NumBytes = 0u;
+  }
+#endif
+  Avail = _GetAvailWriteSpace(pRing);
+  switch (pRing->Flags & SEGGER_RTT_MODE_MASK) {
+  case SEGGER_RTT_MODE_NO_BLOCK_SKIP:
+    if (Avail < NumBytes) {
+#if SEGGER_RTT_STATS
+      _StatsWrite(BufferIndex, pRing, NumBytes, 0u);
+#endif
+      NumBytes = 0u;
+    }
+    break;
+  case SEGGER_RTT_MODE_NO_BLOCK_TRIM:
+#if SEGGER_RTT_STATS
+    if (Avail == 0u) {
+      _StatsWrite(BufferIndex, pRing, NumBytes, 0u);    // Trimmed bytes are not known before the commit, only a message which gets nothing is counted
+    }
+#endif
+    NumBytes = MIN(NumBytes, Avail);
+    break;
+  case SEGGER_RTT_MODE_BLOCK_IF_FIFO_FULL:
+    NumBytes = MIN(NumBytes, pRing->SizeOfBuffer - 1u);
+#if SEGGER_RTT_STATS
+    if (Avail < NumBytes) {
+      unsigned t;
+
+      t = SEGGER_RTT_STATS_TIME();
+      while (Avail < NumBytes) {
+        Avail = _GetAvailWriteSpace(pRing);   // RdOff may be changed by host (debug probe) in the meantime
+      }
+      _SEGGER_RTT_Stats.aUp[BufferIndex].BlockedTime += SEGGER_RTT_STATS_TIME() - t;
+    }
+#endif
+    while (Avail < NumBytes) {
+      Avail = _GetAvailWriteSpace(pRing);     // RdOff may be changed by host (debug probe) in the meantime
+    }
+    break;
+  default:
+    NumBytes = 0u;
+    break;
+  }
+  WrOff = pRing->WrOff;
+  Rem   = pRing->SizeOfBuffer - WrOff;
+  pRes->pData0     = (pRing->pBuffer + WrOff) + SEGGER_RTT_UNCACHED_OFF;
+  pRes->NumBytes0  = MIN(NumBytes, Rem);
+  pRes->pData1     = pRing->pBuffer + SEGGER_RTT_UNCACHED_OFF;
+  pRes->NumBytes1  = NumBytes - pRes->NumBytes0;
+  return NumBytes;
+}
+
+/*********************************************************************
+*
+*       SEGGER_RTT_CommitNoLock
+*
+*  Function description
+*    Makes data which has been written into space reserved by
+*    SEGGER_RTT_ReserveNoLock() visible to the host.
+*
+*  Parameters
+*    BufferIndex  Index of "Up"-buffer to be used (e.g. 0 for "Terminal").
+*    NumBytes     Number of bytes to be committed. Must not exceed the number of reserved bytes,
+*                 may be less if the producer did not need all of the reserved space.
+*/
+void SEGGER_RTT_CommitNoLock(unsigned BufferIndex, unsigned NumBytes) {
+  SEGGER_RTT_BUFFER_UP* pRing;
+  unsigned              WrOff;
+
+  pRing = (SEGGER_RTT_BUFFER_UP*)((char*)&_SEGGER_RTT.aUp[BufferIndex] + SEGGER_RTT_UNCACHED_OFF);  // Access uncached to make sure we see changes made by the J-Link side and all of our changes go into HW directly
+  WrOff = pRing->WrOff + NumBytes;
+#if SEGGER_RTT_BUFFER_SIZE_POW2
+  WrOff = SEGGER_RTT__WRAP(pRing, WrOff);
+#else
+  if (WrOff >= pRing->SizeOfBuffer) {
+    WrOff -= pRing->SizeOfBuffer;
+  }
+#endif
+  RTT__DMB();                     // Force data write to be complete before writing the <WrOff>, in case CPU is allowed to change the order of memory accesses
+  pRing->WrOff = WrOff;
+#if SEGGER_RTT_STATS
+  _StatsWrite(BufferIndex, pRing, NumBytes, NumBytes);
+#endif
+}
+
+#if SEGGER_RTT_LOCKFREE
+/*********************************************************************
+*
+*       _PublishLockFree()
+*
+*  Function description
+*    Ends a write of SEGGER_RTT_WriteLockFree(): removes the writer from the reservation word.
+*    The last writer in progress moves <WrOff> up to the reserve offset before.
+*
+*  Notes
+*    (1) <WrOff> is stored while the writer is still counted, and only if it is the only one,
+*        so no two writers store <WrOff> at the same time: a writer which reserves later is counted too
+*        and does not store until this one is removed. If the reservation word changed before the writer
+*        could remove itself, it is read again and the newer reserve offset is stored.
+*        A value of an older state is never stored after a newer one, <WrOff> never moves backwards.
+*    (2) The host can not read past <WrOff>, so the reserve offset can not wrap back to a value
+*        which a stalled writer has read while it is counted.
+*/
+static void _PublishLockFree(SEGGER_RTT_BUFFER_UP* pRing, unsigned* pState) {
+  unsigned State;
+
+  State = __atomic_load_n(pState, __ATOMIC_ACQUIRE);
+  do {
+    if ((State & 0xFFu) == 1u) {
+      __atomic_store_n(&pRing->WrOff, State >> 16, __ATOMIC_RELEASE);   // Data of all writers is complete, they were removed with release
+    }
+  } while (__atomic_compare_exchange_n(pState, &State, State - 1u, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE) == 0);
+}
+
+#if SEGGER_RTT_STATS
+/*********************************************************************
+*
+*       _StatsWriteLockFree()
+*
+*  Function description
+*    Counts a write of SEGGER_RTT_WriteLockFree() like _StatsWrite(), with atomic updates.
+*    No "messages lost" marker is written, it could not be placed in front of the gap without a lock.
+*
+*  Parameters
+*    BufferIndex      Index of the up-buffer.
+*    NumBytes         Number of bytes of the message.
+*    NumBytesWritten  Number of bytes which have been stored.
+*    Fill             Number of bytes in the buffer up to the end of this write.
+*/
+static void _StatsWriteLockFree(unsigned BufferIndex, unsigned NumBytes, unsigned NumBytesWritten, unsigned Fill) {
+  SEGGER_RTT_BUFFER_STATS* pStats;
+  unsigned                 MaxFill;
+
+  pStats = &_SEGGER_RTT_Stats.aUp[BufferIndex];
+  if (NumBytesWritten == 0u) {
+    if (NumBytes != 0u) {
+      __atomic_add_fetch(&pStats->NumMsgDropped, 1u, __ATOMIC_RELAXED);
+      __atomic_add_fetch(&pStats->NumBytesDropped, NumBytes, __ATOMIC_RELAXED);
+    }
+    return;
+  }
+  __atomic_add_fetch(&pStats->NumBytesWritten, NumBytesWritten, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&pStats->NumBytesTrimmed, NumBytes - NumBytesWritten, __ATOMIC_RELAXED);
+  MaxFill = __atomic_load_n(&pStats->MaxFill, __ATOMIC_RELAXED);
+  while ((Fill > MaxFill) && (__atomic_compare_exchange_n(&pStats->MaxFill, &MaxFill, Fill, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED) == 0)) {
+  }
+}
+#endif
+#endif
+
+/*********************************************************************
+*
+*       SEGGER_RTT_WriteLockFree
+*
+*  Function description
+*    Stores a specified number of characters in SEGGER RTT
+*    control block which is then read by the host.
+*    Several tasks, interrupts or cores may write to the same buffer
+*    at the same time without SEGGER_RTT_LOCK(), so interrupts are not masked.
+*
+*  Parameters
+*    BufferIndex  Index of "Up"-buffer to be used (e.g. 0 for "Terminal").
+*    pBuffer      Pointer to character array. Does not need to point to a \0 terminated string.
+*    NumBytes     Number of bytes to be stored in the SEGGER RTT control block.
+*
+*  Return value
+*    Number of bytes which have been stored in the "Up"-buffer.
+*
+*  Notes
+*    (1) A writer claims its space with a CAS on the reservation word of the buffer
+*        (reserve offset, lap and number of writers in progress), copies its data,
+*        and the last writer which finishes makes the data of all writers visible to the host.
+*        The lap counts the wrap-arounds of the reserve offset, so a writer which was stalled
+*        while others wrote a whole lap fails its CAS and does not claim with a stale <RdOff>.
+*        The data of one call is never split or mixed with other data.
+*    (2) A buffer which is written by this function must not be written by any other write function,
+*        they do not know about the reservations. Buffer size is limited to 64 KB,
+*        at most 255 writers can be in progress on one buffer at the same time, a writer over it is dropped.
+*    (3) Data is stored according to buffer flags:
+*          SKIP:  NumBytes or 0
+*          TRIM:  As much as fits, up to NumBytes
+*          BLOCK: Same as SKIP. Waiting for the host could dead lock on a preempted writer,
+*                 which holds back the data of all others.
+*    (4) If SEGGER_RTT_LOCKFREE is 0, SEGGER_RTT_Write() is used instead.
+*/
+unsigned SEGGER_RTT_WriteLockFree(unsigned BufferIndex, const void* pBuffer, unsigned NumBytes) {
+#if SEGGER_RTT_LOCKFREE
+  SEGGER_RTT_BUFFER_UP* pRing;
+  unsigned*             pState;
+  const char*           pData;
+  unsigned              State;
+  unsigned              NewState;
+  unsigned              NewOff;
+  unsigned              ResOff;
+  unsigned              RdOff;
+  unsigned              Avail;
+  unsigned              Rem;
+#if SEGGER_RTT_STATS
+  unsigned              NumBytesReq;
+#endif
+
+  INIT();
+  pRing  = (SEGGER_RTT_BUFFER_UP*)((char*)&_SEGGER_RTT.aUp[BufferIndex] + SEGGER_RTT_UNCACHED_OFF);  // Access uncached to make sure we see changes made by the J-Link side and all of our changes go into HW directly
+  pState = &_aUpResState[BufferIndex];
+  pData  = (const char*)pBuffer;
+#if SEGGER_RTT_STATS
+  NumBytesReq = NumBytes;
+#endif
+  if (pRing->SizeOfBuffer > 0x10000u) {
+    return 0u;
+  }
+  //
+  // Claim space
+  //
+  State = __atomic_load_n(pState, __ATOMIC_RELAXED);
+  do {
+    ResOff = State >> 16;
+    RdOff  = __atomic_load_n(&pRing->RdOff, __ATOMIC_ACQUIRE);   // The host has read the space up to <RdOff> before, it may be reused
+#if SEGGER_RTT_BUFFER_SIZE_POW2
+    Avail = SEGGER_RTT__FREE(pRing, RdOff, ResOff);
+#else
+    if (RdOff > ResOff) {
+      Avail = RdOff - ResOff - 1u;
+    } else {
+      Avail = pRing->SizeOfBuffer - (ResOff - RdOff + 1u);
+    }
+#endif
+    if (Avail < NumBytes) {
+      if ((pRing->Flags & SEGGER_RTT_MODE_MASK) != SEGGER_RTT_MODE_NO_BLOCK_TRIM) {
+#if SEGGER_RTT_STATS
+        _StatsWriteLockFree(BufferIndex, NumBytesReq, 0u, 0u);
+#endif
+        return 0u;
+      }
+      NumBytes = Avail;
+    }
+    if ((NumBytes == 0u) || ((State & 0xFFu) == 0xFFu)) {
+#if SEGGER_RTT_STATS
+      _StatsWriteLockFree(BufferIndex, NumBytesReq, 0u, 0u);
+#endif
+      return 0u;
+    }
+    NewOff = ResOff + NumBytes;
+#if SEGGER_RTT_BUFFER_SIZE_POW2
+    NewOff = SEGGER_RTT__WRAP(pRing, NewOff);
+#else
+    if (NewOff >= pRing->SizeOfBuffer) {
+      NewOff -= pRing->SizeOfBuffer;
+    }
+#endif
+    NewState = (State & 0xFFFFu) + 1u;                    // One more writer
+    if (NewOff < ResOff) {
+      NewState = (NewState + 0x100u) & 0xFFFFu;           // Next lap
+    }
+    NewState |= NewOff << 16;
+  } while (__atomic_compare_exchange_n(pState, &State, NewState, 1, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED) == 0);
+  //
+  // Copy data, other writers may do the same in their own space at the same time
+  //
+  Rem = MIN(NumBytes, pRing->SizeOfBuffer - ResOff);
+  SEGGER_RTT_MEMCPY((pRing->pBuffer + ResOff) + SEGGER_RTT_UNCACHED_OFF, pData, Rem);
+  SEGGER_RTT_MEMCPY(pRing->pBuffer + SEGGER_RTT_UNCACHED_OFF, pData + Rem, NumBytes - Rem);
+  //
+  // Finish, the last writer publishes
+  //
+  _PublishLockFree(pRing, pState);
+#if SEGGER_RTT_STATS
+  _StatsWriteLockFree(BufferIndex, NumBytesReq, NumBytes, pRing->SizeOfBuffer - 1u - Avail + NumBytes);
+#endif
+  return NumBytes;
+#else
+  return SEGGER_RTT_Write(BufferIndex, pBuffer, NumBytes);
+#endif
+}
+
 /*********************************************************************
 *
 *       SEGGER_RTT_WriteDownBufferNoLock
@@ -1104,10 +1855,16 @@ unsigned SEGGER_RTT_WriteNoLock(unsigned BufferIndex, const void* pBuffer, unsig
   //
   pData = (const char *)pBuffer;
   pRing = (SEGGER_RTT_BUFFER_UP*)((char*)&_SEGGER_RTT.aUp[BufferIndex] + SEGGER_RTT_UNCACHED_OFF);  // Access uncached to make sure we see changes made by the J-Link side and all of our changes go into HW directly
+#if SEGGER_RTT_STATS
+  if (_StatsMarkLost(BufferIndex, pRing) == 0u) {
+    _StatsWrite(BufferIndex, pRing, NumBytes, 0u);        // Marker does not fit yet, keep it in front of the gap
+    return 0u;
+  }
+#endif
   //
   // How we output depends upon the mode...
   //
-  switch (pRing->Flags) {
+  switch (pRing->Flags & SEGGER_RTT_MODE_MASK) {
   case SEGGER_RTT_MODE_NO_BLOCK_SKIP:
     //
     // If we are in skip mode and there is no space for the whole
@@ -1133,6 +1890,16 @@ unsigned SEGGER_RTT_WriteNoLock(unsigned BufferIndex, const void* pBuffer, unsig
     //
     // If we are in blocking mode, output everything.
     //
+#if SEGGER_RTT_STATS
+    if (_GetAvailWriteSpace(pRing) < NumBytes) {
+      unsigned t;
+
+      t = SEGGER_RTT_STATS_TIME();
+      Status = _WriteBlocking(pRing, pData, NumBytes);
+      _SEGGER_RTT_Stats.aUp[BufferIndex].BlockedTime += SEGGER_RTT_STATS_TIME() - t;
+      break;
+    }
+#endif
     Status = _WriteBlocking(pRing, pData, NumBytes);
     break;
   default:
@@ -1142,6 +1909,9 @@ unsigned SEGGER_RTT_WriteNoLock(unsigned BufferIndex, const void* pBuffer, unsig
   //
   // Finish up.
   //
+#if SEGGER_RTT_STATS
+  _StatsWrite(BufferIndex, pRing, NumBytes, Status);
+#endif
   return Status;
 }
 
@@ -1272,9 +2042,13 @@ unsigned SEGGER_RTT_PutCharSkipNoLock(unsigned BufferIndex, char c) {
   // Get write position and handle wrap-around if necessary
   //
   WrOff = pRing->WrOff + 1;
+#if SEGGER_RTT_BUFFER_SIZE_POW2
+  WrOff = SEGGER_RTT__WRAP(pRing, WrOff);
+#else
   if (WrOff == pRing->SizeOfBuffer) {
     WrOff = 0;
   }
+#endif
   //
   // Output byte if free space is available
   //
@@ -1287,6 +2061,9 @@ unsigned SEGGER_RTT_PutCharSkipNoLock(unsigned BufferIndex, char c) {
   } else {
     Status = 0;
   }
+#if SEGGER_RTT_STATS
+  _StatsWrite(BufferIndex, pRing, 1u, Status);
+#endif
   //
   return Status;
 }
@@ -1327,9 +2104,13 @@ unsigned SEGGER_RTT_PutCharSkip(unsigned BufferIndex, char c) {
   // Get write position and handle wrap-around if necessary
   //
   WrOff = pRing->WrOff + 1;
+#if SEGGER_RTT_BUFFER_SIZE_POW2
+  WrOff = SEGGER_RTT__WRAP(pRing, WrOff);
+#else
   if (WrOff == pRing->SizeOfBuffer) {
     WrOff = 0;
   }
+#endif
   //
   // Output byte if free space is available
   //
@@ -1342,6 +2123,9 @@ unsigned SEGGER_RTT_PutCharSkip(unsigned BufferIndex, char c) {
   } else {
     Status = 0;
   }
+#if SEGGER_RTT_STATS
+  _StatsWrite(BufferIndex, pRing, 1u, Status);
+#endif
   //
   // Finish up.
   //
@@ -1386,13 +2170,28 @@ unsigned SEGGER_RTT_PutChar(unsigned BufferIndex, char c) {
   // Get write position and handle wrap-around if necessary
   //
   WrOff = pRing->WrOff + 1;
+#if SEGGER_RTT_BUFFER_SIZE_POW2
+  WrOff = SEGGER_RTT__WRAP(pRing, WrOff);
+#else
   if (WrOff == pRing->SizeOfBuffer) {
     WrOff = 0;
   }
+#endif
   //
   // Wait for free space if mode is set to blocking
   //
-  if (pRing->Flags == SEGGER_RTT_MODE_BLOCK_IF_FIFO_FULL) {
+  if ((pRing->Flags & SEGGER_RTT_MODE_MASK) == SEGGER_RTT_MODE_BLOCK_IF_FIFO_FULL) {
+#if SEGGER_RTT_STATS
+    if (WrOff == pRing->RdOff) {
+      unsigned t;
+
+      t = SEGGER_RTT_STATS_TIME();
+      while (WrOff == pRing->RdOff) {
+        ;
+      }
+      _SEGGER_RTT_Stats.aUp[BufferIndex].BlockedTime += SEGGER_RTT_STATS_TIME() - t;
+    }
+#endif
     while (WrOff == pRing->RdOff) {
       ;
     }
@@ -1409,6 +2208,9 @@ unsigned SEGGER_RTT_PutChar(unsigned BufferIndex, char c) {
   } else {
     Status = 0;
   }
+#if SEGGER_RTT_STATS
+  _StatsWrite(BufferIndex, pRing, 1u, Status);
+#endif
   //
   // Finish up.
   //
@@ -1600,7 +2402,7 @@ int SEGGER_RTT_AllocDownBuffer(const char* sName, void* pBuffer, unsigned Buffer
 *  Parameters
 *    sName        Pointer to a constant name string.
 *    pBuffer      Pointer to a buffer to be used.
-*    BufferSize   Size of the buffer.
+*    BufferSize   Size of the buffer. Must be a power of 2 if SEGGER_RTT_BUFFER_SIZE_POW2 is set.
 *    Flags        Operating modes. Define behavior if buffer is full (not enough space for entire message).
 *
 *  Return value
@@ -1612,6 +2414,11 @@ int SEGGER_RTT_AllocUpBuffer(const char* sName, void* pBuffer, unsigned BufferSi
   volatile SEGGER_RTT_CB* pRTTCB;
 
   INIT();
+#if SEGGER_RTT_BUFFER_SIZE_POW2
+  if (BufferSize & (BufferSize - 1u)) {
+    return -1;                      // Offsets wrap by a mask, see SEGGER_RTT_BUFFER_SIZE_POW2
+  }
+#endif
   SEGGER_RTT_LOCK();
   pRTTCB = (volatile SEGGER_RTT_CB*)((unsigned char*)&_SEGGER_RTT + SEGGER_RTT_UNCACHED_OFF);  // Access RTTCB uncached to make sure we see changes made by the J-Link side and all of our changes go into HW directly
   BufferIndex = 0;
@@ -1660,6 +2467,7 @@ int SEGGER_RTT_AllocUpBuffer(const char* sName, void* pBuffer, unsigned BufferSi
 *    Buffer 0 is configured on compile-time.
 *    May only be called once per buffer.
 *    Buffer name and flags can be reconfigured using the appropriate functions.
+*    If SEGGER_RTT_BUFFER_SIZE_POW2 is set, BufferSize must be a power of 2 (or 0) for every buffer, also buffer 0.
 */
 int SEGGER_RTT_ConfigUpBuffer(unsigned BufferIndex, const char* sName, void* pBuffer, unsigned BufferSize, unsigned Flags) {
   int r;
@@ -1668,6 +2476,11 @@ int SEGGER_RTT_ConfigUpBuffer(unsigned BufferIndex, const char* sName, void* pBu
 
   INIT();
   pRTTCB = (volatile SEGGER_RTT_CB*)((unsigned char*)&_SEGGER_RTT + SEGGER_RTT_UNCACHED_OFF);  // Access RTTCB uncached to make sure we see changes made by the J-Link side and all of our changes go into HW directly
+#if SEGGER_RTT_BUFFER_SIZE_POW2
+  if (BufferSize & (BufferSize - 1u)) {
+    return -1;                      // Offsets wrap by a mask, see SEGGER_RTT_BUFFER_SIZE_POW2
+  }
+#endif
   if (BufferIndex < SEGGER_RTT_MAX_NUM_UP_BUFFERS) {
     SEGGER_RTT_LOCK();
     pUp = &pRTTCB->aUp[BufferIndex];
@@ -1679,6 +2492,9 @@ int SEGGER_RTT_ConfigUpBuffer(unsigned BufferIndex, const char* sName, void* pBu
       pUp->WrOff        = 0u;
     }
     pUp->Flags          = Flags;
+#if SEGGER_RTT_LOCKFREE
+    _aUpResState[BufferIndex] = pUp->WrOff << 16;
+#endif
     SEGGER_RTT_UNLOCK();
     r =  0;
   } else {
@@ -1892,6 +2708,78 @@ void SEGGER_RTT_Init (void) {
   _DoInit();
 }
 
+#if SEGGER_RTT_POSTMORTEM
+/*********************************************************************
+*
+*       SEGGER_RTT_ConfigPostMortem
+*
+*  Function description
+*    Run-time configuration of the post-mortem up-buffer.
+*    _SEGGER_RTT_PostMortem becomes up-buffer <BufferIndex>.
+*    If it holds a valid state from before a reset, the bytes which had not been
+*    read by the host then are in the up-buffer again, as they were written,
+*    so the host reads them like any other data.
+*    Otherwise (power-on, RAM overwritten) the up-buffer starts empty.
+*
+*  Parameters
+*    BufferIndex  Index of the up-buffer, 1 ... SEGGER_RTT_MAX_NUM_UP_BUFFERS - 1.
+*    sName        Pointer to a constant name string.
+*
+*  Return value
+*    >= 0 - O.K. Number of bytes kept from before the reset.
+*     < 0 - Error
+*
+*  Additional information
+*    Call it once at start of the application, after SEGGER_RTT_Init().
+*    The up-buffer is written by SEGGER_RTT_WritePostMortem() only.
+*    <RdOff> is saved by each write, data read by the host after the last write before a reset is read again.
+*/
+int SEGGER_RTT_ConfigPostMortem(unsigned BufferIndex, const char* sName) {
+  volatile SEGGER_RTT_POSTMORTEM_CB*          pPM;
+  const volatile SEGGER_RTT_POSTMORTEM_STATE* pState;
+  volatile SEGGER_RTT_CB*                     pRTTCB;
+  volatile SEGGER_RTT_BUFFER_UP*              pUp;
+  unsigned                                    WrOff;
+  unsigned                                    RdOff;
+
+  INIT();
+  if ((BufferIndex == 0u) || (BufferIndex >= SEGGER_RTT_MAX_NUM_UP_BUFFERS)) {
+    return -1;                      // Buffer 0 has its own buffer
+  }
+  pPM    = (volatile SEGGER_RTT_POSTMORTEM_CB*)((char*)&_SEGGER_RTT_PostMortem + SEGGER_RTT_UNCACHED_OFF);
+  pRTTCB = (volatile SEGGER_RTT_CB*)((unsigned char*)&_SEGGER_RTT + SEGGER_RTT_UNCACHED_OFF);  // Access RTTCB uncached to make sure we see changes made by the J-Link side and all of our changes go into HW directly
+  SEGGER_RTT_LOCK();
+  pState = _PostMortemFind(pPM);
+  if (pState != NULL) {
+    WrOff          = pState->WrOff;
+    RdOff          = pState->RdOff;
+    _PostMortemSeq = pState->Seq;
+  } else {
+    pPM->Magic        = 0u;         // Invalid until the slots are cleared
+    memset((void*)pPM->aState, 0, sizeof(pPM->aState));
+    pPM->SizeOfBuffer = SEGGER_RTT_POSTMORTEM_SIZE;
+    RTT__DMB();                     // Force order of memory accesses for cores that may perform out-of-order memory accesses
+    pPM->Magic        = SEGGER_RTT_POSTMORTEM_MAGIC;
+    WrOff             = 0u;
+    RdOff             = 0u;
+    _PostMortemSeq    = 0u;
+  }
+  pUp = &pRTTCB->aUp[BufferIndex];
+  pUp->sName        = sName;
+  pUp->pBuffer      = _SEGGER_RTT_PostMortem.acBuffer;
+  pUp->SizeOfBuffer = SEGGER_RTT_POSTMORTEM_SIZE;
+  pUp->RdOff        = RdOff;
+  pUp->WrOff        = WrOff;
+  pUp->Flags        = SEGGER_RTT_MODE_NO_BLOCK_SKIP;
+#if SEGGER_RTT_LOCKFREE
+  _aUpResState[BufferIndex] = WrOff << 16;
+#endif
+  _PostMortemIndex = BufferIndex;
+  SEGGER_RTT_UNLOCK();
+  return (int)((WrOff >= RdOff) ? (WrOff - RdOff) : (SEGGER_RTT_POSTMORTEM_SIZE - RdOff + WrOff));
+}
+#endif
+
 /*********************************************************************
 *
 *       SEGGER_RTT_SetTerminal
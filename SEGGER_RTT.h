@@ -228,7 +228,7 @@ Revision: $Rev: 24346 $
   #ifndef _CORE_HAS_RTT_ASM_SUPPORT
     #define _CORE_HAS_RTT_ASM_SUPPORT 0              // Default for unknown cores
   #endif
-  #if (_CC_HAS_RTT_ASM_SUPPORT && _CORE_HAS_RTT_ASM_SUPPORT)
+  #if (_CC_HAS_RTT_ASM_SUPPORT && _CORE_HAS_RTT_ASM_SUPPORT && (SEGGER_RTT_STATS == 0))   // The ASM version does not count statistics
     #define RTT_USE_ASM                           (1)
   #else
     #define RTT_USE_ASM                           (0)
@@ -262,6 +262,9 @@ Revision: $Rev: 24346 $
   #if SEGGER_RTT_CPU_CACHE_LINE_SIZE
     #error "RTT_USE_ASM is not available if SEGGER_RTT_CPU_CACHE_LINE_SIZE != 0"
   #endif
+  #if SEGGER_RTT_STATS
+    #error "RTT_USE_ASM is not available if SEGGER_RTT_STATS != 0"
+  #endif
 #endif
 
 #ifndef SEGGER_RTT_ASM  // defined when SEGGER_RTT.h is included from assembly file
@@ -339,6 +342,62 @@ typedef struct {
 #endif
 } SEGGER_RTT_CB;
 
+//
+// Space reserved in an up-buffer by SEGGER_RTT_ReserveNoLock().
+// Data may wrap around the end of the buffer, so the space is described by up to 2 contiguous spans.
+//
+typedef struct {
+  char*     pData0;                 // First span, starting at <WrOff>
+  unsigned  NumBytes0;
+  char*     pData1;                 // Second span, starting at the beginning of the buffer. NumBytes1 is 0 if there is no wrap-around.
+  unsigned  NumBytes1;
+} SEGGER_RTT_RESERVATION;
+
+//
+// Statistics of an up-buffer, counted if SEGGER_RTT_STATS is set.
+// Counters wrap around, the host reads them without locking.
+//
+typedef struct {
+  unsigned  NumBytesWritten;        // Bytes stored in the buffer
+  unsigned  NumBytesDropped;        // Bytes of messages which have been skipped, or overwritten by SEGGER_RTT_WriteWithOverwriteNoLock()
+  unsigned  NumBytesTrimmed;        // Bytes cut off from messages in mode SEGGER_RTT_MODE_NO_BLOCK_TRIM
+  unsigned  NumMsgDropped;          // Messages which have been skipped as a whole
+  unsigned  NumMsgLost;             // Messages dropped since the last "messages lost" marker, see SEGGER_RTT_FLAG_MARK_LOST
+  unsigned  MaxFill;                // Max. number of bytes in the buffer after a write
+  unsigned  BlockedTime;            // Time spent waiting for space in mode SEGGER_RTT_MODE_BLOCK_IF_FIFO_FULL, in ticks of SEGGER_RTT_STATS_TIME()
+} SEGGER_RTT_BUFFER_STATS;
+
+//
+// Statistics of all up-buffers, placed next to the RTT control block.
+// Found by the host by its ID, which does not start with "SEGGER RTT" to not be taken for the control block.
+//
+typedef struct {
+  char                    acID[16];                                 // Initialized to "RTT STATS"
+  int                     MaxNumUpBuffers;                          // Initialized to SEGGER_RTT_MAX_NUM_UP_BUFFERS
+  SEGGER_RTT_BUFFER_STATS aUp[SEGGER_RTT_MAX_NUM_UP_BUFFERS];
+} SEGGER_RTT_STATS_CB;
+
+//
+// State of the post-mortem up-buffer, saved after each write, as <WrOff> and <RdOff> in the control block are cleared by SEGGER_RTT_Init().
+// Two slots are written in turn, so a reset while one is written leaves the other one valid.
+//
+typedef struct {
+  unsigned  Seq;                    // Number of the save, the valid slot with the higher one is the last
+  unsigned  WrOff;
+  unsigned  RdOff;
+  unsigned  Crc;                    // CRC-32 of <Magic>, <SizeOfBuffer> and the fields above
+} SEGGER_RTT_POSTMORTEM_STATE;
+
+//
+// Post-mortem up-buffer, placed in no-init RAM (SEGGER_RTT_POSTMORTEM_SECTION) to keep the last output over a reset.
+//
+typedef struct {
+  unsigned                    Magic;                                // SEGGER_RTT_POSTMORTEM_MAGIC once initialized
+  unsigned                    SizeOfBuffer;                         // SEGGER_RTT_POSTMORTEM_SIZE
+  SEGGER_RTT_POSTMORTEM_STATE aState[2];
+  char                        acBuffer[SEGGER_RTT_POSTMORTEM_SIZE];
+} SEGGER_RTT_POSTMORTEM_CB;
+
 /*********************************************************************
 *
 *       Global data
@@ -346,6 +405,12 @@ typedef struct {
 **********************************************************************
 */
 extern SEGGER_RTT_CB _SEGGER_RTT;
+#if SEGGER_RTT_STATS
+extern SEGGER_RTT_STATS_CB _SEGGER_RTT_Stats;
+#endif
+#if SEGGER_RTT_POSTMORTEM
+extern SEGGER_RTT_POSTMORTEM_CB _SEGGER_RTT_PostMortem;
+#endif
 
 /*********************************************************************
 *
@@ -383,6 +448,14 @@ unsigned     SEGGER_RTT_PutCharSkip             (unsigned BufferIndex, char c);
 unsigned     SEGGER_RTT_PutCharSkipNoLock       (unsigned BufferIndex, char c);
 unsigned     SEGGER_RTT_GetAvailWriteSpace      (unsigned BufferIndex);
 unsigned     SEGGER_RTT_GetBytesInBuffer        (unsigned BufferIndex);
+unsigned     SEGGER_RTT_ReserveNoLock           (unsigned BufferIndex, unsigned NumBytes, SEGGER_RTT_RESERVATION* pRes);
+void         SEGGER_RTT_CommitNoLock            (unsigned BufferIndex, unsigned NumBytes);
+unsigned     SEGGER_RTT_WriteLockFree           (unsigned BufferIndex, const void* pBuffer, unsigned NumBytes);
+#if SEGGER_RTT_POSTMORTEM
+int          SEGGER_RTT_ConfigPostMortem        (unsigned BufferIndex, const char* sName);
+unsigned     SEGGER_RTT_WritePostMortem         (const void* pBuffer, unsigned NumBytes);
+unsigned     SEGGER_RTT_WritePostMortemNoLock   (const void* pBuffer, unsigned NumBytes);
+#endif
 //
 // Function macro for performance optimization
 //
@@ -423,6 +496,13 @@ int     SEGGER_RTT_TerminalOut        (unsigned char TerminalId, const char* s);
 int SEGGER_RTT_printf(unsigned BufferIndex, const char * sFormat, ...);
 int SEGGER_RTT_vprintf(unsigned BufferIndex, const char * sFormat, va_list * pParamList);
 
+typedef int SEGGER_RTT_PRINTF_OUTPUT(void* pContext, const char* pData, unsigned NumBytes);   // Callback target of RTT printf, return < 0 to stop
+
+int SEGGER_RTT_snprintf(char * pBuffer, unsigned BufferSize, const char * sFormat, ...);
+int SEGGER_RTT_vsnprintf(char * pBuffer, unsigned BufferSize, const char * sFormat, va_list * pParamList);
+int SEGGER_RTT_printfCallback(SEGGER_RTT_PRINTF_OUTPUT* pfOutput, void* pContext, const char * sFormat, ...);
+int SEGGER_RTT_vprintfCallback(SEGGER_RTT_PRINTF_OUTPUT* pfOutput, void* pContext, const char * sFormat, va_list * pParamList);
+
 #ifdef __cplusplus
   }
 #endif
@@ -444,6 +524,11 @@ int SEGGER_RTT_vprintf(unsigned BufferIndex, const char * sFormat, va_list * pPa
 #define SEGGER_RTT_MODE_BLOCK_IF_FIFO_FULL    (2)     // Block: Wait until there is space in the buffer.
 #define SEGGER_RTT_MODE_MASK                  (3)
 
+//
+// Flags of an up-buffer, combined with the operating mode
+//
+#define SEGGER_RTT_FLAG_MARK_LOST             (4)     // With SEGGER_RTT_STATS: write "--- N messages lost ---\n" before the next message after messages have been dropped. For text buffers only.
+
 //
 // Control sequences, based on ANSI.
 // Can be used to control color, and clear the screen
@@ -99,10 +99,34 @@ Revision: $Rev: 24316 $
   #define BUFFER_SIZE_DOWN                          (16)    // Size of the buffer for terminal input to target from host (Usually keyboard input) (Default: 16)
 #endif
 
+#ifndef   SEGGER_RTT_BUFFER_SIZE_POW2
+  #define SEGGER_RTT_BUFFER_SIZE_POW2               (0)     // 1: All up-buffers have a power of 2 size, offsets wrap by a mask instead of compare and reset (Default: 0)
+#endif
+
+#ifndef   SEGGER_RTT_STATS
+  #define SEGGER_RTT_STATS                          (0)     // 1: Count written, dropped and trimmed bytes, max. fill level and blocked time of each up-buffer in _SEGGER_RTT_Stats (Default: 0)
+#endif
+
+#ifndef   SEGGER_RTT_POSTMORTEM
+  #define SEGGER_RTT_POSTMORTEM                     (0)     // 1: _SEGGER_RTT_PostMortem, an up-buffer in no-init RAM which keeps its content over a reset, see SEGGER_RTT_ConfigPostMortem() (Default: 0)
+#endif
+
+#ifndef   SEGGER_RTT_POSTMORTEM_SIZE
+  #define SEGGER_RTT_POSTMORTEM_SIZE                (1024)  // Size of the post-mortem up-buffer (Default: 1k)
+#endif
+
 #ifndef   SEGGER_RTT_PRINTF_BUFFER_SIZE
   #define SEGGER_RTT_PRINTF_BUFFER_SIZE             (64u)    // Size of buffer for RTT printf to bulk-send chars via RTT     (Default: 64)
 #endif
 
+#ifndef   SEGGER_RTT_PRINTF_DIRECT
+  #define SEGGER_RTT_PRINTF_DIRECT                  (0)      // 1: RTT printf formats straight into the up-buffer, one lock and one commit per message, no staging buffer (Default: 0)
+#endif
+
+#ifndef   SEGGER_RTT_PRINTF_DIRECT_MAX
+  #define SEGGER_RTT_PRINTF_DIRECT_MAX              (256u)   // Bytes reserved at once for an RTT printf message in direct mode, a longer one is measured and formatted again (Default: 256)
+#endif
+
 #ifndef   SEGGER_RTT_MODE_DEFAULT
   #define SEGGER_RTT_MODE_DEFAULT                   SEGGER_RTT_MODE_NO_BLOCK_SKIP // Mode for pre-initialized terminal channel (buffer 0)
 #endif
@@ -233,6 +257,16 @@ Revision: $Rev: 24316 $
                                                  : "a1"                        \
                                                 );                             \
                                }
+  #elif defined(__linux__)
+    //
+    // Linux host build (LOG_PLATFORM 1): threads take the place of tasks and interrupts,
+    // e.g. the simulated UART DMA in host/uart_sim.c
+    // SEGGER_RTT_Mutex is made recursive before main() in SEGGER_RTT.c, so the lock is nestable like on the target.
+    //
+    #include <pthread.h>
+    extern pthread_mutex_t SEGGER_RTT_Mutex;
+    #define SEGGER_RTT_LOCK()    { pthread_mutex_lock(&SEGGER_RTT_Mutex);
+    #define SEGGER_RTT_UNLOCK()    pthread_mutex_unlock(&SEGGER_RTT_Mutex); }
   #else
     #define SEGGER_RTT_LOCK()
     #define SEGGER_RTT_UNLOCK()
@@ -425,5 +459,53 @@ void OS_SIM_LeaveCriticalSection(void);
   #define SEGGER_RTT_UNLOCK()              // Unlock RTT (nestable) (i.e. enable previous interrupt lock state)
 #endif
 
+/*********************************************************************
+*
+*       Lock-free write configuration
+*
+*  SEGGER_RTT_WriteLockFree() needs a 32-bit compare-and-swap (LDREX/STREX on ARM).
+*  On cores without it (Cortex-M0/M0+/M23) or other compilers it falls back to SEGGER_RTT_Write().
+*/
+#ifndef   SEGGER_RTT_LOCKFREE
+  #if ((defined(__GNUC__) || defined(__clang__)) && !defined(__CC_ARM)) &&                          \
+      (defined(__ARM_FEATURE_LDREX) || defined(__aarch64__) || defined(__riscv_atomic) || defined(__x86_64__) || defined(__i386__))
+    #define SEGGER_RTT_LOCKFREE                     (1)
+  #else
+    #define SEGGER_RTT_LOCKFREE                     (0)
+  #endif
+#endif
+
+/*********************************************************************
+*
+*       Post-mortem buffer configuration
+*
+*  _SEGGER_RTT_PostMortem must be in RAM which is neither cleared nor initialized by the startup code,
+*  e.g. GCC linker script:  .noinit (NOLOAD) : { *(.noinit) } > RAM
+*  On Linux with host/rtt_shm.c it goes with _SEGGER_RTT into the shared memory, which is kept over a restart.
+*/
+#ifndef   SEGGER_RTT_POSTMORTEM_SECTION
+  #if defined(__linux__) && defined(SEGGER_RTT_SECTION)
+    #define SEGGER_RTT_POSTMORTEM_SECTION           SEGGER_RTT_SECTION
+  #else
+    #define SEGGER_RTT_POSTMORTEM_SECTION           ".noinit"
+  #endif
+#endif
+
+/*********************************************************************
+*
+*       Statistics configuration
+*
+*  Time base of <BlockedTime> in _SEGGER_RTT_Stats, a free running 32-bit counter.
+*  e.g. on Cortex-M3/4/7 with DWT enabled: #define SEGGER_RTT_STATS_TIME()  (*(volatile unsigned*)0xE0001004)  // DWT->CYCCNT
+*/
+#ifndef   SEGGER_RTT_STATS_TIME
+  #if defined(__linux__) && defined(__GNUC__)
+    #include <time.h>
+    #define SEGGER_RTT_STATS_TIME()  ({ struct timespec _ts; clock_gettime(CLOCK_MONOTONIC, &_ts); (unsigned)(_ts.tv_sec * 1000000u + _ts.tv_nsec / 1000u); })  // us
+  #else
+    #define SEGGER_RTT_STATS_TIME()                 (0u)    // Blocked time is not counted (Default)
+  #endif
+#endif
+
 #endif
 /*************************** End of file ****************************/
@@ -66,14 +66,61 @@ Revision: $Rev: 17697 $
   #define SEGGER_RTT_PRINTF_BUFFER_SIZE (64)
 #endif
 
+#ifndef SEGGER_RTT_PRINTF_DIRECT
+  #define SEGGER_RTT_PRINTF_DIRECT (0)
+#endif
+
+#ifndef SEGGER_RTT_PRINTF_DIRECT_MAX
+  #define SEGGER_RTT_PRINTF_DIRECT_MAX (256u)
+#endif
+
+#ifndef SEGGER_RTT_MEMCPY_USE_BYTELOOP
+  #define SEGGER_RTT_MEMCPY_USE_BYTELOOP 0
+#endif
+
+#ifndef SEGGER_RTT_MEMCPY
+  #ifdef  MEMCPY
+    #define SEGGER_RTT_MEMCPY(pDest, pSrc, NumBytes) MEMCPY((pDest), (pSrc), (NumBytes))
+  #else
+    #define SEGGER_RTT_MEMCPY(pDest, pSrc, NumBytes) memcpy((pDest), (pSrc), (NumBytes))
+  #endif
+#endif
+
+#ifndef SEGGER_RTT_PRINTF_FLOAT_MAX_PREC
+  #define SEGGER_RTT_PRINTF_FLOAT_MAX_PREC (40)    // Max. precision of %f, %e, %g. Larger precisions are clamped
+#endif
+
 #include <stdlib.h>
 #include <stdarg.h>
+#include <stddef.h>
+#include <string.h>
+#if defined(__SSE2__)
+  #include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+  #include <arm_neon.h>
+#endif
+
 
+//
+// _FindSpecifier() reads aligned words behind the '\0', which is safe on real memory (see there),
+// but address sanitizers check bytes, not pages, and would report it.
+//
+#if defined(__has_attribute)
+  #if __has_attribute(no_sanitize)
+    #define _NO_SANITIZE_ADDRESS        __attribute__((no_sanitize("address", "hwaddress")))
+  #elif __has_attribute(no_sanitize_address)
+    #define _NO_SANITIZE_ADDRESS        __attribute__((no_sanitize_address))
+  #endif
+#endif
+#ifndef _NO_SANITIZE_ADDRESS
+  #define _NO_SANITIZE_ADDRESS
+#endif
 
 #define FORMAT_FLAG_LEFT_JUSTIFY   (1u << 0)
 #define FORMAT_FLAG_PAD_ZERO       (1u << 1)
 #define FORMAT_FLAG_PRINT_SIGN     (1u << 2)
 #define FORMAT_FLAG_ALTERNATE      (1u << 3)
+#define FORMAT_FLAG_PRECISION      (1u << 4)
 
 /*********************************************************************
 *
@@ -82,15 +129,25 @@ Revision: $Rev: 17697 $
 **********************************************************************
 */
 
-typedef struct {
+typedef struct SEGGER_RTT_PRINTF_DESC_STRUCT SEGGER_RTT_PRINTF_DESC;
+
+struct SEGGER_RTT_PRINTF_DESC_STRUCT {
   char*     pBuffer;
   unsigned  BufferSize;
   unsigned  Cnt;
 
   int   ReturnValue;
 
+  void    (*pfFlush)(SEGGER_RTT_PRINTF_DESC* p);  // Target: called when the buffer is full
   unsigned RTTBufferIndex;
-} SEGGER_RTT_PRINTF_DESC;
+  SEGGER_RTT_PRINTF_OUTPUT* pfOutput;          // Callback target
+  void*     pContext;
+#if SEGGER_RTT_PRINTF_DIRECT
+  char*     pBuffer1;               // 2nd span of the reservation in the "Up"-buffer
+  unsigned  BufferSize1;
+  unsigned  NumDone;                // Bytes in the 1st span, when formatting continues in the 2nd one
+#endif
+};
 
 /*********************************************************************
 *
@@ -105,6 +162,74 @@ typedef struct {
 *
 **********************************************************************
 */
+/*********************************************************************
+*
+*       _FlushRTT
+*
+*  Function description
+*    Target "Up"-buffer, called when the buffer of the descriptor is full.
+*    Writes it to the "Up"-buffer, or in direct mode continues with the 2nd span of the reservation.
+*/
+static void _FlushRTT(SEGGER_RTT_PRINTF_DESC * p) {
+#if SEGGER_RTT_PRINTF_DIRECT
+  if (p->BufferSize1 != 0u) {           // Wrap-around of the ring buffer
+    p->NumDone     = p->Cnt;
+    p->pBuffer     = p->pBuffer1;
+    p->BufferSize  = p->BufferSize1;
+    p->BufferSize1 = 0u;
+    p->Cnt         = 0u;
+  }
+#else
+  if (SEGGER_RTT_Write(p->RTTBufferIndex, p->pBuffer, p->Cnt) != p->Cnt) {
+    p->ReturnValue = -1;
+  } else {
+    p->Cnt = 0u;
+  }
+#endif
+}
+
+/*********************************************************************
+*
+*       _FlushDiscard
+*
+*  Function description
+*    Target memory, called when the last byte of the buffer is written again.
+*/
+static void _FlushDiscard(SEGGER_RTT_PRINTF_DESC * p) {
+  p->Cnt = 0u;
+}
+
+/*********************************************************************
+*
+*       _FlushMem
+*
+*  Function description
+*    Target memory, called when the buffer of the descriptor is full.
+*    The rest of the output is only counted: it goes to the last byte of the
+*    buffer, which is overwritten by the terminating '\0' at the end.
+*/
+static void _FlushMem(SEGGER_RTT_PRINTF_DESC * p) {
+  p->pBuffer   += p->Cnt;
+  p->BufferSize = 1u;
+  p->Cnt        = 0u;
+  p->pfFlush    = _FlushDiscard;
+}
+
+/*********************************************************************
+*
+*       _FlushCallback
+*
+*  Function description
+*    Target callback, called when the buffer of the descriptor is full.
+*/
+static void _FlushCallback(SEGGER_RTT_PRINTF_DESC * p) {
+  if (p->pfOutput(p->pContext, p->pBuffer, p->Cnt) < 0) {
+    p->ReturnValue = -1;
+  } else {
+    p->Cnt = 0u;
+  }
+}
+
 /*********************************************************************
 *
 *       _StoreChar
@@ -117,41 +242,278 @@ static void _StoreChar(SEGGER_RTT_PRINTF_DESC * p, char c) {
     *(p->pBuffer + Cnt) = c;
     p->Cnt = Cnt + 1u;
     p->ReturnValue++;
+  } else {
+    p->ReturnValue = -1;                // Direct mode: reserved space is used up
   }
   //
   // Write part of string, when the buffer is full
   //
   if (p->Cnt == p->BufferSize) {
-    if (SEGGER_RTT_Write(p->RTTBufferIndex, p->pBuffer, p->Cnt) != p->Cnt) {
-      p->ReturnValue = -1;
-    } else {
-      p->Cnt = 0u;
+    p->pfFlush(p);
+  }
+}
+
+/*********************************************************************
+*
+*       _StoreChars
+*/
+static void _StoreChars(SEGGER_RTT_PRINTF_DESC * p, const char* s, unsigned NumBytes) {
+  unsigned Cnt;
+  unsigned n;
+  char*    pDst;
+
+  while ((NumBytes != 0u) && (p->ReturnValue >= 0)) {
+    Cnt  = p->Cnt;
+    n    = p->BufferSize - Cnt;
+    if (n == 0u) {
+      p->ReturnValue = -1;              // Direct mode: reserved space is used up
+      break;
+    }
+    n    = (NumBytes < n) ? NumBytes : n;
+    pDst = p->pBuffer + Cnt;
+    p->Cnt          = Cnt + n;
+    p->ReturnValue += (int)n;
+    NumBytes       -= n;
+#if SEGGER_RTT_MEMCPY_USE_BYTELOOP
+    while (n--) {
+      *pDst++ = *s++;
+    }
+#else
+    SEGGER_RTT_MEMCPY(pDst, s, n);
+    s += n;
+#endif
+    if (p->Cnt == p->BufferSize) {
+      p->pfFlush(p);
     }
   }
 }
 
 /*********************************************************************
 *
-*       _PrintUnsigned
+*       _FindSpecifier
+*
+*  Function description
+*    Returns the first '%' or the terminating '\0' of a format string, so literal text
+*    is copied as one block. Aligned words are tested at once: 16 bytes with SSE2 (x86 host)
+*    or NEON (AArch64 host), 4 bytes on 32-bit MCUs. An aligned word never crosses a page,
+*    so reading the bytes behind the '\0' can not fault. ASan and HWASan do not check this
+*    function for that reason, the format string is still checked where it is parsed.
 */
-static void _PrintUnsigned(SEGGER_RTT_PRINTF_DESC * pBufferDesc, unsigned v, unsigned Base, unsigned NumDigits, unsigned FieldWidth, unsigned FormatFlags) {
+static _NO_SANITIZE_ADDRESS const char* _FindSpecifier(const char* s) {
+#if defined(__SSE2__)
+  __m128i  v;
+  unsigned Mask;
+
+  while (((size_t)s & 15u) != 0u) {
+    if ((*s == '\0') || (*s == '%')) {
+      return s;
+    }
+    s++;
+  }
+  do {
+    v    = _mm_load_si128((const __m128i*)s);
+    Mask = (unsigned)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_setzero_si128()), _mm_cmpeq_epi8(v, _mm_set1_epi8('%'))));
+    s   += 16;
+  } while (Mask == 0u);
+  return s - 16 + __builtin_ctz(Mask);
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+  uint8x16_t v;
+
+  while (((size_t)s & 15u) != 0u) {
+    if ((*s == '\0') || (*s == '%')) {
+      return s;
+    }
+    s++;
+  }
+  do {
+    v  = vld1q_u8((const uint8_t*)s);
+    v  = vorrq_u8(vceqzq_u8(v), vceqq_u8(v, vdupq_n_u8('%')));
+    s += 16;
+  } while (vmaxvq_u8(v) == 0u);
+  s -= 16;
+#else
+  #if defined(__GNUC__)
+  typedef unsigned __attribute__((__may_alias__)) _WORD;
+  #else
+  typedef unsigned _WORD;
+  #endif
+  unsigned v;
+  unsigned x;
+
+  while (((size_t)s & (sizeof(_WORD) - 1u)) != 0u) {
+    if ((*s == '\0') || (*s == '%')) {
+      return s;
+    }
+    s++;
+  }
+  do {
+    v  = *(const _WORD*)s;
+    x  = v ^ 0x25252525u;                                     // '%' becomes 0
+    v  = ((v - 0x01010101u) & ~v) | ((x - 0x01010101u) & ~x);  // High bit set in bytes which are 0
+    s += 4;
+  } while ((v & 0x80808080u) == 0u);
+  s -= 4;
+#endif
+  while ((*s != '\0') && (*s != '%')) {
+    s++;
+  }
+  return s;
+}
+
+/*********************************************************************
+*
+*       _Div100
+*
+*  Function description
+*    v / 100 by multiplication with the reciprocal.
+*    Cortex-M0 has no divide instruction, a call of the division routine costs 10x more.
+*/
+static unsigned _Div100(unsigned v) {
+  if (v < 43699u) {
+    return (v * 5243u) >> 19;                                     // 5243 / 2^19 = 1 / 100, exact for v < 43699, 32-bit multiply only
+  }
+  return (unsigned)(((unsigned long long)v * 0x51EB851Fu) >> 37);  // 0x51EB851F / 2^37 = 1 / 100, exact for all 32-bit v
+}
+
+/*********************************************************************
+*
+*       _Div1e9
+*
+*  Function description
+*    v / 10^9 = (v / 2^9) / 5^9, the division by 5^9 is a multiplication with 2^75 / 5^9,
+*    exact for all v. Cores without 64-bit divide instruction get 4 multiplications instead of a library call.
+*/
+static unsigned long long _Div1e9(unsigned long long v) {
+  unsigned long long a;
+  unsigned long long Lo;
+  unsigned long long Mid;
+  unsigned long long Hi;
+  unsigned long long Cross;
+
+  a     = v >> 9;
+  Lo    = (a & 0xFFFFFFFFu) * 0xA09B5A53u;
+  Mid   = (a & 0xFFFFFFFFu) * 0x0044B82Fu;
+  Cross = (a >> 32) * 0xA09B5A53u;
+  Hi    = (a >> 32) * 0x0044B82Fu;
+  Mid  += (Lo >> 32) + (Cross & 0xFFFFFFFFu);
+  Hi   += (Mid >> 32) + (Cross >> 32);
+  return Hi >> 11;
+}
+
+/*********************************************************************
+*
+*       _ToDigits
+*
+*  Function description
+*    Converts a number into digits, stored backwards from the end of a buffer.
+*
+*  Parameters
+*    pEnd   Pointer behind the last digit.
+*    v      Number to convert.
+*    Base   10 or 16, others are converted digit by digit with division.
+*
+*  Return value
+*    Number of digits, at least 1.
+*/
+static unsigned _ToDigits(char* pEnd, unsigned v, unsigned Base) {
   static const char _aV2C[16] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' };
-  unsigned Div;
-  unsigned Digit;
-  unsigned Number;
+  static const char _aDigitPair[200] = {
+    '0','0','0','1','0','2','0','3','0','4','0','5','0','6','0','7','0','8','0','9',
+    '1','0','1','1','1','2','1','3','1','4','1','5','1','6','1','7','1','8','1','9',
+    '2','0','2','1','2','2','2','3','2','4','2','5','2','6','2','7','2','8','2','9',
+    '3','0','3','1','3','2','3','3','3','4','3','5','3','6','3','7','3','8','3','9',
+    '4','0','4','1','4','2','4','3','4','4','4','5','4','6','4','7','4','8','4','9',
+    '5','0','5','1','5','2','5','3','5','4','5','5','5','6','5','7','5','8','5','9',
+    '6','0','6','1','6','2','6','3','6','4','6','5','6','6','6','7','6','8','6','9',
+    '7','0','7','1','7','2','7','3','7','4','7','5','7','6','7','7','7','8','7','9',
+    '8','0','8','1','8','2','8','3','8','4','8','5','8','6','8','7','8','8','8','9',
+    '9','0','9','1','9','2','9','3','9','4','9','5','9','6','9','7','9','8','9','9'
+  };
+  char*    p;
+  unsigned q;
+  unsigned r;
+
+  p = pEnd;
+  if (Base == 10u) {
+    //
+    // Two digits per step, from the lowest ones
+    //
+    while (v >= 100u) {
+      q     = _Div100(v);
+      r     = (v - q * 100u) * 2u;
+      v     = q;
+      *--p  = _aDigitPair[r + 1u];
+      *--p  = _aDigitPair[r];
+    }
+    if (v >= 10u) {
+      *--p  = _aDigitPair[v * 2u + 1u];
+      *--p  = _aDigitPair[v * 2u];
+    } else {
+      *--p  = (char)('0' + v);
+    }
+  } else if (Base == 16u) {
+    do {
+      *--p  = _aV2C[v & 0xFu];
+      v   >>= 4;
+    } while (v);
+  } else {
+    do {
+      q     = v / Base;
+      *--p  = _aV2C[v - q * Base];
+      v     = q;
+    } while (v);
+  }
+  return (unsigned)(pEnd - p);
+}
+
+/*********************************************************************
+*
+*       _ToDigits64
+*
+*  Function description
+*    Converts a 64-bit number like _ToDigits(). Base 10 splits off 9 digits with _Div1e9(),
+*    base 16 shifts, so no 64-bit division routine (__aeabi_uldivmod) is called for these.
+*/
+static unsigned _ToDigits64(char* pEnd, unsigned long long v, unsigned Base) {
+  unsigned long long q;
+  char*              p;
+  unsigned           n;
+
+  p = pEnd;
+  while ((v >> 32) != 0u) {
+    if (Base == 10u) {
+      q  = _Div1e9(v);
+      n  = _ToDigits(p, (unsigned)(v - q * 1000000000u), 10u);
+      p -= n;
+      while (n < 9u) {
+        n++;
+        *--p = '0';
+      }
+    } else if (Base == 16u) {
+      q    = v >> 4;
+      *--p = "0123456789ABCDEF"[(unsigned)v & 0xFu];
+    } else {
+      q    = v / Base;
+      *--p = "0123456789ABCDEF"[(unsigned)(v - q * Base)];
+    }
+    v = q;
+  }
+  p -= _ToDigits(p, (unsigned)v, Base);
+  return (unsigned)(pEnd - p);
+}
+
+/*********************************************************************
+*
+*       _PrintDigits
+*
+*  Function description
+*    Prints converted digits with precision and field width.
+*/
+static void _PrintDigits(SEGGER_RTT_PRINTF_DESC * pBufferDesc, const char* pDigit, unsigned Len, unsigned NumDigits, unsigned FieldWidth, unsigned FormatFlags) {
   unsigned Width;
   char c;
 
-  Number = v;
-  Digit = 1u;
-  //
-  // Get actual field width
-  //
-  Width = 1u;
-  while (Number >= Base) {
-    Number = (Number / Base);
-    Width++;
-  }
+  Width = Len;
   if (NumDigits > Width) {
     Width = NumDigits;
   }
@@ -176,33 +538,19 @@ static void _PrintUnsigned(SEGGER_RTT_PRINTF_DESC * pBufferDesc, unsigned v, uns
   }
   if (pBufferDesc->ReturnValue >= 0) {
     //
-    // Compute Digit.
-    // Loop until Digit has the value of the highest digit required.
-    // Example: If the output is 345 (Base 10), loop 2 times until Digit is 100.
+    // Print leading zeros of the precision
     //
-    while (1) {
-      if (NumDigits > 1u) {       // User specified a min number of digits to print? => Make sure we loop at least that often, before checking anything else (> 1 check avoids problems with NumDigits being signed / unsigned)
-        NumDigits--;
-      } else {
-        Div = v / Digit;
-        if (Div < Base) {        // Is our divider big enough to extract the highest digit from value? => Done
-          break;
-        }
-      }
-      Digit *= Base;
+    while ((NumDigits > Len) && (pBufferDesc->ReturnValue >= 0)) {
+      NumDigits--;
+      _StoreChar(pBufferDesc, '0');
     }
     //
     // Output digits
     //
-    do {
-      Div = v / Digit;
-      v -= Div * Digit;
-      _StoreChar(pBufferDesc, _aV2C[Div]);
-      if (pBufferDesc->ReturnValue < 0) {
-        break;
-      }
-      Digit /= Base;
-    } while (Digit);
+    while ((Len != 0u) && (pBufferDesc->ReturnValue >= 0)) {
+      Len--;
+      _StoreChar(pBufferDesc, *pDigit++);
+    }
     //
     // Print trailing spaces if necessary
     //
@@ -222,26 +570,74 @@ static void _PrintUnsigned(SEGGER_RTT_PRINTF_DESC * pBufferDesc, unsigned v, uns
 
 /*********************************************************************
 *
-*       _PrintInt
+*       _PrintUnsigned
 */
-static void _PrintInt(SEGGER_RTT_PRINTF_DESC * pBufferDesc, int v, unsigned Base, unsigned NumDigits, unsigned FieldWidth, unsigned FormatFlags) {
+static void _PrintUnsigned(SEGGER_RTT_PRINTF_DESC * pBufferDesc, unsigned v, unsigned Base, unsigned NumDigits, unsigned FieldWidth, unsigned FormatFlags) {
+  char     acDigits[32];          // Enough for 32 bits in any base >= 2
+  unsigned Len;
+
+  //
+  // Convert first, so the actual field width is known without dividing
+  //
+  Len = _ToDigits(acDigits + sizeof(acDigits), v, Base);
+  _PrintDigits(pBufferDesc, acDigits + sizeof(acDigits) - Len, Len, NumDigits, FieldWidth, FormatFlags);
+}
+
+/*********************************************************************
+*
+*       _PrintUnsigned64
+*/
+static void _PrintUnsigned64(SEGGER_RTT_PRINTF_DESC * pBufferDesc, unsigned long long v, unsigned Base, unsigned NumDigits, unsigned FieldWidth, unsigned FormatFlags) {
+  char     acDigits[24];          // Enough for 64 bits in base 8 and above
+  unsigned Len;
+
+  Len = _ToDigits64(acDigits + sizeof(acDigits), v, Base);
+  _PrintDigits(pBufferDesc, acDigits + sizeof(acDigits) - Len, Len, NumDigits, FieldWidth, FormatFlags);
+}
+
+/*********************************************************************
+*
+*       _GetNumDigits
+*
+*  Function description
+*    Number of digits of v, found by comparison instead of division.
+*/
+static unsigned _GetNumDigits(unsigned v, unsigned Base) {
+  static const unsigned _aPow10[9] = { 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u, 100000000u, 1000000000u };
   unsigned Width;
-  int Number;
 
-  Number = (v < 0) ? -v : v;
+  Width = 1u;
+  if (Base == 10u) {
+    while ((Width < 10u) && (v >= _aPow10[Width - 1u])) {
+      Width++;
+    }
+  } else {
+    while (v >= Base) {
+      v = v / Base;
+      Width++;
+    }
+  }
+  return Width;
+}
+
+/*********************************************************************
+*
+*       _PrintSigned
+*
+*  Function description
+*    Prints sign and converted digits of a signed number.
+*/
+static void _PrintSigned(SEGGER_RTT_PRINTF_DESC * pBufferDesc, const char* pDigit, unsigned Len, int IsNegative, unsigned NumDigits, unsigned FieldWidth, unsigned FormatFlags) {
+  unsigned Width;
 
   //
   // Get actual field width
   //
-  Width = 1u;
-  while (Number >= (int)Base) {
-    Number = (Number / (int)Base);
-    Width++;
-  }
+  Width = Len;
   if (NumDigits > Width) {
     Width = NumDigits;
   }
-  if ((FieldWidth > 0u) && ((v < 0) || ((FormatFlags & FORMAT_FLAG_PRINT_SIGN) == FORMAT_FLAG_PRINT_SIGN))) {
+  if ((FieldWidth > 0u) && (IsNegative || ((FormatFlags & FORMAT_FLAG_PRINT_SIGN) == FORMAT_FLAG_PRINT_SIGN))) {
     FieldWidth--;
   }
 
@@ -263,8 +659,7 @@ static void _PrintInt(SEGGER_RTT_PRINTF_DESC * pBufferDesc, int v, unsigned Base
   // Print sign if necessary
   //
   if (pBufferDesc->ReturnValue >= 0) {
-    if (v < 0) {
-      v = -v;
+    if (IsNegative) {
       _StoreChar(pBufferDesc, '-');
     } else if ((FormatFlags & FORMAT_FLAG_PRINT_SIGN) == FORMAT_FLAG_PRINT_SIGN) {
       _StoreChar(pBufferDesc, '+');
@@ -290,7 +685,7 @@ static void _PrintInt(SEGGER_RTT_PRINTF_DESC * pBufferDesc, int v, unsigned Base
         //
         // Print number without sign
         //
-        _PrintUnsigned(pBufferDesc, (unsigned)v, Base, NumDigits, FieldWidth, FormatFlags);
+        _PrintDigits(pBufferDesc, pDigit, Len, NumDigits, FieldWidth, FormatFlags);
       }
     }
   }
@@ -298,55 +693,620 @@ static void _PrintInt(SEGGER_RTT_PRINTF_DESC * pBufferDesc, int v, unsigned Base
 
 /*********************************************************************
 *
-*       Public code
+*       _PrintInt
+*/
+static void _PrintInt(SEGGER_RTT_PRINTF_DESC * pBufferDesc, int v, unsigned Base, unsigned NumDigits, unsigned FieldWidth, unsigned FormatFlags) {
+  char     acDigits[32];
+  unsigned Len;
+
+  Len = _ToDigits(acDigits + sizeof(acDigits), (v < 0) ? (0u - (unsigned)v) : (unsigned)v, Base);
+  _PrintSigned(pBufferDesc, acDigits + sizeof(acDigits) - Len, Len, v < 0, NumDigits, FieldWidth, FormatFlags);
+}
+
+/*********************************************************************
 *
-**********************************************************************
+*       _PrintInt64
+*/
+static void _PrintInt64(SEGGER_RTT_PRINTF_DESC * pBufferDesc, long long v, unsigned Base, unsigned NumDigits, unsigned FieldWidth, unsigned FormatFlags) {
+  char     acDigits[24];
+  unsigned Len;
+
+  Len = _ToDigits64(acDigits + sizeof(acDigits), (v < 0) ? (0u - (unsigned long long)v) : (unsigned long long)v, Base);
+  _PrintSigned(pBufferDesc, acDigits + sizeof(acDigits) - Len, Len, v < 0, NumDigits, FieldWidth, FormatFlags);
+}
+
+/*********************************************************************
+*
+*       Float conversion
+*
+*  The value |v| = M * 2^E is converted exactly with integers only:
+*  N = round(|v| * 10^p) is computed as M * 5^p shifted by E + p (or divided by 10^-p),
+*  rounded half to even, then N is split into 9-digit chunks.
+*  The result is the same as printf() of the C library, and no soft-float routine is called.
+*  N needs up to 1024 + 53 + 2.33 * SEGGER_RTT_PRINTF_FLOAT_MAX_PREC bits,
+*  the default needs about 330 bytes of stack, huge or tiny values only cost time, not stack.
 */
+#define _FLOAT_NUM_WORDS   ((1100u + (SEGGER_RTT_PRINTF_FLOAT_MAX_PREC * 7u) / 3u) / 32u + 1u)
+
+typedef struct {
+  unsigned aWord[_FLOAT_NUM_WORDS];   // Little endian
+  unsigned NumWords;                  // 0 for value 0
+} _BIG_NUM;
+
 /*********************************************************************
 *
-*       SEGGER_RTT_vprintf
+*       _BigSet
+*/
+static void _BigSet(_BIG_NUM* pBig, unsigned long long v) {
+  pBig->aWord[0] = (unsigned)v;
+  pBig->aWord[1] = (unsigned)(v >> 32);
+  pBig->NumWords = (v >> 32) ? 2u : ((v != 0u) ? 1u : 0u);
+}
+
+/*********************************************************************
 *
-*  Function description
-*    Stores a formatted string in SEGGER RTT control block.
-*    This data is read by the host.
+*       _BigMulSmall
+*/
+static void _BigMulSmall(_BIG_NUM* pBig, unsigned m) {
+  unsigned long long Acc;
+  unsigned i;
+
+  Acc = 0u;
+  for (i = 0u; i < pBig->NumWords; i++) {
+    Acc += (unsigned long long)pBig->aWord[i] * m;
+    pBig->aWord[i] = (unsigned)Acc;
+    Acc >>= 32;
+  }
+  if (Acc != 0u) {
+    pBig->aWord[pBig->NumWords++] = (unsigned)Acc;
+  }
+}
+
+/*********************************************************************
 *
-*  Parameters
-*    BufferIndex  Index of "Up"-buffer to be used. (e.g. 0 for "Terminal")
-*    sFormat      Pointer to format string
-*    pParamList   Pointer to the list of arguments for the format string
+*       _BigDivSmall
 *
-*  Return values
-*    >= 0:  Number of bytes which have been stored in the "Up"-buffer.
-*     < 0:  Error
+*  Return value
+*    Remainder.
 */
-int SEGGER_RTT_vprintf(unsigned BufferIndex, const char * sFormat, va_list * pParamList) {
-  char c;
-  SEGGER_RTT_PRINTF_DESC BufferDesc;
-  int v;
-  unsigned NumDigits;
-  unsigned FormatFlags;
-  unsigned FieldWidth;
-  char acBuffer[SEGGER_RTT_PRINTF_BUFFER_SIZE];
+static unsigned _BigDivSmall(_BIG_NUM* pBig, unsigned d) {
+  unsigned long long Cur;
+  unsigned Rem;
+  unsigned i;
 
-  BufferDesc.pBuffer        = acBuffer;
-  BufferDesc.BufferSize     = SEGGER_RTT_PRINTF_BUFFER_SIZE;
-  BufferDesc.Cnt            = 0u;
-  BufferDesc.RTTBufferIndex = BufferIndex;
-  BufferDesc.ReturnValue    = 0;
+  Rem = 0u;
+  i   = pBig->NumWords;
+  while (i != 0u) {
+    i--;
+    Cur = ((unsigned long long)Rem << 32) | pBig->aWord[i];
+    pBig->aWord[i] = (unsigned)(Cur / d);
+    Rem = (unsigned)(Cur - (unsigned long long)pBig->aWord[i] * d);
+  }
+  while ((pBig->NumWords != 0u) && (pBig->aWord[pBig->NumWords - 1u] == 0u)) {
+    pBig->NumWords--;
+  }
+  return Rem;
+}
 
-  do {
-    c = *sFormat;
-    sFormat++;
-    if (c == 0u) {
-      break;
+/*********************************************************************
+*
+*       _BigShl
+*/
+static void _BigShl(_BIG_NUM* pBig, unsigned s) {
+  unsigned Words;
+  unsigned Bits;
+  unsigned i;
+
+  if (pBig->NumWords == 0u) {
+    return;
+  }
+  Words = s / 32u;
+  Bits  = s % 32u;
+  pBig->aWord[pBig->NumWords + Words] = 0u;
+  for (i = pBig->NumWords; i != 0u; i--) {
+    if (Bits) {
+      pBig->aWord[i + Words] |= pBig->aWord[i - 1u] >> (32u - Bits);
     }
-    if (c == '%') {
-      //
-      // Filter out flags
-      //
-      FormatFlags = 0u;
-      v = 1;
-      do {
+    pBig->aWord[i - 1u + Words] = pBig->aWord[i - 1u] << Bits;
+  }
+  for (i = 0u; i < Words; i++) {
+    pBig->aWord[i] = 0u;
+  }
+  pBig->NumWords += Words + 1u;
+  if (pBig->aWord[pBig->NumWords - 1u] == 0u) {
+    pBig->NumWords--;
+  }
+}
+
+/*********************************************************************
+*
+*       _BigShr
+*
+*  Return value
+*    0: Shifted out bits are 0
+*    1: Below half
+*    2: Exactly half
+*    3: Above half
+*/
+static unsigned _BigShr(_BIG_NUM* pBig, unsigned s) {
+  unsigned Words;
+  unsigned Bits;
+  unsigned Half;
+  unsigned Sticky;
+  unsigned i;
+
+  if (s == 0u) {
+    return 0u;
+  }
+  Words = (s - 1u) / 32u;             // Word of the half bit
+  Half  = (Words < pBig->NumWords) ? ((pBig->aWord[Words] >> ((s - 1u) % 32u)) & 1u) : 0u;
+  Sticky = 0u;
+  for (i = 0u; (i < Words) && (i < pBig->NumWords); i++) {
+    Sticky |= pBig->aWord[i];
+  }
+  if ((Words < pBig->NumWords) && ((s - 1u) % 32u)) {
+    Sticky |= pBig->aWord[Words] << (32u - ((s - 1u) % 32u));
+  }
+  Words = s / 32u;
+  Bits  = s % 32u;
+  if (Words >= pBig->NumWords) {
+    pBig->NumWords = 0u;
+  } else {
+    for (i = 0u; i + Words < pBig->NumWords; i++) {
+      pBig->aWord[i] = pBig->aWord[i + Words] >> Bits;
+      if (Bits && (i + Words + 1u < pBig->NumWords)) {
+        pBig->aWord[i] |= pBig->aWord[i + Words + 1u] << (32u - Bits);
+      }
+    }
+    pBig->NumWords -= Words;
+    while ((pBig->NumWords != 0u) && (pBig->aWord[pBig->NumWords - 1u] == 0u)) {
+      pBig->NumWords--;
+    }
+  }
+  if (Half) {
+    return Sticky ? 3u : 2u;
+  }
+  return Sticky ? 1u : 0u;
+}
+
+/*********************************************************************
+*
+*       _BigRound
+*
+*  Function description
+*    Rounds half to even, according to the part which has been cut off.
+*/
+static void _BigRound(_BIG_NUM* pBig, unsigned CutOff) {
+  unsigned i;
+
+  if ((CutOff == 3u) || ((CutOff == 2u) && (pBig->NumWords != 0u) && (pBig->aWord[0] & 1u))) {
+    for (i = 0u; i < pBig->NumWords; i++) {
+      if (++pBig->aWord[i] != 0u) {
+        return;
+      }
+    }
+    pBig->aWord[pBig->NumWords++] = 1u;
+  }
+}
+
+/*********************************************************************
+*
+*       _ScaleRound
+*
+*  Function description
+*    pBig = round(M * 2^E * 10^p), rounded half to even.
+*/
+static void _ScaleRound(_BIG_NUM* pBig, unsigned long long M, int E, int p) {
+  static const unsigned _aPow10[10] = { 1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u, 100000000u, 1000000000u };
+  static const unsigned _aPow5[13]  = { 1u, 5u, 25u, 125u, 625u, 3125u, 15625u, 78125u, 390625u, 1953125u, 9765625u, 48828125u, 244140625u };
+  unsigned CutOff;
+  unsigned Rem;
+  unsigned Sticky;
+  unsigned n;
+
+  _BigSet(pBig, M);
+  if (p >= 0) {
+    //
+    // M * 5^p * 2^(E + p)
+    //
+    for (n = (unsigned)p; n >= 13u; n -= 13u) {
+      _BigMulSmall(pBig, 1220703125u);      // 5^13
+    }
+    if (n != 0u) {
+      _BigMulSmall(pBig, _aPow5[n]);
+    }
+    if (E + p >= 0) {
+      _BigShl(pBig, (unsigned)(E + p));
+    } else {
+      CutOff = _BigShr(pBig, (unsigned)-(E + p));
+      _BigRound(pBig, CutOff);
+    }
+  } else {
+    //
+    // Integer part of M * 2^E, divided by 10^-p. Lower parts are divided first, the last remainder is the top of the cut off part.
+    //
+    Sticky = 0u;
+    if (E >= 0) {
+      _BigShl(pBig, (unsigned)E);
+    } else {
+      Sticky = _BigShr(pBig, (unsigned)-E);
+    }
+    n      = (unsigned)-p;
+    CutOff = 0u;
+    while (n != 0u) {
+      if (n > 9u) {
+        Sticky |= _BigDivSmall(pBig, 1000000000u);
+        n -= 9u;
+      } else {
+        Rem = _BigDivSmall(pBig, _aPow10[n]);
+        if (Rem > 5u * _aPow10[n - 1u]) {
+          CutOff = 3u;
+        } else if (Rem == 5u * _aPow10[n - 1u]) {
+          CutOff = Sticky ? 3u : 2u;
+        } else {
+          CutOff = (Rem || Sticky) ? 1u : 0u;
+        }
+        n = 0u;
+      }
+    }
+    _BigRound(pBig, CutOff);
+  }
+}
+
+/*********************************************************************
+*
+*       _BigToChunks
+*
+*  Function description
+*    Splits N into 9-digit chunks, lowest first. pBig is destroyed.
+*
+*  Return value
+*    Number of decimal digits of N, 1 for N = 0.
+*/
+static unsigned _BigToChunks(_BIG_NUM* pBig, unsigned* paChunk, unsigned* pNumChunks) {
+  unsigned long long v;
+  unsigned long long q;
+  unsigned           NumChunks;
+
+  NumChunks = 0u;
+  while (pBig->NumWords > 2u) {
+    paChunk[NumChunks++] = _BigDivSmall(pBig, 1000000000u);
+  }
+  //
+  // The last 64 bits, most values only have these
+  //
+  v = ((unsigned long long)pBig->aWord[1] << 32) | pBig->aWord[0];
+  if (pBig->NumWords < 2u) {
+    v = (pBig->NumWords != 0u) ? pBig->aWord[0] : 0u;
+  }
+  do {
+    q = _Div1e9(v);
+    paChunk[NumChunks++] = (unsigned)(v - q * 1000000000u);
+    v = q;
+  } while (v != 0u);
+  *pNumChunks = NumChunks;
+  return (NumChunks - 1u) * 9u + _GetNumDigits(paChunk[NumChunks - 1u], 10u);
+}
+
+/*********************************************************************
+*
+*       _CountTrailingZeros
+*/
+static unsigned _CountTrailingZeros(const unsigned* paChunk, unsigned NumChunks, unsigned NumDigits) {
+  unsigned Cnt;
+  unsigned v;
+  unsigned i;
+
+  Cnt = 0u;
+  for (i = 0u; i < NumChunks; i++) {
+    v = paChunk[i];
+    if (v != 0u) {
+      while ((v % 10u) == 0u) {
+        v /= 10u;
+        Cnt++;
+      }
+      return Cnt;
+    }
+    Cnt += 9u;
+  }
+  return NumDigits;                   // N = 0
+}
+
+/*********************************************************************
+*
+*       _StoreRun
+*
+*  Function description
+*    Stores NumBytes digits (zeros if s is NULL) at output position *pIdx,
+*    the decimal point is inserted before position DotPos.
+*/
+static void _StoreRun(SEGGER_RTT_PRINTF_DESC * pBufferDesc, const char* s, unsigned NumBytes, unsigned* pIdx, unsigned DotPos) {
+  static const char _acZeros[16] = { '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0' };
+  unsigned n;
+
+  while (NumBytes != 0u) {
+    if (*pIdx == DotPos) {
+      _StoreChar(pBufferDesc, '.');
+    }
+    n = NumBytes;
+    if ((*pIdx < DotPos) && (DotPos - *pIdx < n)) {
+      n = DotPos - *pIdx;
+    }
+    if ((s == NULL) && (n > sizeof(_acZeros))) {
+      n = sizeof(_acZeros);
+    }
+    _StoreChars(pBufferDesc, (s != NULL) ? s : _acZeros, n);
+    if (s != NULL) {
+      s += n;
+    }
+    *pIdx    += n;
+    NumBytes -= n;
+  }
+}
+
+/*********************************************************************
+*
+*       _StoreDigits
+*
+*  Function description
+*    Stores NumZeros leading zeros, the digits of N and trailing zeros, NumOut digits in total,
+*    with the decimal point after DotPos digits.
+*/
+static void _StoreDigits(SEGGER_RTT_PRINTF_DESC * pBufferDesc, const unsigned* paChunk, unsigned NumChunks, unsigned NumZeros, unsigned DotPos, unsigned NumOut, int ForceDot) {
+  char     acDigits[9];
+  unsigned Idx;
+  unsigned Len;
+  unsigned i;
+  char*    p;
+
+  Idx = 0u;
+  _StoreRun(pBufferDesc, NULL, (NumZeros < NumOut) ? NumZeros : NumOut, &Idx, DotPos);
+  i = NumChunks;
+  while ((i != 0u) && (Idx < NumOut)) {
+    i--;
+    Len = _ToDigits(acDigits + 9, paChunk[i], 10u);
+    if (i != NumChunks - 1u) {   // Lower chunks have 9 digits
+      while (Len < 9u) {
+        Len++;
+        acDigits[9u - Len] = '0';
+      }
+    }
+    p = acDigits + 9 - Len;
+    if (Len > NumOut - Idx) {    // %g without trailing zeros
+      Len = NumOut - Idx;
+    }
+    _StoreRun(pBufferDesc, p, Len, &Idx, DotPos);
+  }
+  _StoreRun(pBufferDesc, NULL, NumOut - Idx, &Idx, DotPos);
+  if ((DotPos == NumOut) && ForceDot) {
+    _StoreChar(pBufferDesc, '.');
+  }
+}
+
+/*********************************************************************
+*
+*       _PrintFloat
+*
+*  Function description
+*    Prints a double for %f, %e, %g (%F, %E, %G).
+*
+*  Parameters
+*    Conv        Conversion specifier.
+*    Precision   Precision, 6 if it has not been specified (FORMAT_FLAG_PRECISION).
+*/
+static void _PrintFloat(SEGGER_RTT_PRINTF_DESC * pBufferDesc, double v, char Conv, unsigned Precision, unsigned FieldWidth, unsigned FormatFlags) {
+  union { double d; unsigned long long u; } Bits;
+  _BIG_NUM           Big;
+  unsigned           aChunk[_FLOAT_NUM_WORDS + 1u];
+  unsigned           NumChunks;
+  unsigned long long M;
+  const char*        s;
+  char               acExp[8];
+  char               Sign;
+  char               c;
+  int                E;
+  int                X;
+  int                Upper;
+  int                ForceDot;
+  int                ExpStyle;
+  unsigned           NumDigits;
+  unsigned           NumZeros;
+  unsigned           NumOut;
+  unsigned           DotPos;
+  unsigned           ExpLen;
+  unsigned           Width;
+  unsigned           Frac;
+  unsigned           Strip;
+  unsigned           P;
+  unsigned           i;
+
+  Bits.d   = v;
+  Upper    = (Conv == 'F') || (Conv == 'E') || (Conv == 'G');
+  Conv     = (char)(Conv | 0x20);
+  ForceDot = ((FormatFlags & FORMAT_FLAG_ALTERNATE) == FORMAT_FLAG_ALTERNATE);
+  Sign     = (Bits.u >> 63) ? '-' : (((FormatFlags & FORMAT_FLAG_PRINT_SIGN) == FORMAT_FLAG_PRINT_SIGN) ? '+' : 0);
+  if ((FormatFlags & FORMAT_FLAG_PRECISION) == 0u) {
+    Precision = 6u;
+  }
+  if (Precision > SEGGER_RTT_PRINTF_FLOAT_MAX_PREC) {
+    Precision = SEGGER_RTT_PRINTF_FLOAT_MAX_PREC;
+  }
+  E = (int)((Bits.u >> 52) & 0x7FFu);
+  M = Bits.u & 0xFFFFFFFFFFFFFull;
+  //
+  // inf, nan: never padded with zeros
+  //
+  if (E == 0x7FF) {
+    if (M != 0u) {
+      s = Upper ? "NAN" : "nan";
+    } else {
+      s = Upper ? "INF" : "inf";
+    }
+    Width = 3u + (Sign ? 1u : 0u);
+    if ((FormatFlags & FORMAT_FLAG_LEFT_JUSTIFY) == 0u) {
+      while (FieldWidth > Width) {
+        FieldWidth--;
+        _StoreChar(pBufferDesc, ' ');
+      }
+    }
+    if (Sign) {
+      _StoreChar(pBufferDesc, Sign);
+    }
+    while (*s) {
+      _StoreChar(pBufferDesc, *s++);
+    }
+    while (FieldWidth > Width) {
+      FieldWidth--;
+      _StoreChar(pBufferDesc, ' ');
+    }
+    return;
+  }
+  if (E == 0) {
+    E = 1;                            // Subnormal
+  } else {
+    M |= 1ull << 52;
+  }
+  E -= 1075;
+  //
+  // Decimal exponent X of the value rounded to P significant digits (%e, %g)
+  //
+  X = 0;
+  P = 0u;
+  if (Conv != 'f') {
+    P = Precision + 1u;
+    if (Conv == 'g') {
+      P = Precision ? Precision : 1u;
+    }
+    if (M != 0u) {
+      for (i = 0u; (M >> i) > 1u; i++) {
+      }
+      X = E + (int)i;                 // floor(log2(v))
+      X = (X >= 0) ? ((X * 78913) >> 18) : -(int)((((unsigned)-X * 78913u) + (1u << 18) - 1u) >> 18);   // floor(X * log10(2)), never above floor(log10(v))
+      do {
+        _ScaleRound(&Big, M, E, (int)P - 1 - X);
+        NumDigits = _BigToChunks(&Big, aChunk, &NumChunks);
+        if (NumDigits > P) {
+          X++;
+        }
+      } while (NumDigits > P);
+    }
+  }
+  //
+  // Layout
+  //
+  ExpStyle = (Conv == 'e') || ((Conv == 'g') && ((X < -4) || (X >= (int)P)));
+  if (ExpStyle) {
+    if (M == 0u) {
+      aChunk[0] = 0u;
+      NumChunks = 1u;
+    }
+    Frac     = P - 1u;
+    NumZeros = 0u;
+    NumOut   = P;
+    DotPos   = 1u;
+  } else {
+    Frac = (Conv == 'f') ? Precision : (unsigned)((int)P - 1 - X);
+    if ((Conv == 'f') || (M == 0u)) {
+      _ScaleRound(&Big, M, E, (int)Frac);
+      NumDigits = _BigToChunks(&Big, aChunk, &NumChunks);
+    }
+    NumOut   = (NumDigits > Frac) ? NumDigits : (Frac + 1u);
+    NumZeros = NumOut - NumDigits;
+    DotPos   = NumOut - Frac;
+  }
+  if ((Conv == 'g') && !ForceDot) {   // %g removes trailing zeros of the fraction
+    Strip = _CountTrailingZeros(aChunk, NumChunks, NumDigits);
+    if (M == 0u) {
+      Strip = Frac;
+    }
+    if (Strip > Frac) {
+      Strip = Frac;
+    }
+    NumOut -= Strip;
+  }
+  ExpLen = 0u;
+  if (ExpStyle) {
+    i = _ToDigits(acExp + sizeof(acExp), (unsigned)((X < 0) ? -X : X), 10u);
+    if (i < 2u) {
+      acExp[sizeof(acExp) - 2u] = '0';
+      i = 2u;
+    }
+    acExp[sizeof(acExp) - i - 1u] = (X < 0) ? '-' : '+';
+    acExp[sizeof(acExp) - i - 2u] = Upper ? 'E' : 'e';
+    ExpLen = i + 2u;
+  }
+  //
+  // Print with padding
+  //
+  Width = (Sign ? 1u : 0u) + NumOut + (((DotPos < NumOut) || ForceDot) ? 1u : 0u) + ExpLen;
+  c = 0;
+  if ((FormatFlags & FORMAT_FLAG_LEFT_JUSTIFY) == 0u) {
+    c = ((FormatFlags & FORMAT_FLAG_PAD_ZERO) == FORMAT_FLAG_PAD_ZERO) ? '0' : ' ';
+  }
+  if (c == ' ') {
+    while (FieldWidth > Width) {
+      FieldWidth--;
+      _StoreChar(pBufferDesc, ' ');
+    }
+  }
+  if (Sign) {
+    _StoreChar(pBufferDesc, Sign);
+  }
+  if (c == '0') {
+    while (FieldWidth > Width) {
+      FieldWidth--;
+      _StoreChar(pBufferDesc, '0');
+    }
+  }
+  _StoreDigits(pBufferDesc, aChunk, NumChunks, NumZeros, DotPos, NumOut, ForceDot);
+  for (i = sizeof(acExp) - ExpLen; i < sizeof(acExp); i++) {
+    _StoreChar(pBufferDesc, acExp[i]);
+  }
+  while (FieldWidth > Width) {
+    FieldWidth--;
+    _StoreChar(pBufferDesc, ' ');
+  }
+}
+
+/*********************************************************************
+*
+*       _VPrintf
+*
+*  Function description
+*    Formats into the buffer of the descriptor, which is passed to its target when full.
+*    The remaining bytes are left in the buffer for the caller.
+*/
+static void _VPrintf(SEGGER_RTT_PRINTF_DESC * pBufferDesc, const char * sFormat, va_list * pParamList) {
+  char c;
+  const char* pLiteral;
+  int v;
+  unsigned NumDigits;
+  unsigned FormatFlags;
+  unsigned FieldWidth;
+  unsigned ArgSize;
+  unsigned Base;
+
+  do {
+    //
+    // Copy literal text up to the next conversion specification as one block
+    //
+    pLiteral = sFormat;
+    sFormat  = _FindSpecifier(sFormat);
+    if (sFormat != pLiteral) {
+      _StoreChars(pBufferDesc, pLiteral, (unsigned)(sFormat - pLiteral));
+    }
+    c = *sFormat;
+    sFormat++;
+    if (c == 0u) {
+      break;
+    }
+    if (c == '%') {
+      //
+      // Filter out flags
+      //
+      FormatFlags = 0u;
+      v = 1;
+      do {
         c = *sFormat;
         switch (c) {
         case '-': FormatFlags |= FORMAT_FLAG_LEFT_JUSTIFY; sFormat++; break;
@@ -375,6 +1335,7 @@ int SEGGER_RTT_vprintf(unsigned BufferIndex, const char * sFormat, va_list * pPa
       NumDigits = 0u;
       c = *sFormat;
       if (c == '.') {
+        FormatFlags |= FORMAT_FLAG_PRECISION;
         sFormat++;
         do {
           c = *sFormat;
@@ -388,14 +1349,28 @@ int SEGGER_RTT_vprintf(unsigned BufferIndex, const char * sFormat, va_list * pPa
       //
       // Filter out length modifier
       //
+      // Only the size of the argument is kept, e.g. 'l' is 64 bits on LP64 hosts and 32 bits on ARM
+      //
+      ArgSize = sizeof(int);
       c = *sFormat;
       do {
-        if ((c == 'l') || (c == 'h')) {
-          sFormat++;
-          c = *sFormat;
+        if (c == 'h') {
+          ArgSize = (ArgSize == sizeof(short)) ? sizeof(char) : sizeof(short);
+        } else if (c == 'l') {
+          ArgSize = (ArgSize == sizeof(long)) ? sizeof(long long) : sizeof(long);
+        } else if (c == 'j') {
+          ArgSize = sizeof(long long);
+        } else if (c == 'z') {
+          ArgSize = sizeof(size_t);
+        } else if (c == 't') {
+          ArgSize = sizeof(ptrdiff_t);
+        } else if (c == 'L') {
+          // Ignored, long double is not supported
         } else {
           break;
         }
+        sFormat++;
+        c = *sFormat;
       } while (1);
       //
       // Handle specifiers
@@ -405,70 +1380,47 @@ int SEGGER_RTT_vprintf(unsigned BufferIndex, const char * sFormat, va_list * pPa
         char c0;
         v = va_arg(*pParamList, int);
         c0 = (char)v;
-        _StoreChar(&BufferDesc, c0);
+        _StoreChar(pBufferDesc, c0);
         break;
       }
       case 'd':
+      case 'i':
+        if (ArgSize > sizeof(int)) {
+          _PrintInt64(pBufferDesc, va_arg(*pParamList, long long), 10u, NumDigits, FieldWidth, FormatFlags);
+          break;
+        }
         v = va_arg(*pParamList, int);
-        _PrintInt(&BufferDesc, v, 10u, NumDigits, FieldWidth, FormatFlags);
+        if (ArgSize == sizeof(short)) {
+          v = (short)v;
+        } else if (ArgSize == sizeof(char)) {
+          v = (signed char)v;
+        }
+        _PrintInt(pBufferDesc, v, 10u, NumDigits, FieldWidth, FormatFlags);
         break;
       case 'u':
-        v = va_arg(*pParamList, int);
-        _PrintUnsigned(&BufferDesc, (unsigned)v, 10u, NumDigits, FieldWidth, FormatFlags);
-        break;
       case 'x':
       case 'X':
+        Base = (c == 'u') ? 10u : 16u;
+        if (ArgSize > sizeof(unsigned)) {
+          _PrintUnsigned64(pBufferDesc, va_arg(*pParamList, unsigned long long), Base, NumDigits, FieldWidth, FormatFlags);
+          break;
+        }
         v = va_arg(*pParamList, int);
-        _PrintUnsigned(&BufferDesc, (unsigned)v, 16u, NumDigits, FieldWidth, FormatFlags);
+        if (ArgSize == sizeof(short)) {
+          v = (unsigned short)v;
+        } else if (ArgSize == sizeof(char)) {
+          v = (unsigned char)v;
+        }
+        _PrintUnsigned(pBufferDesc, (unsigned)v, Base, NumDigits, FieldWidth, FormatFlags);
         break;
-#if 1     // support float by djd 20221114, current do NOT support some FormatFlags param, eg: '0', '+' '#'.
-          // fixbug by djd 20251231; try it by "%f", "%7.3f", "%-7.3f".
       case 'f':
-      {
-          double dv = va_arg(*pParamList, double);  // get number
-          int int_num, doub_num;
-          unsigned total_width = 0, base = 1, int_bit = 0;
-          int is_negative = (dv < 0);               // 先保存符号
-          if (is_negative) dv = -dv;                // 转为正数处理
-
-          if(NumDigits == 0) {
-              NumDigits = 2;        		// 默认显示两位小数
-          }
-
-          base = 1;
-          for(int i = 0; i < NumDigits; i++) {
-              base *= 10;
-          }
-          dv += 0.5 / base;                                   // 四舍五入
-          int_num = (int)dv;                                // 取整数部分
-          doub_num = (int)((dv - int_num) * base + 1e-9);   // 取小数部分 (1e-9防止浮点截断, 如14.0变13.999...)
-
-          // 计算整数部分位宽
-          base = 1;
-          while(int_num / base != 0) {
-              int_bit++;
-              base *= 10;
-          }
-          if(int_bit == 0) { int_bit = 1; }
-
-          // 计算整个数据位宽
-          total_width = (is_negative ? 1 : 0) + int_bit + 1 + NumDigits;   // 符号 + 整数部分 + 小数点 + 小数部分
-
-          if(FieldWidth > total_width && !(FormatFlags & FORMAT_FLAG_LEFT_JUSTIFY)) {   // 当指定位宽比实际位宽大，且数据非左对齐时
-              for(unsigned i = 0; i < FieldWidth - total_width; i++)
-                _StoreChar(&BufferDesc, ' ');   // 使用空格占位多余的空间
-          }
-          if(is_negative && (int_num || doub_num)) { _StoreChar(&BufferDesc, '-'); }   // 打印负数的负号
-          _PrintUnsigned(&BufferDesc, int_num, 10u, int_bit, int_bit, 0);   // 打印浮点数的整数部分
-          _StoreChar(&BufferDesc, '.');			// 打印浮点数的小数点
-          _PrintUnsigned(&BufferDesc, doub_num, 10u, NumDigits, NumDigits, FORMAT_FLAG_PAD_ZERO);   // 打印浮点数的小数部分
-          if(FieldWidth > total_width && (FormatFlags & FORMAT_FLAG_LEFT_JUSTIFY)) {    // 当指定位宽比实际位宽大，且数据左对齐时
-              for(unsigned i = 0; i < FieldWidth - total_width; i++)
-                _StoreChar(&BufferDesc, ' ');   // 使用空格占位多余的空间
-          }
-          break;
-      }
-#endif
+      case 'F':
+      case 'e':
+      case 'E':
+      case 'g':
+      case 'G':
+        _PrintFloat(pBufferDesc, va_arg(*pParamList, double), c, NumDigits, FieldWidth, FormatFlags);
+        break;
       case 's':
         {
           const char * s = va_arg(*pParamList, const char *);
@@ -478,26 +1430,145 @@ int SEGGER_RTT_vprintf(unsigned BufferIndex, const char * sFormat, va_list * pPa
             if (c == '\0') {
               break;
             }
-           _StoreChar(&BufferDesc, c);
-          } while (BufferDesc.ReturnValue >= 0);
+           _StoreChar(pBufferDesc, c);
+          } while (pBufferDesc->ReturnValue >= 0);
         }
         break;
       case 'p':
-        v = va_arg(*pParamList, int);
-        _PrintUnsigned(&BufferDesc, (unsigned)v, 16u, 8u, 8u, 0u);
+        //
+        // All digits of the pointer size, 8 on 32-bit targets, 16 on 64-bit hosts
+        //
+        _PrintUnsigned64(pBufferDesc, (unsigned long long)(size_t)va_arg(*pParamList, void*), 16u, sizeof(void*) * 2u, sizeof(void*) * 2u, 0u);
         break;
       case '%':
-        _StoreChar(&BufferDesc, '%');
+        _StoreChar(pBufferDesc, '%');
         break;
       default:
         break;
       }
       sFormat++;
-    } else {
-      _StoreChar(&BufferDesc, c);
     }
-  } while (BufferDesc.ReturnValue >= 0);
+  } while (pBufferDesc->ReturnValue >= 0);
+}
+
+/*********************************************************************
+*
+*       Public code
+*
+**********************************************************************
+*/
+/*********************************************************************
+*
+*       SEGGER_RTT_vprintf
+*
+*  Function description
+*    Stores a formatted string in SEGGER RTT control block.
+*    This data is read by the host.
+*
+*  Parameters
+*    BufferIndex  Index of "Up"-buffer to be used. (e.g. 0 for "Terminal")
+*    sFormat      Pointer to format string
+*    pParamList   Pointer to the list of arguments for the format string
+*
+*  Return values
+*    >= 0:  Number of bytes which have been stored in the "Up"-buffer.
+*     < 0:  Error
+*
+*  Notes
+*    (1) With SEGGER_RTT_PRINTF_DIRECT == 1 the message is formatted into space reserved
+*        in the "Up"-buffer under one lock, so it is never torn by other writers.
+*        The lock is held while formatting, and the channel must not be written by
+*        SEGGER_RTT_WriteLockFree() as well.
+*    (2) A message longer than the first reservation (SEGGER_RTT_PRINTF_DIRECT_MAX or the free space)
+*        is measured, reserved with its real length and formatted again. So the buffer flags apply
+*        to the whole message, and SEGGER_RTT_STATS counts it with its real length.
+*/
+int SEGGER_RTT_vprintf(unsigned BufferIndex, const char * sFormat, va_list * pParamList) {
+  SEGGER_RTT_PRINTF_DESC BufferDesc;
+#if SEGGER_RTT_PRINTF_DIRECT
+  SEGGER_RTT_RESERVATION Res;
+  va_list  ParamList;
+  va_list  ParamCount;
+  unsigned NumBytes;
+  unsigned Avail;
+  unsigned Mode;
+#else
+  char acBuffer[SEGGER_RTT_PRINTF_BUFFER_SIZE];
+#endif
+
+#if SEGGER_RTT_PRINTF_DIRECT
+  //
+  // Reserve space for the longest message at once and format into the "Up"-buffer.
+  // In non-blocking modes only the free space is reserved, what does not fit is handled at the end.
+  //
+  if (_SEGGER_RTT.acID[0] == '\0') {
+    SEGGER_RTT_Init();
+  }
+  va_copy(ParamList, *pParamList);      // For a 2nd pass, see (2)
+  SEGGER_RTT_LOCK();
+  Mode     = _SEGGER_RTT.aUp[BufferIndex].Flags & SEGGER_RTT_MODE_MASK;
+  NumBytes = SEGGER_RTT_PRINTF_DIRECT_MAX;
+#if SEGGER_RTT_STATS
+  SEGGER_RTT_ReserveNoLock(BufferIndex, 0u, &Res);   // Writes a pending "messages lost" marker in front of the message
+  if ((_SEGGER_RTT_Stats.aUp[BufferIndex].NumMsgLost != 0u) && ((_SEGGER_RTT.aUp[BufferIndex].Flags & SEGGER_RTT_FLAG_MARK_LOST) != 0u)) {
+    NumBytes = 0u;                      // Marker does not fit yet, the message is dropped and counted at the end
+  }
+#endif
+  if (Mode != SEGGER_RTT_MODE_BLOCK_IF_FIFO_FULL) {
+    Avail = SEGGER_RTT_GetAvailWriteSpace(BufferIndex);
+    if (NumBytes > Avail) {
+      NumBytes = Avail;
+    }
+  }
+  SEGGER_RTT_ReserveNoLock(BufferIndex, NumBytes, &Res);
+  BufferDesc.pBuffer        = Res.pData0;
+  BufferDesc.BufferSize     = Res.NumBytes0;
+  BufferDesc.pBuffer1       = Res.pData1;
+  BufferDesc.BufferSize1    = Res.NumBytes1;
+  BufferDesc.NumDone        = 0u;
+#else
+  BufferDesc.pBuffer        = acBuffer;
+  BufferDesc.BufferSize     = SEGGER_RTT_PRINTF_BUFFER_SIZE;
+#endif
+  BufferDesc.Cnt            = 0u;
+  BufferDesc.ReturnValue    = 0;
+  BufferDesc.pfFlush        = _FlushRTT;
+  BufferDesc.RTTBufferIndex = BufferIndex;
 
+  _VPrintf(&BufferDesc, sFormat, pParamList);
+
+#if SEGGER_RTT_PRINTF_DIRECT
+  //
+  // A message longer than the reserved space is reserved again with its real length:
+  // SKIP stores all of it or drops it, TRIM cuts it off at the free space, BLOCK waits.
+  // Then the message is made visible with one commit.
+  //
+  NumBytes = BufferDesc.NumDone + BufferDesc.Cnt;
+  if (BufferDesc.ReturnValue < 0) {
+    va_copy(ParamCount, ParamList);
+    NumBytes = (unsigned)SEGGER_RTT_vsnprintf(NULL, 0u, sFormat, &ParamCount);
+    va_end(ParamCount);
+    NumBytes = SEGGER_RTT_ReserveNoLock(BufferIndex, NumBytes, &Res);
+    BufferDesc.ReturnValue = -1;        // Dropped, if nothing is reserved
+    if (NumBytes != 0u) {
+      BufferDesc.pBuffer     = Res.pData0;
+      BufferDesc.BufferSize  = Res.NumBytes0;
+      BufferDesc.pBuffer1    = Res.pData1;
+      BufferDesc.BufferSize1 = Res.NumBytes1;
+      BufferDesc.NumDone     = 0u;
+      BufferDesc.Cnt         = 0u;
+      BufferDesc.ReturnValue = 0;
+      _VPrintf(&BufferDesc, sFormat, &ParamList);
+      NumBytes = BufferDesc.NumDone + BufferDesc.Cnt;
+    }
+  }
+  if ((BufferDesc.ReturnValue >= 0) || (Mode != SEGGER_RTT_MODE_NO_BLOCK_SKIP)) {
+    BufferDesc.ReturnValue = (int)NumBytes;
+  }
+  SEGGER_RTT_CommitNoLock(BufferIndex, NumBytes);
+  SEGGER_RTT_UNLOCK();
+  va_end(ParamList);
+#else
   if (BufferDesc.ReturnValue > 0) {
     //
     // Write remaining data, if any
@@ -507,6 +1578,86 @@ int SEGGER_RTT_vprintf(unsigned BufferIndex, const char * sFormat, va_list * pPa
     }
     BufferDesc.ReturnValue += (int)BufferDesc.Cnt;
   }
+#endif
+  return BufferDesc.ReturnValue;
+}
+
+/*********************************************************************
+*
+*       SEGGER_RTT_vsnprintf
+*
+*  Function description
+*    Stores a formatted string in memory, like vsnprintf().
+*
+*  Parameters
+*    pBuffer      Pointer to the destination buffer
+*    BufferSize   Size of the destination buffer, including the terminating '\0'
+*    sFormat      Pointer to format string
+*    pParamList   Pointer to the list of arguments for the format string
+*
+*  Return values
+*    >= 0:  Length of the formatted string, may be >= BufferSize when it has been cut off.
+*
+*  Notes
+*    (1) The string is always terminated when BufferSize > 0.
+*    (2) Same conversions as SEGGER_RTT_printf(). Neither RTT nor the heap is used.
+*/
+int SEGGER_RTT_vsnprintf(char * pBuffer, unsigned BufferSize, const char * sFormat, va_list * pParamList) {
+  SEGGER_RTT_PRINTF_DESC BufferDesc;
+  char c0;
+
+  if (BufferSize == 0u) {
+    pBuffer    = &c0;                   // Only count
+    BufferSize = 1u;
+  }
+  BufferDesc.pBuffer        = pBuffer;
+  BufferDesc.BufferSize     = BufferSize - 1u;
+  BufferDesc.Cnt            = 0u;
+  BufferDesc.ReturnValue    = 0;
+  BufferDesc.pfFlush        = _FlushMem;
+  if (BufferDesc.BufferSize == 0u) {
+    _FlushMem(&BufferDesc);
+  }
+  _VPrintf(&BufferDesc, sFormat, pParamList);
+  *(BufferDesc.pBuffer + BufferDesc.Cnt) = '\0';
+  return BufferDesc.ReturnValue;
+}
+
+/*********************************************************************
+*
+*       SEGGER_RTT_vprintfCallback
+*
+*  Function description
+*    Formats a string and passes it in blocks to a callback, e.g. for UART,
+*    a log in flash or a network packet.
+*
+*  Parameters
+*    pfOutput     Callback, called with up to SEGGER_RTT_PRINTF_BUFFER_SIZE bytes at once
+*    pContext     Passed to the callback
+*    sFormat      Pointer to format string
+*    pParamList   Pointer to the list of arguments for the format string
+*
+*  Return values
+*    >= 0:  Number of bytes which have been passed to the callback.
+*     < 0:  Error, the callback returned < 0
+*/
+int SEGGER_RTT_vprintfCallback(SEGGER_RTT_PRINTF_OUTPUT* pfOutput, void* pContext, const char * sFormat, va_list * pParamList) {
+  SEGGER_RTT_PRINTF_DESC BufferDesc;
+  char acBuffer[SEGGER_RTT_PRINTF_BUFFER_SIZE];
+
+  BufferDesc.pBuffer        = acBuffer;
+  BufferDesc.BufferSize     = SEGGER_RTT_PRINTF_BUFFER_SIZE;
+  BufferDesc.Cnt            = 0u;
+  BufferDesc.ReturnValue    = 0;
+  BufferDesc.pfFlush        = _FlushCallback;
+  BufferDesc.pfOutput       = pfOutput;
+  BufferDesc.pContext       = pContext;
+  _VPrintf(&BufferDesc, sFormat, pParamList);
+  if ((BufferDesc.ReturnValue >= 0) && (BufferDesc.Cnt != 0u)) {
+    if (pfOutput(pContext, acBuffer, BufferDesc.Cnt) < 0) {
+      BufferDesc.ReturnValue = -1;
+    }
+  }
   return BufferDesc.ReturnValue;
 }
 
@@ -528,18 +1679,26 @@ int SEGGER_RTT_vprintf(unsigned BufferIndex, const char * sFormat, va_list * pPa
 *
 *  Notes
 *    (1) Conversion specifications have following syntax:
-*          %[flags][FieldWidth][.Precision]ConversionSpecifier
+*          %[flags][FieldWidth][.Precision][LengthModifier]ConversionSpecifier
 *    (2) Supported flags:
 *          -: Left justify within the field width
 *          +: Always print sign extension for signed conversions
-*          0: Pad with 0 instead of spaces. Ignored when using '-'-flag or precision
+*          0: Pad with 0 instead of spaces. Ignored when using '-'-flag or precision (integers only)
+*          #: Always print the decimal point for f, e, g, keep trailing zeros for g
+*        Supported length modifiers:
+*          hh, h, l, ll, j, z, t: Argument is char, short, long, long long, intmax_t, size_t, ptrdiff_t
+*          64-bit arguments are converted without 64-bit division
 *        Supported conversion specifiers:
 *          c: Print the argument as one char
-*          d: Print the argument as a signed integer
+*          d: Print the argument as a signed integer (also i)
 *          u: Print the argument as an unsigned integer
 *          x: Print the argument as an hexadecimal integer
+*          f: Print the argument (double) as [-]ddd.ddd, precision 6 by default (F: INF, NAN)
+*          e: Print the argument (double) as [-]d.ddde+dd (E: upper case)
+*          g: Print the argument (double) as f or e, whichever is shorter, without trailing zeros (G: upper case)
+*             Float conversions are exact and rounded like the C library, precision is limited to SEGGER_RTT_PRINTF_FLOAT_MAX_PREC
 *          s: Print the string pointed to by the argument
-*          p: Print the argument as an 8-digit hexadecimal integer. (Argument shall be a pointer to void.)
+*          p: Print the argument as an 8-digit (16-digit on 64-bit hosts) hexadecimal integer. (Argument shall be a pointer to void.)
 */
 int SEGGER_RTT_printf(unsigned BufferIndex, const char * sFormat, ...) {
   int r;
@@ -550,4 +1709,40 @@ int SEGGER_RTT_printf(unsigned BufferIndex, const char * sFormat, ...) {
   va_end(ParamList);
   return r;
 }
+
+/*********************************************************************
+*
+*       SEGGER_RTT_snprintf
+*
+*  Function description
+*    Stores a formatted string in memory, like snprintf().
+*    See SEGGER_RTT_vsnprintf() and SEGGER_RTT_printf().
+*/
+int SEGGER_RTT_snprintf(char * pBuffer, unsigned BufferSize, const char * sFormat, ...) {
+  int r;
+  va_list ParamList;
+
+  va_start(ParamList, sFormat);
+  r = SEGGER_RTT_vsnprintf(pBuffer, BufferSize, sFormat, &ParamList);
+  va_end(ParamList);
+  return r;
+}
+
+/*********************************************************************
+*
+*       SEGGER_RTT_printfCallback
+*
+*  Function description
+*    Formats a string and passes it in blocks to a callback.
+*    See SEGGER_RTT_vprintfCallback() and SEGGER_RTT_printf().
+*/
+int SEGGER_RTT_printfCallback(SEGGER_RTT_PRINTF_OUTPUT* pfOutput, void* pContext, const char * sFormat, ...) {
+  int r;
+  va_list ParamList;
+
+  va_start(ParamList, sFormat);
+  r = SEGGER_RTT_vprintfCallback(pfOutput, pContext, sFormat, &ParamList);
+  va_end(ParamList);
+  return r;
+}
 /*************************** End of file ****************************/
@@ -5,46 +5,672 @@
  *			20240809 update: 
  *						1. add stdout_putchar() for RTT;
  *						2. add log_test();
+ *			20261017 update: add deferred binary LOG;
+ *			20261017 update: send stdout to RTT line by line;
+ *			20261017 update: UART LOG is sent by DMA in background;
+ *			20261017 update: add dbger_log() for LOG_AST/ERR/WAR;
+ *			20261017 update: runtime LOG level for each module, RTT cmd "log";
+ *			20261017 update: lock-free RTT write for deferred LOG and LOG_RTT_LOCKFREE;
+ *			20261017 update: RTT channel for each context;
+ *			20261017 update: dbger_log_str(), dbger_print() and dbger_record() for dbger.hpp;
+ *			20261017 update: LOG_SMALL_PRINTF: dbger_log() and dbger_printf() use the formatter of SEGGER_RTT_printf.c;
+ *			20261017 update: RTT buffers follow SEGGER_RTT_SECTION, for RTT in shared memory (host/rtt_shm.c);
+ *			20261017 update: lost LOG is marked in the text channel 0 with SEGGER_RTT_STATS;
+ *			20261017 update: LOG_TIME: each LOG line and record carries its time as varint delta;
+ *			20261017 update: LOG_POSTMORTEM: LOG text is copied into an RTT up-buffer which survives a reset;
+ *			20261017 update: RTT cmd "log <name> <level>" is parsed without sscanf(), the level is checked against LOG_LEVEL;
  */
 #include "dbger.h"
+#include <stdarg.h>
+#include <string.h>
+
+DBGER_MODULE("dbger");
 
 #if LOG_ENABLE
 
+#ifndef SEGGER_RTT_LOCK
+	#define SEGGER_RTT_LOCK()
+	#define SEGGER_RTT_UNLOCK()
+#endif
+
+// RTT buffers of dbger go with _SEGGER_RTT, eg into shared memory for host/rtt_probe.c
+#if defined(SEGGER_RTT_BUFFER_SECTION)
+	#define DBGER_RTT_BUF	__attribute__((section(SEGGER_RTT_BUFFER_SECTION)))
+#elif defined(SEGGER_RTT_SECTION)
+	#define DBGER_RTT_BUF	__attribute__((section(SEGGER_RTT_SECTION)))
+#else
+	#define DBGER_RTT_BUF
+#endif
+
+// the text LOG channel 0 gets a line "--- N messages lost ---" where LOG has been dropped, the binary channels (deferred, context) do not
+#if SEGGER_RTT_STATS
+	#define DBGER_RTT_MARK	SEGGER_RTT_FLAG_MARK_LOST
+#else
+	#define DBGER_RTT_MARK	0
+#endif
+
+#ifndef LOG_TIME
+	#define LOG_TIME		0
+#endif
+#if LOG_TIME
+#if !LOG_LINE_BUF_LEN
+	#error	LOG_TIME needs LOG_LINE_BUF_LEN, printf() is stamped line by line.
+#endif
+#define DBGER_TIME_LEN		12		// room in front of a line for its stamp: 0xFF 'T' + varint of 64 bits
+#if defined(DBGER_TIME_DWT)
+extern uint32_t SystemCoreClock;	// CMSIS, LOG_TIME_HZ()
+#endif
+#else
+#define DBGER_TIME_LEN		0
+#endif
+
+#ifndef LOG_POSTMORTEM
+	#define LOG_POSTMORTEM	0
+#endif
+#if LOG_POSTMORTEM
+#if !SEGGER_RTT_POSTMORTEM
+	#error	LOG_POSTMORTEM needs SEGGER_RTT_POSTMORTEM = 1 in SEGGER_RTT_Conf.h.
+#endif
+#if LOG_DEFERRED && (LOG_POSTMORTEM_CHANNEL == LOG_DEFERRED_CHANNEL)
+	#error	LOG_POSTMORTEM_CHANNEL is LOG_DEFERRED_CHANNEL, raise SEGGER_RTT_MAX_NUM_UP_BUFFERS in SEGGER_RTT_Conf.h.
+#endif
+// the text written to RTT is copied into the post-mortem buffer, _NOLOCK: the caller holds SEGGER_RTT_LOCK()
+#define DBGER_PM_WRITE(buf, len)			SEGGER_RTT_WritePostMortem(buf, len)
+#define DBGER_PM_WRITE_NOLOCK(buf, len)		SEGGER_RTT_WritePostMortemNoLock(buf, len)
+#else
+#define DBGER_PM_WRITE(buf, len)
+#define DBGER_PM_WRITE_NOLOCK(buf, len)
+#endif
+
 #if LOG_BY_UART
 
 #include "usart.h"
-#if LOG_PLATFORM == 0		// MDK_ARM
-int stdout_putchar (int ch)
+#if LOG_UART_ASYNC
+static volatile unsigned dbger_uart_tx_len;		// bytes sending by DMA, 0: DMA is idle
+
+// start DMA for the contiguous data from RdOff, the data stays in the ring until it has been sent
+static void dbger_uart_kick(void)
 {
-	uint8_t cha = ch;
-	HAL_UART_Transmit(&huart1, &cha, 1, 10);
-	return ch;
+	SEGGER_RTT_BUFFER_UP *ring = &_SEGGER_RTT.aUp[0];
+	unsigned rd, wr, len;
+
+	SEGGER_RTT_LOCK();
+	if(dbger_uart_tx_len == 0) {
+		rd = ring->RdOff;
+		wr = ring->WrOff;
+		len = (wr >= rd) ? (wr - rd) : (ring->SizeOfBuffer - rd);
+		if(len) {
+			dbger_uart_tx_len = len;
+			if(HAL_UART_Transmit_DMA(&huart1, (uint8_t *)ring->pBuffer + rd, len) != HAL_OK) {
+				dbger_uart_tx_len = 0;		// UART busy (eg by other code) or error: the data stays in the ring, the next write tries again
+			}
+		}
+	}
+	SEGGER_RTT_UNLOCK();
 }
-#elif LOG_PLATFORM == 1		// Linux
-int __io_putchar(int ch, FILE *f) {
-	(void)f;
-	uint8_t cha = ch;
-	HAL_UART_Transmit(&huart1, &cha, 1, 10);
-	return ch;
+
+void dbger_uart_tx_cplt(void)
+{
+	SEGGER_RTT_BUFFER_UP *ring = &_SEGGER_RTT.aUp[0];
+	unsigned rd = ring->RdOff + dbger_uart_tx_len;
+
+	if(rd >= ring->SizeOfBuffer) {
+		rd -= ring->SizeOfBuffer;
+	}
+	ring->RdOff = rd;
+	dbger_uart_tx_len = 0;
+	dbger_uart_kick();			// continue with the data written during this transfer
+}
+
+#if LOG_UART_OWN_CALLBACK
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+	if(huart == &huart1) {
+		dbger_uart_tx_cplt();
+	}
 }
 #endif
 
-#elif LOG_BY_RTT
+static void dbger_write(const char *buf, unsigned len)
+{
+#if LOG_UART_MODE == SEGGER_RTT_MODE_BLOCK_IF_FIFO_FULL
+	unsigned n;
+
+	// the ring is in trim mode, wait here (out of the lock) until DMA has made space
+	while(len) {
+		n = SEGGER_RTT_Write(0, buf, len);
+		buf += n;
+		len -= n;
+		dbger_uart_kick();
+	}
+#else
+	SEGGER_RTT_Write(0, buf, len);
+	dbger_uart_kick();
+#endif
+}
+#else
+static void dbger_write(const char *buf, unsigned len)
+{
+	HAL_UART_Transmit(&huart1, (uint8_t *)buf, len, 10 * len);
+}
+#endif  // LOG_UART_ASYNC
+
+#endif
+
+#ifndef LOG_CTX_ID
+#if LOG_PLATFORM == 1		// Linux
+// each thread gets a context in turn
+static unsigned dbger_ctx_next;
+static __thread unsigned dbger_ctx = ~0u;
+static inline unsigned dbger_ctx_id(void)
+{
+	if(dbger_ctx == ~0u) {
+		dbger_ctx = __atomic_fetch_add(&dbger_ctx_next, 1u, __ATOMIC_RELAXED) % LOG_CTX_NUM;
+	}
+	return dbger_ctx;
+}
+#define LOG_CTX_ID()	dbger_ctx_id()
+#else
+#define LOG_CTX_ID()	dbger_ctx_irq()
+#endif
+#endif  // LOG_CTX_ID
+
+#if LOG_PLATFORM != 1
+/**
+ * @brief	context of the active exception: 0 in thread mode, 1 for NMI and HardFault, then one for each preemption priority level.
+ *			A handler is only preempted by a higher level, so a line is never written by two contexts with the same number at once.
+ * @note	if the IRQs which LOG differ below the top LOG_CTX_PRIO_BITS bits of the priority, they share a context and their lines can interleave
+ */
+unsigned dbger_ctx_irq(void)
+{
+#if defined(__CC_ARM)
+	register unsigned ipsr __asm("ipsr");
+#else
+	unsigned ipsr;
+	__asm volatile ("mrs %0, ipsr" : "=r" (ipsr));
+#endif
+	unsigned addr, prio;
+
+	if(ipsr == 0) {
+		return 0;
+	}
+	if(ipsr < 4) {		// NMI, HardFault: fixed priority
+		return 1;
+	}
+	addr = (ipsr < 16) ? (0xE000ED14u + ipsr) : (0xE000E400u + ipsr - 16);	// SCB->SHPR from exception 4, NVIC->IPR from IRQ 0
+	prio = (*(volatile uint32_t *)(addr & ~3u) >> ((addr & 3u) * 8)) & 0xFFu;	// word access, ARMv6-M has no byte access there
+	return 2 + (prio >> (8 - LOG_CTX_PRIO_BITS));
+}
+#endif
+
+#if LOG_BY_RTT
+
+#if LOG_CTX_CHANNEL || LOG_DEFERRED
+static uint8_t *dbger_put32(uint8_t *p, uint32_t v)
+{
+	p[0] = (uint8_t)v;
+	p[1] = (uint8_t)(v >> 8);
+	p[2] = (uint8_t)(v >> 16);
+	p[3] = (uint8_t)(v >> 24);
+	return p + 4;
+}
+#endif
+
+#if LOG_TIME
+typedef struct {
+	dbger_time_t last;			// time of the last record of the channel
+	unsigned delta;				// 0: the next record carries the absolute time, at first and after a lost record
+} dbger_time_state_t;
+
+// varint: 7 bits per byte, low bits first, bit 7 is set if more bytes follow
+static unsigned dbger_put_var(uint8_t *p, uint64_t v)
+{
+	unsigned n = 0;
+
+	while(v >= 0x80u) {
+		p[n++] = (uint8_t)(v | 0x80u);
+		v >>= 7;
+	}
+	p[n++] = (uint8_t)v;
+	return n;
+}
+
+/**
+ * @brief	time of the next record of a channel: (ticks since the last record << 1), or (absolute ticks << 1 | 1),
+ *			so a lost record never shifts the times after it. The caller holds SEGGER_RTT_LOCK() or is the only writer.
+ */
+static __attribute__((unused)) uint64_t dbger_time_next(dbger_time_state_t *st)
+{
+	dbger_time_t now = LOG_TIMESTAMP();
+	dbger_time_t prev = st->last;
+	unsigned delta = st->delta;
+
+	st->last = now;
+	st->delta = 1;
+	return delta ? ((uint64_t)(dbger_time_t)(now - prev) << 1) : (((uint64_t)now << 1) | 1u);
+}
+
+// same for a channel written by SEGGER_RTT_WriteLockFree(): a record preempted between its time and its write may be off by the preemption
+static __attribute__((unused)) uint64_t dbger_time_shared(dbger_time_state_t *st)
+{
+#if SEGGER_RTT_LOCKFREE
+	dbger_time_t now = LOG_TIMESTAMP();
+	dbger_time_t prev = __atomic_exchange_n(&st->last, now, __ATOMIC_RELAXED);
+
+	if(__atomic_exchange_n(&st->delta, 1u, __ATOMIC_RELAXED) == 0) {
+		return ((uint64_t)now << 1) | 1u;
+	}
+	return (uint64_t)(dbger_time_t)(now - prev) << 1;
+#else
+	uint64_t t;
+
+	SEGGER_RTT_LOCK();
+	t = dbger_time_next(st);
+	SEGGER_RTT_UNLOCK();
+	return t;
+#endif
+}
+
+// put <head> of <len> bytes and the time <t> right in front of <body>, return the start of the record
+static uint8_t *dbger_time_head(uint8_t *body, const uint8_t *head, unsigned len, uint64_t t)
+{
+	uint8_t tmp[16];
+	unsigned n;
+
+	memcpy(tmp, head, len);
+	n = len + dbger_put_var(tmp + len, t);
+	memcpy(body - n, tmp, n);
+	return body - n;
+}
+#endif
+
+#if LOG_CTX_CHANNEL
+#if SEGGER_RTT_MAX_NUM_UP_BUFFERS < (1 + LOG_CTX_NUM + LOG_DEFERRED + LOG_POSTMORTEM)
+	#error	raise SEGGER_RTT_MAX_NUM_UP_BUFFERS in SEGGER_RTT_Conf.h for LOG_CTX_CHANNEL.
+#endif
+#if LOG_TIME
+#define DBGER_CTX_SYNC		0xDE
+#define DBGER_CTX_HEAD_LEN	16		// sync + len + seq + time (varint, 1..10 bytes)
+#else
+#define DBGER_CTX_SYNC		0xDC
+#define DBGER_CTX_HEAD_LEN	10		// sync + len + seq + timestamp
+#endif
+#define DBGER_CTX_TEXT_LEN	128		// longer text is split into records
+
+static char dbger_ctx_buf[LOG_CTX_NUM][LOG_CTX_BUF_LEN] DBGER_RTT_BUF;
+static unsigned char dbger_ctx_chan[LOG_CTX_NUM];		// RTT up-buffer of each context
+static unsigned dbger_seq;
+#if LOG_TIME
+static dbger_time_state_t dbger_ctx_time[LOG_CTX_NUM];
+#endif
+
+// contexts never share a ring, the only shared thing is the sequence number
+static void dbger_write(const char *buf, unsigned len)
+{
+	uint8_t rec[DBGER_CTX_HEAD_LEN + DBGER_CTX_TEXT_LEN];
+	unsigned ctx = LOG_CTX_ID();
+	unsigned chan = dbger_ctx_chan[ctx];
+	unsigned n, seq;
+
+	DBGER_PM_WRITE(buf, len);			// the text only, the records of the contexts have their own time and seq
+	while(len) {
+		n = (len < DBGER_CTX_TEXT_LEN) ? len : DBGER_CTX_TEXT_LEN;
+#if SEGGER_RTT_LOCKFREE
+		seq = __atomic_fetch_add(&dbger_seq, 1u, __ATOMIC_RELAXED);
+#else
+		SEGGER_RTT_LOCK();
+		seq = dbger_seq++;
+		SEGGER_RTT_UNLOCK();
+#endif
+		rec[0] = DBGER_CTX_SYNC;
+		rec[1] = (uint8_t)n;
+		dbger_put32(rec + 2, seq);
+		memcpy(rec + DBGER_CTX_HEAD_LEN, buf, n);
+#if LOG_TIME
+		{
+			uint8_t *start = dbger_time_head(rec + DBGER_CTX_HEAD_LEN, rec, 6, dbger_time_shared(&dbger_ctx_time[ctx]));
+
+			if(SEGGER_RTT_WriteLockFree(chan, start, (unsigned)(rec + DBGER_CTX_HEAD_LEN + n - start)) == 0) {
+				dbger_ctx_time[ctx].delta = 0;
+			}
+		}
+#else
+		dbger_put32(rec + 6, LOG_TIMESTAMP());
+		SEGGER_RTT_WriteLockFree(chan, rec, DBGER_CTX_HEAD_LEN + n);		// a dropped record leaves a gap in seq
+#endif
+		buf += n;
+		len -= n;
+	}
+}
+#elif LOG_TIME
+static dbger_time_state_t dbger_time0;
+
+// every caller leaves DBGER_TIME_LEN bytes of room in front of buf for the stamp, stamp and line are one write,
+// so the stamps are in the order of the lines and a dropped line never leaves a stamp without its line
+static void dbger_write(const char *buf, unsigned len)
+{
+	static const uint8_t head[2] = { 0xFF, 'T' };
+	uint8_t *start;
+
+#if LOG_RTT_LOCKFREE
+	start = dbger_time_head((uint8_t *)buf, head, 2, dbger_time_shared(&dbger_time0));
+	if(SEGGER_RTT_WriteLockFree(0, start, (unsigned)((const uint8_t *)buf + len - start)) == 0) {
+		dbger_time0.delta = 0;
+	}
+	DBGER_PM_WRITE(start, (unsigned)((const uint8_t *)buf + len - start));
+#else
+	SEGGER_RTT_LOCK();
+	start = dbger_time_head((uint8_t *)buf, head, 2, dbger_time_next(&dbger_time0));
+	if(SEGGER_RTT_WriteNoLock(0, start, (unsigned)((const uint8_t *)buf + len - start)) == 0) {
+		dbger_time0.delta = 0;
+	}
+	DBGER_PM_WRITE_NOLOCK(start, (unsigned)((const uint8_t *)buf + len - start));
+	SEGGER_RTT_UNLOCK();
+#endif
+}
+#else
+static void dbger_write(const char *buf, unsigned len)
+{
+#if LOG_RTT_LOCKFREE
+	SEGGER_RTT_WriteLockFree(0, buf, len);
+#else
+	SEGGER_RTT_Write(0, buf, len);
+#endif
+	DBGER_PM_WRITE(buf, len);
+}
+#endif  // LOG_CTX_CHANNEL
+
+#endif  // LOG_BY_RTT
+
+#if LOG_LINE_BUF_LEN
+typedef struct {
+	unsigned len;
+#if LOG_TIME
+	char time[DBGER_TIME_LEN];		// room for the stamp of the line
+#endif
+	char buf[LOG_LINE_BUF_LEN];
+} dbger_line_t;
+
+#if LOG_PLATFORM == 1		// Linux
+static __thread dbger_line_t dbger_line;
+#define DBGER_LINE()	(&dbger_line)
+#else
+static dbger_line_t dbger_line[LOG_CTX_NUM];
+#define DBGER_LINE()	(&dbger_line[LOG_CTX_ID()])
+#endif
+
+// each context only touches its own buffer, so no lock is needed until the line is written
+static void dbger_putchar(char ch)
+{
+	dbger_line_t *line = DBGER_LINE();
+
+	line->buf[line->len++] = ch;
+	if(ch == '\n' || line->len == sizeof(line->buf)) {
+		dbger_write(line->buf, line->len);
+		line->len = 0;
+	}
+}
+
+void dbger_flush(void)
+{
+	dbger_line_t *line = DBGER_LINE();
+
+	if(line->len) {
+		dbger_write(line->buf, line->len);
+		line->len = 0;
+	}
+}
+#else
+static void dbger_putchar(char ch)
+{
+	dbger_write(&ch, 1);
+}
+
+void dbger_flush(void) {}
+#endif  // LOG_LINE_BUF_LEN
 
 #if LOG_PLATFORM == 0		// MDK_ARM
 int stdout_putchar (int ch)
 {
-	SEGGER_RTT_PutChar(0, ch);
+	dbger_putchar(ch);
 	return ch;
 }
 #elif LOG_PLATFORM == 1		// Linux
 int __io_putchar(int ch, FILE *f) {
 	(void)f;
-	SEGGER_RTT_PutChar(0, ch);
+	dbger_putchar(ch);
 	return ch;
 }
 #endif  // LOG_PLATFORM
 
+#if LOG_LEVEL_RUNTIME
+static dbger_module_t *dbger_modules;			// registered modules
+static unsigned char dbger_level_default = LOG_LEVEL_DEFAULT;
+
+// called by the first LOG of a module
+unsigned char dbger_register(dbger_module_t *module)
+{
+	const char *p;
+
+	SEGGER_RTT_LOCK();
+	if(module->level == LOG_MODULE_UNREG) {
+		for(p = module->name; *p; p++) {		// name without path
+			if(*p == '/' || *p == '\\') {
+				module->name = p + 1;
+			}
+		}
+		module->next = dbger_modules;
+		dbger_modules = module;
+		module->level = dbger_level_default;
+	}
+	SEGGER_RTT_UNLOCK();
+	return module->level;
+}
+
+int dbger_set_level(const char *name, unsigned level)
+{
+	dbger_module_t *m;
+	int all = (strcmp(name, "*") == 0);
+	int cnt = 0;
+
+	if(level > LOG_LEVEL) {		// LOG over LOG_LEVEL are not compiled in, and a level must not wrap into LOG_MODULE_UNREG
+		return 0;
+	}
+	SEGGER_RTT_LOCK();
+	if(all) {
+		dbger_level_default = level;
+	}
+	for(m = dbger_modules; m; m = m->next) {
+		if(all || strcmp(m->name, name) == 0) {
+			m->level = level;
+			cnt++;
+		}
+	}
+	SEGGER_RTT_UNLOCK();
+	return cnt;
+}
+#endif  // LOG_LEVEL_RUNTIME
+
+#if LOG_BY_RTT
+static unsigned char dbger_terminal = 1;		// terminal of printf(), LOG_AST/ERR/WAR switch back to it
+
+// the pending line must go to the terminal it was printed for
+int dbger_set_terminal(unsigned char terminal_id)
+{
+	int r;
+#if LOG_RTT_LOCKFREE || LOG_CTX_CHANNEL
+	char buf[DBGER_TIME_LEN + 2];			// dbger_write() puts the stamp of LOG_TIME in front of seq
+	char *seq = buf + DBGER_TIME_LEN;
+
+	seq[0] = (char)0xFF;					// SEGGER_RTT_SetTerminal() would write with lock to channel 0
+	seq[1] = "0123456789ABCDEF"[terminal_id & 0x0F];
+#endif
+
+	dbger_flush();
+#if LOG_RTT_LOCKFREE || LOG_CTX_CHANNEL
+	r = (terminal_id < 16) ? 0 : -1;
+	if(r >= 0) {
+		dbger_write(seq, 2);
+	}
+#else
+	r = SEGGER_RTT_SetTerminal(terminal_id);
+#endif
+	if(r >= 0) {
+		dbger_terminal = terminal_id;
+	}
+	return r;
+}
+
+#if LOG_DEFERRED
+#if LOG_TIME
+#define DBGER_SYNC		0xDA
+#define DBGER_HEAD_LEN	16		// sync + arg len + fmt id + time (varint, 1..10 bytes)
+#else
+#define DBGER_SYNC		0xDB
+#define DBGER_HEAD_LEN	10		// sync + arg len + fmt id + timestamp
+#endif
+
+static char dbger_deferred_buf[LOG_DEFERRED_BUF_LEN] DBGER_RTT_BUF;
+#if LOG_TIME
+static dbger_time_state_t dbger_deferred_time;
+#endif
+
+#if LOG_PLATFORM == 1		// Linux: the address is randomized, so use the offset in section
+extern const char __start_dbger_fmt[];
+#define DBGER_FMT_ID(fmt)	((uint32_t)((fmt) - __start_dbger_fmt))
+#else
+#define DBGER_FMT_ID(fmt)	((uint32_t)(fmt))
+#endif
+
+static void dbger_record_write(uint8_t *rec, unsigned arg_len, const char *fmt)
+{
+	rec[0] = DBGER_SYNC;
+	rec[1] = (uint8_t)arg_len;
+	dbger_put32(rec + 2, DBGER_FMT_ID(fmt));
+#if LOG_TIME
+	{
+		uint8_t *start = dbger_time_head(rec + DBGER_HEAD_LEN, rec, 6, dbger_time_shared(&dbger_deferred_time));
+
+		if(SEGGER_RTT_WriteLockFree(LOG_DEFERRED_CHANNEL, start, (unsigned)(rec + DBGER_HEAD_LEN + arg_len - start)) == 0) {
+			dbger_deferred_time.delta = 0;
+		}
+	}
+#else
+	dbger_put32(rec + 6, LOG_TIMESTAMP());
+	SEGGER_RTT_WriteLockFree(LOG_DEFERRED_CHANNEL, rec, DBGER_HEAD_LEN + arg_len);		// one write, so records never interleave, and ISR is never masked
+#endif
+}
+
+/**
+ * @brief	copy the args into a record, the format string is only scanned for the size of each arg.
+ *			the same rules are used by host/dbger_decode to get the args back.
+ */
+void dbger_deferred(const char *fmt, ...)
+{
+	uint8_t rec[DBGER_HEAD_LEN + LOG_DEFERRED_ARG_LEN];
+	uint8_t *p = rec + DBGER_HEAD_LEN;
+	uint8_t *end = rec + sizeof(rec);
+	const char *s;
+	unsigned len;
+	int prec, ld;
+	va_list ap;
+
+	va_start(ap, fmt);
+	for(s = fmt; *s; s++) {
+		if(*s != '%') {
+			continue;
+		}
+		s++;
+		while(*s == '-' || *s == '+' || *s == ' ' || *s == '#' || *s == '0') s++;		// flags
+		prec = -1;
+		while((*s >= '0' && *s <= '9') || *s == '.' || *s == '*') {						// width and precision
+			if(*s == '*') {
+				int v = va_arg(ap, int);		// taken even if it doesn't fit, the next conversion must not get it
+				if(prec >= 0) {
+					prec = (v < 0) ? -1 : v;	// a negative precision is taken as omitted
+				}
+				if(p + 4 > end) goto out;
+				p = dbger_put32(p, (uint32_t)v);
+			} else if(*s == '.') {
+				prec = 0;
+			} else if(prec >= 0 && prec <= LOG_DEFERRED_ARG_LEN) {		// a longer one copies the same
+				prec = prec * 10 + (*s - '0');
+			}
+			s++;
+		}
+		len = 0;
+		ld = 0;
+		while(*s == 'l' || *s == 'h' || *s == 'z' || *s == 'j' || *s == 't' || *s == 'L') {
+			if(*s == 'L') ld = 1;
+			if(*s == 'l') len++;
+			if(*s == 'j' || ((*s == 'z' || *s == 't') && sizeof(size_t) == 8)) len = 2;
+			s++;
+		}
+		if(*s == '\0') {
+			break;
+		}
+		switch(*s) {
+		case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+			if(len >= 2 || (len == 1 && sizeof(long) == 8)) {
+				uint64_t v = va_arg(ap, unsigned long long);
+				if(p + 8 > end) goto out;
+				p = dbger_put32(p, (uint32_t)v);
+				p = dbger_put32(p, (uint32_t)(v >> 32));
+			} else {
+				uint32_t v = va_arg(ap, unsigned);
+				if(p + 4 > end) goto out;
+				p = dbger_put32(p, v);
+			}
+			break;
+		case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A': {
+			double v = ld ? (double)va_arg(ap, long double) : va_arg(ap, double);		// the record always has a double
+			if(p + 8 > end) goto out;
+			memcpy(p, &v, 8);
+			p += 8;
+			break;
+		}
+		case 'p': {
+			uintptr_t v = (uintptr_t)va_arg(ap, void *);
+			if(p + sizeof(v) > end) goto out;
+			memcpy(p, &v, sizeof(v));
+			p += sizeof(v);
+			break;
+		}
+		case 's': {
+			const char *str = va_arg(ap, const char *);
+			if(str == NULL) {
+				str = "(null)";				// same as dbger.hpp
+			}
+			if(p >= end) goto out;
+			while(prec != 0 && *str && p < end - 1) {		// an array with a precision may have no '\0'
+				*p++ = *str++;
+				if(prec > 0) prec--;
+			}
+			*p++ = '\0';
+			break;
+		}
+		default:		// "%%" or unsupported
+			break;
+		}
+	}
+out:
+	va_end(ap);
+	dbger_record_write(rec, (unsigned)(p - rec - DBGER_HEAD_LEN), fmt);
+}
+
+// args are packed by the caller, eg dbger.hpp
+void dbger_record(const char *fmt, const void *arg, unsigned arg_len)
+{
+	uint8_t rec[DBGER_HEAD_LEN + LOG_DEFERRED_ARG_LEN];
+
+	if(arg_len > LOG_DEFERRED_ARG_LEN) {
+		arg_len = LOG_DEFERRED_ARG_LEN;
+	}
+	memcpy(rec + DBGER_HEAD_LEN, arg, arg_len);
+	dbger_record_write(rec, arg_len, fmt);
+}
+#endif  // LOG_DEFERRED
+
 #if RTT_CMD_ENABLE
 char RTT_cmd_buf[RTT_CMD_BUF_LEN];
 size_t get_RTT_cmd(void)
@@ -68,9 +694,203 @@ size_t get_RTT_cmd(void)
     }
     return cmd_len;
 }
+
+/**
+ * @brief	"log": list the level of all modules; "log <name|*> <level>": set the level, level 0 to turn off
+ */
+int dbger_cmd(const char *cmd)
+{
+#if LOG_LEVEL_RUNTIME
+	char name[RTT_CMD_BUF_LEN];				// a longer name is rejected, RTT cmds always fit
+	const char *p, *s;
+	unsigned level = 0, digits = 0;
+	dbger_module_t *m;
+#endif
+
+	if(strncmp(cmd, "log", 3) != 0 || (cmd[3] != '\0' && cmd[3] != ' ')) {
+		return 0;
+	}
+#if LOG_LEVEL_RUNTIME
+	for(p = cmd + 3; *p == ' '; p++);
+	for(s = p; *p != '\0' && *p != ' '; p++);
+	if(p == s) {
+		printf("log * %u\n", dbger_level_default);
+		for(m = dbger_modules; m; m = m->next) {
+			printf("log %s %u\n", m->name, m->level);
+		}
+		return 1;
+	}
+	if((size_t)(p - s) >= sizeof(name)) {		// dbger_cmd() may be called with any text, not only RTT_cmd_buf
+		printf("log: name too long\n");
+		return 1;
+	}
+	memcpy(name, s, p - s);
+	name[p - s] = '\0';
+	for(; *p == ' '; p++);
+	for(; *p >= '0' && *p <= '9'; p++, digits++) {
+		if(level <= LOG_LEVEL) {			// stop before it can wrap, it is out of range anyway
+			level = level * 10 + (*p - '0');
+		}
+	}
+	for(; *p == ' '; p++);
+	if(digits == 0 || *p != '\0' || level > LOG_LEVEL) {
+		printf("log %s: level must be 0..%d\n", name, LOG_LEVEL);
+	} else {
+		printf("log %s %u: %d module(s)\n", name, level, dbger_set_level(name, level));
+	}
+#else
+	printf("log level is fixed: %d\n", LOG_LEVEL);
+#endif
+	return 1;
+}
 #endif  // RTT_CMD_ENABLE
 
+#endif  // LOG_BY_RTT
+
+// rec: 2 bytes for the switch to terminal 0, then the message of len bytes
+static void dbger_log_write(char *rec, unsigned len)
+{
+#if LOG_BY_RTT
+	rec[0] = (char)0xFF;			// same sequence as SEGGER_RTT_SetTerminal(0)
+	rec[1] = '0';
+	len += 2;
+	rec[len++] = (char)0xFF;
+	rec[len++] = "0123456789ABCDEF"[dbger_terminal];
+	dbger_write(rec, len);
+#else
+	dbger_write(rec + 2, len);
+#endif
+}
+
+#define DBGER_CUT		"...\n" COLOR_DEFAULT		// end of a message cut at LOG_MSG_LEN, its '\n' and color were cut too
+#define DBGER_CUT_LEN	(sizeof(DBGER_CUT) - 1)
+
+// msg: len bytes, over LOG_MSG_LEN if it was cut, with room for DBGER_CUT behind LOG_MSG_LEN; return the length to write
+static unsigned dbger_log_cut(char *msg, unsigned len)
+{
+	if(len > LOG_MSG_LEN) {
+		memcpy(msg + LOG_MSG_LEN, DBGER_CUT, DBGER_CUT_LEN);
+		len = LOG_MSG_LEN + DBGER_CUT_LEN;
+	}
+	return len;
+}
+
+/**
+ * @brief	the whole message, with the switch to terminal 0 and back for RTT, is built in one buffer,
+ *			so it's one formatter pass and one locked write, LOG from ISR can't break into the middle of it.
+ */
+void dbger_log(const char *fmt, ...)
+{
+	char buf[DBGER_TIME_LEN + LOG_MSG_LEN + DBGER_CUT_LEN + 4];
+	char *rec = buf + DBGER_TIME_LEN;		// room for the stamp of LOG_TIME
+	int n;
+	va_list ap;
+
+	dbger_flush();					// the pending printf() of this context goes first
+	va_start(ap, fmt);
+#if LOG_SMALL_PRINTF
+	n = SEGGER_RTT_vsnprintf(rec + 2, LOG_MSG_LEN + 1, fmt, &ap);
+#else
+	n = vsnprintf(rec + 2, LOG_MSG_LEN + 1, fmt, ap);
+#endif
+	va_end(ap);
+	if(n < 0) {
+		return;
+	}
+	dbger_log_write(rec, dbger_log_cut(rec + 2, (unsigned)n));
+}
+
+// same as dbger_log(), the message is formatted by the caller, eg dbger.hpp, len over LOG_MSG_LEN: it was cut
+void dbger_log_str(const char *msg, unsigned len)
+{
+	char buf[DBGER_TIME_LEN + LOG_MSG_LEN + DBGER_CUT_LEN + 4];
+	char *rec = buf + DBGER_TIME_LEN;
+
+	dbger_flush();
+	memcpy(rec + 2, msg, (len > LOG_MSG_LEN) ? LOG_MSG_LEN : len);
+	dbger_log_write(rec, dbger_log_cut(rec + 2, len));
+}
+
+// same path as printf(), without formatting
+void dbger_print(const char *text, unsigned len)
+{
+	while(len--) {
+		dbger_putchar(*text++);
+	}
+}
+
+#if LOG_SMALL_PRINTF
+static int dbger_print_block(void *context, const char *data, unsigned len)
+{
+	(void)context;
+	dbger_print(data, len);
+	return 0;
+}
+
+// the text is passed in blocks of SEGGER_RTT_PRINTF_BUFFER_SIZE, so it's never formatted in full on stack
+int dbger_printf(const char *fmt, ...)
+{
+	int n;
+	va_list ap;
+
+	va_start(ap, fmt);
+	n = SEGGER_RTT_vprintfCallback(dbger_print_block, NULL, fmt, &ap);
+	va_end(ap);
+	return n;
+}
+#endif
+
+void dbger_init(void)
+{
+#if LOG_BY_UART
+	MX_USART1_UART_Init();
+#if LOG_UART_ASYNC
+	SEGGER_RTT_Init();
+	SEGGER_RTT_ConfigUpBuffer(0, NULL, NULL, 0, ((LOG_UART_MODE == SEGGER_RTT_MODE_BLOCK_IF_FIFO_FULL) ? SEGGER_RTT_MODE_NO_BLOCK_TRIM : LOG_UART_MODE) | DBGER_RTT_MARK);
+#endif
+#elif LOG_BY_RTT
+#if defined(DBGER_TIME_DWT)
+	*(volatile uint32_t *)0xE000EDFCu |= 1u << 24;		// CoreDebug->DEMCR.TRCENA
+	*(volatile uint32_t *)0xE0001FB0u = 0xC5ACCE55u;		// DWT->LAR unlock, needed on Cortex-M7
+	*(volatile uint32_t *)0xE0001000u |= 1u;			// DWT->CTRL.CYCCNTENA
+#endif
+	SEGGER_RTT_Init();
+#if SEGGER_RTT_STATS
+	SEGGER_RTT_SetFlagsUpBuffer(0, SEGGER_RTT_MODE_DEFAULT | DBGER_RTT_MARK);
+#endif
+#if LOG_DEFERRED
+	SEGGER_RTT_ConfigUpBuffer(LOG_DEFERRED_CHANNEL, "dbger", dbger_deferred_buf, sizeof(dbger_deferred_buf), SEGGER_RTT_MODE_NO_BLOCK_SKIP);
+#endif
+#if LOG_POSTMORTEM
+	int pm = SEGGER_RTT_ConfigPostMortem(LOG_POSTMORTEM_CHANNEL, "dbger pm");		// bytes kept from before the reset, before the contexts take the free buffers
+#endif
+#if LOG_CTX_CHANNEL
+	for(unsigned i = 0; i < LOG_CTX_NUM; i++) {
+		int r = SEGGER_RTT_AllocUpBuffer("dbger ctx", dbger_ctx_buf[i], LOG_CTX_BUF_LEN, SEGGER_RTT_MODE_NO_BLOCK_SKIP);
+		dbger_ctx_chan[i] = (r > 0) ? (unsigned char)r : 0;		// no free buffer: channel 0
+	}
+#endif
+	dbger_set_terminal(dbger_terminal);
+#if LOG_TIME
+	{
+		uint8_t hz[12] = { 0xFF, 'H' };		// ticks per second of the stamps, for host tools
+		unsigned n = 2 + dbger_put_var(hz + 2, LOG_TIME_HZ());
+
+#if LOG_RTT_LOCKFREE
+		SEGGER_RTT_WriteLockFree(0, hz, n);
+#else
+		SEGGER_RTT_Write(0, hz, n);
+#endif
+		DBGER_PM_WRITE(hz, n);
+	}
 #endif
+#if LOG_POSTMORTEM
+	if(pm > 0) {
+		dbger_log("--- %d bytes before reset in RTT channel %d ---\n", pm, LOG_POSTMORTEM_CHANNEL);
+	}
+#endif
+#endif
+}
 
 #if LOG_TEST_EN
 void log_test(void)
@@ -89,7 +909,7 @@ void log_test(void)
 		printf("\n");
 
         size_t cmd_len = get_RTT_cmd();
-        if(cmd_len) {
+        if(cmd_len && !dbger_cmd(RTT_cmd_buf)) {
             LOG_DBG("cmd[%s] len[%d]\n", RTT_cmd_buf, cmd_len);
             if(strncmp(RTT_cmd_buf, "test1", 5) == 0) {
                 LOG_DBG("process test1 cmd\n");
@@ -14,6 +14,10 @@
  *		  2. If LOG_BY_RTT, you can get the LOG in J-Link RTT Viewer;
  *		  3. If LOG_BY_UART, you can get the LOG in any UART assistant, like PuTTY;
  *		  4. you can output the LOG by LOG_xxx() micro for different LOG level, or just by printf();
+ *		  5. LOG_AST/ERR/WAR need a string literal format, they go to terminal 0, printf() and other LOG to terminal 1;
+ *		  6. C++ can #include "dbger.hpp" for dbg::log<"x = {}\n">(x), the format is checked and parsed at compile time, see dbger.hpp;
+ *		  7. with an RTOS, define LOG_CTX_ID() to give each task its own context, or lines of tasks can interleave, see LOG_CTX_NUM;
+ *		  8. with LOG_LEVEL_RUNTIME, each file which LOGs defines its module once, after #include "dbger.h": DBGER_MODULE("name");
  *
  * @note HOW TO USE RTT JSCOPE:
  *        1. global define
@@ -36,14 +40,103 @@
                   jscopeData.i1++;
                   SEGGER_RTT_Write(1, &jscopeData, sizeof(jscopeData));
               }
+ *           or write the data directly into the RTT buffer without copy (JSCOPE_BUF_LEN must be multiple of sizeof(JSCOPE_TYPE_t), eg: 510):
+              SEGGER_RTT_RESERVATION res;
+              SEGGER_RTT_LOCK();
+              if(SEGGER_RTT_ReserveNoLock(1, sizeof(JSCOPE_TYPE_t), &res)) {
+                  JSCOPE_TYPE_t *p = (JSCOPE_TYPE_t *)res.pData0;     // never wrap-around inside one sample
+                  p->u2 = HAL_GetTick() & 0xFFFF;
+                  p->i1 = cnt++;
+                  SEGGER_RTT_CommitNoLock(1, sizeof(JSCOPE_TYPE_t));
+              }
+              SEGGER_RTT_UNLOCK();
  *        4. Seems CAN'T add "t4"? I always failed.
  *            
  *
+ * @note HOW TO USE DEFERRED LOG (LOG_DEFERRED = 1, LOG_BY_RTT only):
+ *        1. LOG_xxx() do NOT format on MCU, they only write a binary record to RTT up-buffer LOG_DEFERRED_CHANNEL:
+ *              [0xDB][ArgLen][FmtId: 4B][Timestamp: 4B][Args: ArgLen B]     (little endian)
+ *           FmtId is the address of the format string in section "dbger_fmt" (offset into the section for LOG_PLATFORM 1),
+ *           Timestamp is LOG_TIMESTAMP(), see the time base below LOG_TIME;
+ *        2. the format strings are never read by MCU, so section "dbger_fmt" can be placed in an INFO region of the linker script to save flash;
+ *        3. log the channel with JLinkRTTLogger (or any RTT client), then rebuild the text on host:
+ *              host/dbger_decode firmware.elf channel.bin
+ *           a long log is decoded by all cores, also from a capture of host/rtt_capture: host/dbger_decode -j 8 -c 2 firmware.elf log.cap
+ *        4. "%s" args are copied into the record (up to the precision, NULL as "(null)"), "%f" args cost 8 bytes ("%Lf" is narrowed to double),
+ *           all other args cost 4 bytes ("%ll" 8 bytes);
+ *
+ * @note HOW TO USE CONTEXT CHANNEL (LOG_CTX_CHANNEL = 1, LOG_BY_RTT only):
+ *        1. each context (LOG_CTX_ID()) writes its own RTT up-buffer allocated by LOG_INIT(), so a flood in one context only drops its own LOG;
+ *           raise SEGGER_RTT_MAX_NUM_UP_BUFFERS in SEGGER_RTT_Conf.h, and config buffers with fixed index (eg JScope) before LOG_INIT();
+ *           LOG_CTX_NUM channels are taken, lower LOG_CTX_PRIO_BITS to the priority levels in use when the IRQs which LOG differ in the top bits;
+ *        2. each write is a record, Seq is counted over all contexts:
+ *              [0xDC][Len][Seq: 4B][Timestamp: 4B][Text: Len B]     (little endian)
+ *        3. log each channel into a file with JLinkRTTLogger, then merge them into one stream, lost records are marked:
+ *              host/dbger_merge ctx0.bin ctx1.bin
+ *
+ * @note HOW TO USE RTT WITHOUT J-LINK (LOG_PLATFORM = 1):
+ *        1. build with -DSEGGER_RTT_SECTION='"rtt_shm"' and host/rtt_shm.c, _SEGGER_RTT and the RTT buffers go to POSIX shared memory;
+ *        2. host/rtt_probe reads the up-buffers and writes stdin into down-buffer 0 from another process, like J-Link:
+ *              host/rtt_probe -r 1000 -b 1000000 -o chan.     // chan.N.bin for up-buffer N
+ *        3. host/rtt_capture keeps up with bursts, all up-buffers go into one file with the time they were read,
+ *           channel 0 split by terminal; it also reads a running process (/proc/<pid>/mem) or a RAM dump of a board:
+ *              host/rtt_capture log.cap                       // then: host/rtt_capture -x -f -t 0 log.cap
+ *        4. host/dbger_index indexes the lines of a capture by time, level, file:line and terminal, a query reads only what it prints:
+ *              host/dbger_index -q -l ERR -F motor.c -s 3600 -e 7200 log.cap
+ *
+ * @note HOW TO USE LOG TIME (LOG_TIME = 1, LOG_BY_RTT only):
+ *        1. each LOG line of channel 0 starts with 0xFF 'T' and its time, records of LOG_DEFERRED and LOG_CTX_CHANNEL
+ *           carry it in the head instead of the 4 bytes timestamp (sync 0xDA / 0xDE instead of 0xDB / 0xDC);
+ *        2. the time is a varint (7 bits per byte, low first) of (ticks since the last record of the channel << 1),
+ *           or of (absolute ticks << 1 | 1) for the first record and after a lost one, 1..5 bytes for a 32 bits counter;
+ *        3. LOG_INIT() writes 0xFF 'H' and LOG_TIME_HZ() as varint to channel 0, host tools rebuild the time in seconds:
+ *              host/rtt_probe | host/dbger_time               // channel 0, J-Link RTT Viewer shows the stamps as garbage
+ *              host/dbger_decode -f 168000000 firmware.elf channel.bin
+ *              host/dbger_merge -t -f 168000000 ctx0.bin ctx1.bin
+ *        4. a 32 bits counter wraps (25 s at 168 MHz), a gap between two LOG longer than that is lost from the time;
+ *
+ * @note HOW TO USE POST-MORTEM LOG (LOG_POSTMORTEM = 1, LOG_BY_RTT only):
+ *        1. set SEGGER_RTT_POSTMORTEM = 1 in SEGGER_RTT_Conf.h and place section ".noinit" in RAM which the startup code
+ *           does not touch, eg GCC linker script:  .noinit (NOLOAD) : { *(.noinit) } > RAM
+ *        2. the LOG text of channel 0 (with LOG_CTX_CHANNEL: the text of all contexts) is copied into up-buffer LOG_POSTMORTEM_CHANNEL,
+ *           which overwrites its oldest data, so it holds the last SEGGER_RTT_POSTMORTEM_SIZE bytes even without a host;
+ *           binary records of LOG_DEFERRED are not kept;
+ *        3. after a hard fault or watchdog reset, LOG_INIT() finds the buffer by its magic and CRC and leaves what the host had not read
+ *           in the up-buffer, as it was written, then it logs "--- N bytes before reset in RTT channel C ---";
+ *           read the channel with any RTT client, eg JLinkRTTLogger -RTTChannel C, or on Linux: host/rtt_probe -o chan.
+ *        4. a crashed target which is not reset yet: read the channel, or _SEGGER_RTT_PostMortem in the debugger;
+ *
+ * @note HOW TO USE RTT STATISTICS (SEGGER_RTT_STATS = 1 in SEGGER_RTT_Conf.h):
+ *        1. each up-buffer counts bytes written, dropped and trimmed, max fill level and time blocked in _SEGGER_RTT_Stats,
+ *           next to _SEGGER_RTT, read it in the debugger or by host/rtt_probe (printed at the end);
+ *        2. where text LOG of channel 0 has been dropped, the line "--- N messages lost ---" is written once there is space again;
+ *        3. set SEGGER_RTT_STATS_TIME() to a cycle counter (eg DWT->CYCCNT) to count the blocked time;
+ *
  * @author	shadowthreed@gmail.com
  * @date	20240714
  *			20240809	update: same API for UART and RTT
  *          20250616    updata: add JSCOPE
  *          20251126    updata: support RTT CMD
+ *          20261017    update: add deferred binary LOG
+ *                      update: send stdout to RTT line by line
+ *                      update: UART LOG is sent by DMA in background
+ *                      update: __FILENAME__ is resolved at compile time
+ *                      update: LOG_AST/ERR/WAR are formatted and written in one pass
+ *                      update: runtime LOG level for each module
+ *                      update: lock-free RTT write
+ *                      update: RTT channel for each context
+ *                      update: C++ front-end dbger.hpp, the format is parsed at compile time
+ *                      update: LOG_SMALL_PRINTF, LOG is formatted by SEGGER_RTT_printf.c instead of libc
+ *                      update: RTT in shared memory on Linux, read by host/rtt_probe instead of J-Link
+ *                      update: RTT statistics for each up-buffer, lost LOG is marked in channel 0
+ *                      update: LOG_TIME, time of each LOG as varint delta
+ *                      update: LOG_POSTMORTEM, the last LOG survives a reset in no-init RAM
+ *                      update: host/rtt_capture, all up-buffers into one capture file at full speed
+ *                      update: host/dbger_index, index and query of the LOG lines in a capture
+ *                      update: host/dbger_decode decodes in parallel, in pieces of the channel
+ *                      update: the timestamp of records comes from the time base of LOG_TIME, no more 0 by default
+ *                      update: a context for each IRQ priority level, LOG_CTX_ID() is required with an RTOS
+ *                      update: the module of a file is defined by DBGER_MODULE() in the file
  */
 
 #ifndef __DBGER_H__
@@ -62,11 +155,37 @@ extern "C"
 #define LOG_TEST_EN			0
 #define LOG_PLATFORM		0		// 0:MDK_ARM	1:Linux
 #define RTT_CMD_ENABLE      1
+#define LOG_DEFERRED		0		// 1: LOG_xxx() write binary records, text is rebuilt on host (LOG_BY_RTT only)
+#define LOG_LEVEL_RUNTIME	0		// 1: each module (DBGER_MODULE()) has a level which can be changed at runtime, eg by RTT cmd "log main.c 6",
+										//    each file which LOGs must define its module then, with 0 DBGER_MODULE() does nothing
+#define LOG_LEVEL_DEFAULT	LOG_LEVEL	// runtime level of a module at start, LOG over LOG_LEVEL are never compiled in
 
 #if LOG_ENABLE
-	#include <string.h>
-	// strrchr(str, ch): return the last position of ch in str, or NULL
-	#define __FILENAME__ (strrchr(__FILE__, '/') ? strrchr(__FILE__, '/') + 1 : __FILE__) 
+	// __FILENAME__: file name without path, resolved at compile time if possible, so LOG_AST/ERR/WAR never scan the path
+	// it can be given by the build for each file, eg Makefile: CFLAGS += -D__FILENAME__=\"$(notdir $<)\"
+	#ifndef __FILENAME__
+	#if defined(__FILE_NAME__)				// GCC 12+, clang 9+, Arm Compiler 6
+		#define __FILENAME__	__FILE_NAME__
+		#define DBGER_FILE		__FILE_NAME__	// string literal, only the short name is in flash
+	#elif defined(__CC_ARM)					// Arm Compiler 5: __MODULE__ is the file name of __FILE__
+		#define __FILENAME__	__MODULE__
+		#define DBGER_FILE		__MODULE__
+	#elif defined(__cplusplus)
+		constexpr const char *dbger_basename(const char *p, const char *name)
+		{
+			return *p == '\0' ? name : dbger_basename(p + 1, (*p == '/' || *p == '\\') ? p + 1 : name);
+		}
+		// constexpr variable forces the compiler to resolve it at compile time
+		#define __FILENAME__	([]{ constexpr const char *_dbger_name = dbger_basename(__FILE__, __FILE__); return _dbger_name; }())
+	#else
+		#include <string.h>
+		// strrchr(str, ch): return the last position of ch in str, or NULL. Hint: GCC 8+ -fmacro-prefix-map=$(dir $<)= makes __FILE__ short
+		#define __FILENAME__ (strrchr(__FILE__, '/') ? strrchr(__FILE__, '/') + 1 : __FILE__) 
+	#endif
+	#endif
+	#ifndef DBGER_FILE
+		#define DBGER_FILE		__FILE__		// string literal of the file, for the prefix of deferred LOG
+	#endif
 #endif
 
 #if LOG_ENABLE && LOG_COLOR_ENABLE
@@ -97,35 +216,164 @@ extern "C"
 	#endif
 #endif
 
+#if LOG_ENABLE
+	#define LOG_INIT()		dbger_init()
+	void dbger_init(void);
+	#define LOG_LINE_BUF_LEN	128		// printf() is sent line by line (one locked write per line), 0: char by char
+#if LOG_PLATFORM == 1
+	#define LOG_CTX_NUM			2		// line buffer for each context, threads take them in turn
+#else
+	#define LOG_CTX_PRIO_BITS	2		// top priority bits which split the IRQs into contexts, each context costs a line buffer (LOG_LINE_BUF_LEN)
+										// raise it (up to __NVIC_PRIO_BITS) until the IRQ levels which LOG differ in these bits
+	#define LOG_CTX_IRQ_NUM		(1 + (1 << LOG_CTX_PRIO_BITS))	// contexts of handlers: 1 for NMI/HardFault, then one for each priority level
+	#define LOG_CTX_NUM			(1 + LOG_CTX_IRQ_NUM)	// line buffer for each context: 0 for thread mode, 1.. for handlers, see dbger_ctx_irq()
+	// with an RTOS, define LOG_CTX_ID(): tasks preempt each other in thread mode, one context for all would interleave their lines.
+	// give each task which LOGs its own number (FreeRTOS: vTaskSetTaskNumber(), 0 is shared by the others) and keep the contexts of handlers, eg:
+	// #define LOG_CTX_NUM		(1 + LOG_CTX_IRQ_NUM + 8)	// task number 0..7
+	// #define LOG_CTX_ID()		(dbger_ctx_irq() ? dbger_ctx_irq() : 1 + LOG_CTX_IRQ_NUM + uxTaskGetTaskNumber(xTaskGetCurrentTaskHandle()))
+	unsigned dbger_ctx_irq(void);		// context of the active handler: 0 in thread mode, 1..LOG_CTX_IRQ_NUM in a handler
+#endif
+	void dbger_flush(void);				// send the pending line of current context
+	#define LOG_MSG_LEN			128		// max length of one LOG_AST/ERR/WAR message, it is formatted on stack, a longer one is cut and ends with "...\n"
+	void dbger_log(const char *fmt, ...);	// format one message and write it at once, it never interleaves with other LOG
+	void dbger_log_str(const char *msg, unsigned len);	// dbger_log() of a message formatted by the caller, eg dbger.hpp, len > LOG_MSG_LEN if it was cut
+	void dbger_print(const char *text, unsigned len);	// printf() of a text without formatting
+	#define LOG_SMALL_PRINTF	0		// 1: LOG_xxx() format with SEGGER_RTT_printf.c instead of libc (no heap, small), see SEGGER_RTT_printf() for the conversions
+#if LOG_SMALL_PRINTF
+	#include "SEGGER_RTT.h"
+	int dbger_printf(const char *fmt, ...);	// printf() with the formatter of SEGGER_RTT_printf.c
+	#define LOG_PRINTF		dbger_printf
+#else
+	#define LOG_PRINTF		printf
+#endif
+#endif
+
+#if LOG_ENABLE && LOG_LEVEL_RUNTIME
+	// one module for each file which LOGs, it MUST be defined once in the source file (not in a header), after #include "dbger.h":
+	//     DBGER_MODULE("uart");			// or DBGER_MODULE(DBGER_FILE); to name it by the file
+	// a module is registered by its first LOG, until then it can only be changed by "*"
+	#define LOG_MODULE_UNREG	0xFF
+	typedef struct dbger_module_s {
+		unsigned char level;			// LOG_MODULE_UNREG until registered
+		const char *name;
+		struct dbger_module_s *next;
+	} dbger_module_t;
+#ifdef __cplusplus
+	namespace { extern dbger_module_t dbger_module; }		// for the templates of dbger.hpp, a file without DBGER_MODULE() fails to link
+	#define DBGER_MODULE(name)	namespace { dbger_module_t dbger_module __attribute__((unused)) = { LOG_MODULE_UNREG, name, 0 }; }
+#else
+	#define DBGER_MODULE(name)	static dbger_module_t dbger_module __attribute__((unused)) = { LOG_MODULE_UNREG, name, 0 }
+#endif
+	unsigned char dbger_register(dbger_module_t *module);		// return the level of module
+	int dbger_set_level(const char *name, unsigned level);		// name "*" for all modules, level 0..LOG_LEVEL, return number of modules changed
+	// disabled LOG cost one load and one branch
+	#define LOG_ON(n)		(LOG_LEVEL >= (n) && dbger_module.level >= (n) && (dbger_module.level != LOG_MODULE_UNREG || dbger_register(&dbger_module) >= (n)))
+#else
+	#define DBGER_MODULE(name)	typedef int dbger_module_off_t
+	#define LOG_ON(n)		(LOG_LEVEL >= (n))
+#endif
+
 #if LOG_ENABLE
 #if LOG_BY_RTT
 	// SEGGER_RTT_SetTerminal(2); 	SEGGER_RTT_SetTerminal(3);  keep for user, eg: terminal2 default for printing protocol data
 	#include "SEGGER_RTT.h"
 	#include <stdint.h>
-	#define LOG_INIT()		SEGGER_RTT_Init()
-	#define LOG_DAT(...)	do { if(LOG_LEVEL >= 1) { SEGGER_RTT_SetTerminal(2); printf(__VA_ARGS__); SEGGER_RTT_SetTerminal(1); }} while(0)		// for print protocol data
-	#define LOG_AST(...)    do { if(LOG_LEVEL >= 1) { SEGGER_RTT_SetTerminal(0); printf(COLOR_RED 		"[AST:%s:%d] ", __FILENAME__, __LINE__); printf(__VA_ARGS__); printf("%s", COLOR_DEFAULT ""); SEGGER_RTT_SetTerminal(1); }} while(0)
-	#define LOG_ERR(...)    do { if(LOG_LEVEL >= 2) { SEGGER_RTT_SetTerminal(0); printf(COLOR_PINK 		"[ERR:%s:%d] ", __FILENAME__, __LINE__); printf(__VA_ARGS__); printf("%s", COLOR_DEFAULT ""); SEGGER_RTT_SetTerminal(1); }} while(0)
-	#define LOG_WAR(...)    do { if(LOG_LEVEL >= 3) { SEGGER_RTT_SetTerminal(0); printf(COLOR_YELLOW 	"[WAR:%s:%d] ", __FILENAME__, __LINE__); printf(__VA_ARGS__); printf("%s", COLOR_DEFAULT ""); SEGGER_RTT_SetTerminal(1); }} while(0)
-	#define LOG_INF(...)    do { if(LOG_LEVEL >= 4) { printf(__VA_ARGS__); }} while(0)
-	#define LOG_DBG(...)    do { if(LOG_LEVEL >= 5) { printf(__VA_ARGS__); }} while(0)
-	#define LOG_VBS(...)    do { if(LOG_LEVEL >= 6) { printf(__VA_ARGS__); }} while(0)
-	#define LOG_INT(...)	do { if(LOG_LEVEL >= 1) { printf(__VA_ARGS__); }} while(0)
+	int dbger_set_terminal(unsigned char terminal_id);		// flush, then SEGGER_RTT_SetTerminal()
+	#define LOG_RTT_LOCKFREE	0		// 1: LOG is written to RTT channel 0 without masking interrupts, then channel 0 must not be written by other SEGGER_RTT_xxx()
+	#define LOG_CTX_CHANNEL		0		// 1: each context has its own RTT channel, see HOW TO USE CONTEXT CHANNEL
+	#define LOG_CTX_BUF_LEN		512		// RTT up-buffer size of each context
+	#define LOG_TIME			0		// 1: each LOG line and record carries its time as ticks since the previous one, see HOW TO USE LOG TIME
+	#define LOG_POSTMORTEM		0		// 1: LOG text is also kept in an RTT up-buffer which survives a reset, see HOW TO USE POST-MORTEM LOG
+	#define LOG_POSTMORTEM_CHANNEL	(SEGGER_RTT_MAX_NUM_UP_BUFFERS - 1)	// RTT up-buffer of it, must not be LOG_DEFERRED_CHANNEL
+	// time base of LOG_TIME and of the timestamp in records: DWT cycle counter on Cortex-M3/4/7/33, HAL_GetTick() ms on other cores,
+	// clock_gettime() ns on Linux (the low 32 bits in records without LOG_TIME);
+	// or define your own free running counter of the width of dbger_time_t, eg: #define LOG_TIMESTAMP() __rdtsc()  #define LOG_TIME_HZ() 0
+	#if LOG_PLATFORM == 1
+	typedef uint64_t dbger_time_t;
+	#else
+	typedef uint32_t dbger_time_t;
+	#endif
+	#ifndef LOG_TIMESTAMP
+	#if LOG_PLATFORM == 1
+		#include <time.h>
+		static inline dbger_time_t dbger_time_now(void)
+		{
+			struct timespec ts;
+
+			clock_gettime(CLOCK_MONOTONIC, &ts);
+			return (dbger_time_t)ts.tv_sec * 1000000000u + (dbger_time_t)ts.tv_nsec;
+		}
+		#define LOG_TIMESTAMP()		dbger_time_now()
+		#define LOG_TIME_HZ()		1000000000u
+	#elif defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_8M_MAIN__) || defined(__ARM_ARCH_8_1M_MAIN__) \
+		|| defined(__TARGET_ARCH_7_M) || defined(__TARGET_ARCH_7E_M)
+		#define DBGER_TIME_DWT		1		// LOG_INIT() starts the counter
+		#define LOG_TIMESTAMP()		(*(volatile uint32_t *)0xE0001004u)		// DWT->CYCCNT
+		#define LOG_TIME_HZ()		SystemCoreClock
+	#else
+		uint32_t HAL_GetTick(void);			// Cortex-M0/M0+/M23 have no DWT
+		#define LOG_TIMESTAMP()		HAL_GetTick()
+		#define LOG_TIME_HZ()		1000u
+	#endif
+	#endif
+	#ifndef LOG_TIME_HZ
+		#define LOG_TIME_HZ()		0u		// ticks per second, sent to host by LOG_INIT(), 0: unknown, host prints ticks
+	#endif
+	#define LOG_DAT(...)	do { if(LOG_ON(1)) { dbger_set_terminal(2); LOG_PRINTF(__VA_ARGS__); dbger_set_terminal(1); }} while(0)		// for print protocol data
+#if LOG_DEFERRED
+	#define LOG_DEFERRED_CHANNEL	2		// RTT up-buffer for binary records, must < SEGGER_RTT_MAX_NUM_UP_BUFFERS
+	#define LOG_DEFERRED_BUF_LEN	1024
+	#define LOG_DEFERRED_ARG_LEN	64		// max bytes of args in one record, "%s" will be trimmed to fit
+
+	#define _DBGER_STR(x)	#x
+	#define DBGER_STR(x)	_DBGER_STR(x)
+	// the format string is only referenced by address, it never needs to be read by MCU
+	#define DBGER_DEFER(fmt, ...)	do { static const char _dbger_fmt[] __attribute__((section("dbger_fmt"))) = fmt; dbger_deferred(_dbger_fmt, ##__VA_ARGS__); } while(0)
+	void dbger_deferred(const char *fmt, ...);
+	void dbger_record(const char *fmt, const void *arg, unsigned arg_len);	// args packed by the caller, eg dbger.hpp
+
+	#define LOG_AST(fmt, ...)	do { if(LOG_ON(1)) { DBGER_DEFER(COLOR_RED 	"[AST:" DBGER_FILE ":" DBGER_STR(__LINE__) "] " fmt COLOR_DEFAULT, ##__VA_ARGS__); }} while(0)
+	#define LOG_ERR(fmt, ...)	do { if(LOG_ON(2)) { DBGER_DEFER(COLOR_PINK 	"[ERR:" DBGER_FILE ":" DBGER_STR(__LINE__) "] " fmt COLOR_DEFAULT, ##__VA_ARGS__); }} while(0)
+	#define LOG_WAR(fmt, ...)	do { if(LOG_ON(3)) { DBGER_DEFER(COLOR_YELLOW 	"[WAR:" DBGER_FILE ":" DBGER_STR(__LINE__) "] " fmt COLOR_DEFAULT, ##__VA_ARGS__); }} while(0)
+	#define LOG_INF(fmt, ...)	do { if(LOG_ON(4)) { DBGER_DEFER(fmt, ##__VA_ARGS__); }} while(0)
+	#define LOG_DBG(fmt, ...)	do { if(LOG_ON(5)) { DBGER_DEFER(fmt, ##__VA_ARGS__); }} while(0)
+	#define LOG_VBS(fmt, ...)	do { if(LOG_ON(6)) { DBGER_DEFER(fmt, ##__VA_ARGS__); }} while(0)
+	#define LOG_INT(fmt, ...)	do { if(LOG_ON(1)) { DBGER_DEFER(fmt, ##__VA_ARGS__); }} while(0)
+#else
+	// prefix, message and color are formatted in one pass and written to terminal 0 with one locked write
+	#define LOG_AST(fmt, ...)	do { if(LOG_ON(1)) { dbger_log(COLOR_RED 		"[AST:%s:%d] " fmt COLOR_DEFAULT, __FILENAME__, __LINE__, ##__VA_ARGS__); }} while(0)
+	#define LOG_ERR(fmt, ...)	do { if(LOG_ON(2)) { dbger_log(COLOR_PINK 		"[ERR:%s:%d] " fmt COLOR_DEFAULT, __FILENAME__, __LINE__, ##__VA_ARGS__); }} while(0)
+	#define LOG_WAR(fmt, ...)	do { if(LOG_ON(3)) { dbger_log(COLOR_YELLOW 	"[WAR:%s:%d] " fmt COLOR_DEFAULT, __FILENAME__, __LINE__, ##__VA_ARGS__); }} while(0)
+	#define LOG_INF(...)    do { if(LOG_ON(4)) { LOG_PRINTF(__VA_ARGS__); }} while(0)
+	#define LOG_DBG(...)    do { if(LOG_ON(5)) { LOG_PRINTF(__VA_ARGS__); }} while(0)
+	#define LOG_VBS(...)    do { if(LOG_ON(6)) { LOG_PRINTF(__VA_ARGS__); }} while(0)
+	#define LOG_INT(...)	do { if(LOG_ON(1)) { LOG_PRINTF(__VA_ARGS__); }} while(0)
+#endif  // LOG_DEFERRED
     
     #if RTT_CMD_ENABLE
         #define RTT_CMD_BUF_LEN     32
         extern char RTT_cmd_buf[RTT_CMD_BUF_LEN];
         size_t get_RTT_cmd(void);      // return 1 for cmd valid; return 0 for cmd invalid;
+        int dbger_cmd(const char *cmd);     // handle dbger cmd in RTT_cmd_buf, return 1 if it's a dbger cmd, eg: "log", "log * 6", "log main.c 2"
     #endif  // RTT_CMD_ENABLE
 #elif LOG_BY_UART
 	#include <stdio.h>
-	#define LOG_INIT()		MX_USART1_UART_Init()
-	#define LOG_AST(...)    do { if(LOG_LEVEL >= 1) { printf(COLOR_RED 		"[AST:%s:%d] ", __FILENAME__, __LINE__); printf(__VA_ARGS__); printf("%s", COLOR_DEFAULT ""); }} while(0)
-	#define LOG_ERR(...)    do { if(LOG_LEVEL >= 2) { printf(COLOR_PINK 	"[ERR:%s:%d] ", __FILENAME__, __LINE__); printf(__VA_ARGS__); printf("%s", COLOR_DEFAULT ""); }} while(0)
-	#define LOG_WAR(...)    do { if(LOG_LEVEL >= 3) { printf(COLOR_YELLOW 	"[WAR:%s:%d] ", __FILENAME__, __LINE__); printf(__VA_ARGS__); printf("%s", COLOR_DEFAULT ""); }} while(0)
-	#define LOG_INF(...)    do { if(LOG_LEVEL >= 4) { printf(__VA_ARGS__); }} while(0)
-	#define LOG_DBG(...)    do { if(LOG_LEVEL >= 5) { printf(__VA_ARGS__); }} while(0)
-	#define LOG_VBS(...)    do { if(LOG_LEVEL >= 6) { printf(__VA_ARGS__); }} while(0)
+	#define LOG_UART_ASYNC		1		// 1: LOG is queued in a ring and sent by DMA in background, 0: HAL_UART_Transmit() blocks until sent
+#if LOG_UART_ASYNC
+	// the ring is RTT up-buffer 0, so it has the same modes when it is full: SEGGER_RTT_MODE_NO_BLOCK_SKIP / _NO_BLOCK_TRIM / _BLOCK_IF_FIFO_FULL
+	// the ring size is BUFFER_SIZE_UP in SEGGER_RTT_Conf.h
+	// NOTE: for SEGGER_RTT_MODE_BLOCK_IF_FIFO_FULL, LOG from ISR will wait for UART DMA interrupt, so the UART DMA IRQ must has higher priority
+	#include "SEGGER_RTT.h"
+	#define LOG_UART_MODE		SEGGER_RTT_MODE_NO_BLOCK_SKIP
+	#define LOG_UART_OWN_CALLBACK	1	// 1: dbger defines HAL_UART_TxCpltCallback(); 0: call dbger_uart_tx_cplt() for huart1 in your HAL_UART_TxCpltCallback()
+	void dbger_uart_tx_cplt(void);
+#endif
+	#define LOG_AST(fmt, ...)	do { if(LOG_ON(1)) { dbger_log(COLOR_RED 		"[AST:%s:%d] " fmt COLOR_DEFAULT, __FILENAME__, __LINE__, ##__VA_ARGS__); }} while(0)
+	#define LOG_ERR(fmt, ...)	do { if(LOG_ON(2)) { dbger_log(COLOR_PINK 		"[ERR:%s:%d] " fmt COLOR_DEFAULT, __FILENAME__, __LINE__, ##__VA_ARGS__); }} while(0)
+	#define LOG_WAR(fmt, ...)	do { if(LOG_ON(3)) { dbger_log(COLOR_YELLOW 	"[WAR:%s:%d] " fmt COLOR_DEFAULT, __FILENAME__, __LINE__, ##__VA_ARGS__); }} while(0)
+	#define LOG_INF(...)    do { if(LOG_ON(4)) { LOG_PRINTF(__VA_ARGS__); }} while(0)
+	#define LOG_DBG(...)    do { if(LOG_ON(5)) { LOG_PRINTF(__VA_ARGS__); }} while(0)
+	#define LOG_VBS(...)    do { if(LOG_ON(6)) { LOG_PRINTF(__VA_ARGS__); }} while(0)
 	#define LOG_INT(...)
 #endif
 #else
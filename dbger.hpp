@@ -0,0 +1,678 @@
+/**
+ * @file	dbger.hpp
+ * @brief	C++ front-end of the Log module. The format string is parsed at compile time (C++20),
+ *			so no format is scanned on MCU and a wrong argument is a compile error instead of broken LOG.
+ *
+ * @note HOW TO USE:
+ *        1. #include "dbger.hpp" instead of "dbger.h", LOG_xxx() and printf() still work;
+ *        2. dbg::ast/err/war/inf/dbg/vbs<"format">(args...) for each LOG level, dbg::log<>() is dbg::inf<>(),
+ *           DBG_AST/ERR/WAR(format, args...) add the same color and [ERR:file:line] prefix as LOG_AST/ERR/WAR:
+ *              dbg::log<"adc[{}] = {:#06x}, {:.3f} V\n">(ch, raw, volt);
+ *              DBG_ERR("open {} failed: {}\n", name, err);
+ *        3. a field is "{}" or "{:[flags][width][.precision][type]}", flags and type are the same as printf(), "{{" and "}}" for '{' and '}':
+ *              integer (char, bool, enum): d i u x X o c, default d (c for char), printed with the size and sign of its own type
+ *              floating point: f F e E g G a A, default g
+ *              const char *, char[]: s p, default s
+ *              pointer: p
+ *           a different number of args, or an arg which doesn't match its type (eg {:s} for an int), is a compile error;
+ *        4. LOG_AST/ERR/WAR and printf() path: integers, chars, strings and pointers are converted inline,
+ *           only a float field calls snprintf() (SEGGER_RTT_snprintf() for LOG_SMALL_PRINTF) with its own spec built at compile time,
+ *           a message is cut to LOG_MSG_LEN, LOG_AST/ERR/WAR then end with "...\n";
+ *        5. LOG_DEFERRED: the record is packed with a layout known at compile time, and a printf() format with the exact length
+ *           of each arg is put in section "dbger_fmt" (or .rodata, if the compiler ignores the section of a template static),
+ *           host/dbger_decode finds it in both, so the text is rebuilt the same way as LOG_xxx().
+ *           the size of all args except strings is checked against LOG_DEFERRED_ARG_LEN at compile time;
+ *        6. the functions have internal linkage like dbger_module, so LOG level of the module is the one of the including file,
+ *           which defines it by DBGER_MODULE() like a C file.
+ *
+ * @author	shadowthreed@gmail.com
+ * @date	20261017
+ */
+#ifndef __DBGER_HPP__
+#define __DBGER_HPP__
+
+#include "dbger.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <type_traits>
+#include <utility>
+
+namespace dbg {
+
+// string literal as template argument: dbg::log<"...">()
+template<size_t N>
+struct fixed_string {
+	char str[N];
+	constexpr fixed_string(const char (&s)[N])
+	{
+		for(size_t i = 0; i < N; i++) {
+			str[i] = s[i];
+		}
+	}
+};
+
+namespace detail {
+
+enum : unsigned char { F_LEFT = 1, F_PLUS = 2, F_SPACE = 4, F_ZERO = 8, F_ALT = 16 };
+
+struct spec_t {
+	unsigned char flags;
+	char type;				// '\0': default of the arg type
+	short width;
+	short prec;				// -1: no precision
+};
+
+// the format without "{...}", fields are kept apart by their position in text
+template<size_t N>
+struct parsed_t {
+	char text[N];			// "{{" and "}}" are unescaped
+	size_t text_len;
+	size_t num;
+	size_t pos[N];
+	spec_t spec[N];
+	bool bad;
+};
+
+constexpr bool is_digit(char c)
+{
+	return c >= '0' && c <= '9';
+}
+
+template<size_t N>
+constexpr parsed_t<N> parse(const char (&s)[N])
+{
+	parsed_t<N> p{};
+	size_t i = 0;
+
+	while(i < N - 1) {
+		spec_t f = { 0, '\0', 0, -1 };
+
+		if(s[i] == '}' || (s[i] == '{' && s[i + 1] == '{')) {
+			if(s[i] == '}' && s[i + 1] != '}') {
+				p.bad = true;
+				return p;
+			}
+			p.text[p.text_len++] = s[i];
+			i += 2;
+			continue;
+		}
+		if(s[i] != '{') {
+			p.text[p.text_len++] = s[i++];
+			continue;
+		}
+		if(s[++i] == ':') {
+			for(i++; ; i++) {
+				if(s[i] == '-') f.flags |= F_LEFT;
+				else if(s[i] == '+') f.flags |= F_PLUS;
+				else if(s[i] == ' ') f.flags |= F_SPACE;
+				else if(s[i] == '0') f.flags |= F_ZERO;
+				else if(s[i] == '#') f.flags |= F_ALT;
+				else break;
+			}
+			while(is_digit(s[i])) {
+				f.width = (short)(f.width * 10 + (s[i++] - '0'));
+			}
+			if(s[i] == '.') {
+				f.prec = 0;
+				while(is_digit(s[++i])) {
+					f.prec = (short)(f.prec * 10 + (s[i] - '0'));
+				}
+			}
+			if(s[i] != '}' && s[i] != '\0') {
+				f.type = s[i++];
+			}
+		}
+		if(s[i] != '}') {
+			p.bad = true;
+			return p;
+		}
+		i++;
+		p.pos[p.num] = p.text_len;
+		p.spec[p.num++] = f;
+	}
+	return p;
+}
+
+template<fixed_string Fmt>
+inline constexpr auto parsed = parse(Fmt.str);
+
+enum kind_t : unsigned char { K_NONE, K_INT, K_FLOAT, K_STR, K_PTR };
+
+struct arg_t {
+	kind_t kind;
+	unsigned char size;
+	bool is_signed;
+	bool is_char;
+};
+
+template<typename T>
+consteval arg_t arg_of()
+{
+	using U = std::remove_cv_t<std::decay_t<T>>;
+
+	if constexpr(std::is_enum_v<U>) {
+		return arg_of<std::underlying_type_t<U>>();
+	} else if constexpr(std::is_integral_v<U>) {
+		return { K_INT, (unsigned char)sizeof(U), std::is_signed_v<U> && !std::is_same_v<U, bool>, std::is_same_v<U, char> };
+	} else if constexpr(std::is_floating_point_v<U>) {
+		return { K_FLOAT, 8, true, false };
+	} else if constexpr(std::is_same_v<U, char *> || std::is_same_v<U, const char *>) {
+		return { K_STR, (unsigned char)sizeof(void *), false, false };
+	} else if constexpr(std::is_pointer_v<U> || std::is_null_pointer_v<U>) {
+		return { K_PTR, (unsigned char)sizeof(void *), false, false };
+	} else {
+		return { K_NONE, 0, false, false };
+	}
+}
+
+// enum is printed as its underlying type, bool as 0 or 1
+template<typename T, bool = std::is_enum_v<T>>
+struct int_of {
+	using type = T;
+};
+template<typename T>
+struct int_of<T, true> {
+	using type = std::underlying_type_t<T>;
+};
+template<>
+struct int_of<bool, false> {
+	using type = unsigned char;
+};
+
+// the conversion char of a field
+consteval char conv_of(arg_t a, spec_t s)
+{
+	if(s.type != '\0') {
+		return s.type;
+	}
+	switch(a.kind) {
+	case K_INT:		return a.is_char ? 'c' : 'd';
+	case K_FLOAT:	return 'g';
+	case K_STR:		return 's';
+	case K_PTR:		return 'p';
+	default:		return '\0';
+	}
+}
+
+consteval bool is_valid(arg_t a, spec_t s)
+{
+	const char c = conv_of(a, s);
+
+	switch(a.kind) {
+	case K_INT:
+		return c == 'd' || c == 'i' || c == 'u' || c == 'x' || c == 'X' || c == 'o' || c == 'c';
+	case K_FLOAT:
+		return c == 'f' || c == 'F' || c == 'e' || c == 'E' || c == 'g' || c == 'G' || c == 'a' || c == 'A';
+	case K_STR:
+		return c == 's' || c == 'p';
+	case K_PTR:
+		return c == 'p';
+	default:
+		return false;
+	}
+}
+
+template<fixed_string Fmt, typename... Args>
+consteval bool is_valid_args()
+{
+	constexpr auto &p = parsed<Fmt>;
+	const arg_t a[] = { arg_of<Args>()..., arg_t{} };
+
+	if(p.bad || p.num != sizeof...(Args)) {
+		return true;			// reported by its own static_assert
+	}
+	for(size_t i = 0; i < p.num; i++) {
+		if(!is_valid(a[i], p.spec[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+template<fixed_string Fmt, typename... Args>
+constexpr void check()
+{
+	static_assert(!parsed<Fmt>.bad, "dbg: unmatched '{' or '}' in format string");
+	static_assert(parsed<Fmt>.bad || parsed<Fmt>.num == sizeof...(Args), "dbg: number of args doesn't match the fields in format string");
+	static_assert(is_valid_args<Fmt, Args...>(), "dbg: arg type doesn't match its field, eg {:s} for an integer");
+}
+
+template<size_t L>
+struct str_t {
+	char str[L];
+};
+
+consteval size_t put_num(char *dst, size_t n, unsigned v)
+{
+	unsigned w = 1;
+
+	while(v / w >= 10) {
+		w *= 10;
+	}
+	for(; w; w /= 10, n++) {
+		if(dst) dst[n] = (char)('0' + v / w % 10);
+	}
+	return n;
+}
+
+// printf() spec of a field, dst == nullptr to get the length only
+consteval size_t put_spec(char *dst, spec_t s, const char *len_mod, char conv)
+{
+	const char flag[] = { '-', '+', ' ', '0', '#' };
+	size_t n = 0;
+
+	if(dst) dst[n] = '%';
+	n++;
+	for(unsigned i = 0; i < sizeof(flag); i++) {
+		if(s.flags & (1u << i)) {
+			if(dst) dst[n] = flag[i];
+			n++;
+		}
+	}
+	if(s.width) {
+		n = put_num(dst, n, (unsigned)s.width);
+	}
+	if(s.prec >= 0) {
+		if(dst) dst[n] = '.';
+		n = put_num(dst, n + 1, (unsigned)s.prec);
+	}
+	for(; *len_mod; len_mod++, n++) {
+		if(dst) dst[n] = *len_mod;
+	}
+	if(dst) dst[n] = conv;
+	return n + 1;
+}
+
+template<spec_t S, char C>
+consteval str_t<put_spec(nullptr, S, "", C) + 1> float_spec()
+{
+	str_t<put_spec(nullptr, S, "", C) + 1> r{};
+	put_spec(r.str, S, "", C);
+	return r;
+}
+
+// the message is formatted on stack, then written at once like dbger_log()
+struct out_t {
+	char *p;
+	char *end;				// one more byte after end for the '\0' of snprintf()
+
+	void put(char c)
+	{
+		if(p < end) {
+			*p++ = c;
+		}
+	}
+	void text(const char *s, size_t n)
+	{
+		if(n > (size_t)(end - p)) {
+			n = (size_t)(end - p);
+		}
+		memcpy(p, s, n);
+		p += n;
+	}
+	void fill(char c, size_t n)
+	{
+		if(n > (size_t)(end - p)) {
+			n = (size_t)(end - p);
+		}
+		memset(p, c, n);
+		p += n;
+	}
+};
+
+// width is filled around the len chars written by put()
+template<spec_t S, typename F>
+inline void pad(out_t &o, size_t len, F put)
+{
+	const size_t n = ((size_t)S.width > len) ? (size_t)S.width - len : 0;
+
+	if(!(S.flags & F_LEFT)) {
+		o.fill(' ', n);
+	}
+	put();
+	if(S.flags & F_LEFT) {
+		o.fill(' ', n);
+	}
+}
+
+template<spec_t S, char C, typename U>
+inline void put_int(out_t &o, U v, char sign)
+{
+	constexpr unsigned base = (C == 'x' || C == 'X') ? 16 : (C == 'o') ? 8 : 10;
+	constexpr bool zero_pad = (S.flags & F_ZERO) && !(S.flags & F_LEFT) && S.prec < 0;
+	const char *hex = (C == 'X') ? "0123456789ABCDEF" : "0123456789abcdef";
+	char digit[sizeof(U) * 3];
+	char prefix[3];
+	size_t n = 0, pre = 0, zeros = 0, len, space;
+
+	if(sign) {
+		prefix[pre++] = sign;
+	}
+	if((S.flags & F_ALT) && base == 16 && v) {
+		prefix[pre++] = '0';
+		prefix[pre++] = C;
+	}
+	for(; v; v /= base) {
+		digit[n++] = hex[v % base];
+	}
+	if(S.prec >= 0) {
+		zeros = ((size_t)S.prec > n) ? (size_t)S.prec - n : 0;
+	} else if(n == 0) {
+		zeros = 1;
+	}
+	if((S.flags & F_ALT) && base == 8 && zeros == 0) {
+		zeros = 1;
+	}
+	len = pre + zeros + n;
+	space = ((size_t)S.width > len) ? (size_t)S.width - len : 0;
+	if(!(S.flags & F_LEFT) && !zero_pad) {
+		o.fill(' ', space);
+	}
+	o.text(prefix, pre);
+	if(zero_pad) {
+		o.fill('0', space);
+	}
+	o.fill('0', zeros);
+	while(n && o.p < o.end) {
+		*o.p++ = digit[--n];
+	}
+	if(S.flags & F_LEFT) {
+		o.fill(' ', space);
+	}
+}
+
+template<spec_t S>
+inline void put_str(out_t &o, const char *s)
+{
+	size_t n = 0;
+
+	if(s == nullptr) {
+		s = "(null)";
+	}
+	while(s[n] && (S.prec < 0 || n < (size_t)S.prec)) {
+		n++;
+	}
+	pad<S>(o, n, [&] { o.text(s, n); });
+}
+
+template<spec_t S>
+inline void put_ptr(out_t &o, const void *ptr)
+{
+	uintptr_t v = (uintptr_t)ptr;
+	char buf[2 + sizeof(v) * 2];
+
+	buf[0] = '0';
+	buf[1] = 'x';
+	for(size_t i = sizeof(buf) - 1; i >= 2; i--, v >>= 4) {
+		buf[i] = "0123456789abcdef"[v & 0xF];
+	}
+	pad<S>(o, sizeof(buf), [&] { o.text(buf, sizeof(buf)); });
+}
+
+template<spec_t S, char C>
+inline void put_float(out_t &o, double v)
+{
+	static constexpr auto spec = float_spec<S, C>();
+#if LOG_SMALL_PRINTF
+	constexpr bool small = (C != 'a' && C != 'A' && !(S.flags & F_SPACE));		// not supported by SEGGER_RTT_printf.c
+	int n = small ? SEGGER_RTT_snprintf(o.p, (unsigned)(o.end - o.p) + 1, spec.str, v) : snprintf(o.p, (size_t)(o.end - o.p) + 1, spec.str, v);
+#else
+	int n = snprintf(o.p, (size_t)(o.end - o.p) + 1, spec.str, v);
+#endif
+
+	if(n > 0) {
+		o.p += ((size_t)n < (size_t)(o.end - o.p)) ? (size_t)n : (size_t)(o.end - o.p);
+	}
+}
+
+template<spec_t S, typename T>
+inline void put(out_t &o, const T &v)
+{
+	constexpr arg_t a = arg_of<T>();
+	constexpr char c = conv_of(a, S);
+
+	if constexpr(c == 's') {
+		put_str<S>(o, v);
+	} else if constexpr(c == 'p') {
+		put_ptr<S>(o, (const void *)v);
+	} else if constexpr(a.kind == K_FLOAT) {
+		put_float<S, c>(o, (double)v);
+	} else if constexpr(c == 'c') {
+		pad<S>(o, 1, [&] { o.put((char)v); });
+	} else {
+		using I = typename int_of<std::remove_cv_t<T>>::type;
+		using U = std::conditional_t<(sizeof(I) > 4), uint64_t, uint32_t>;
+		const I i = static_cast<I>(v);
+
+		if constexpr(a.is_signed && (c == 'd' || c == 'i')) {
+			const char sign = (i < 0) ? '-' : (S.flags & F_PLUS) ? '+' : (S.flags & F_SPACE) ? ' ' : '\0';
+			put_int<S, c, U>(o, (i < 0) ? (U)0 - (U)i : (U)i, sign);
+		} else {
+			put_int<S, c, U>(o, (U)(std::make_unsigned_t<I>)i, '\0');		// hex of the type's own size, eg int8_t -1 is "ff"
+		}
+	}
+}
+
+template<fixed_string Fmt, typename... Args, size_t... I>
+inline void format(out_t &o, std::index_sequence<I...>, const Args &...args)
+{
+	constexpr auto &p = parsed<Fmt>;
+
+	((o.text(p.text + (I ? p.pos[I - 1] : 0), p.pos[I] - (I ? p.pos[I - 1] : 0)), put<p.spec[I]>(o, args)), ...);
+	if constexpr(sizeof...(I) == 0) {
+		o.text(p.text, p.text_len);
+	} else {
+		o.text(p.text + p.pos[sizeof...(I) - 1], p.text_len - p.pos[sizeof...(I) - 1]);
+	}
+}
+
+// returns the length of the message
+template<fixed_string Fmt, typename... Args>
+inline unsigned format(char *buf, size_t size, const Args &...args)
+{
+	out_t o = { buf, buf + size - 1 };
+
+	format<Fmt>(o, std::index_sequence_for<Args...>{}, args...);
+	return (unsigned)(o.p - buf);
+}
+
+#if LOG_ENABLE && LOG_BY_RTT && LOG_DEFERRED
+
+// bytes of an arg in the record, the same rules as dbger_deferred(), strings take 1 for the '\0'
+consteval unsigned rec_size(arg_t a, char c)
+{
+	if(c == 's') return 1;
+	if(c == 'p') return sizeof(uintptr_t);
+	if(a.kind == K_FLOAT) return 8;
+	return (a.size > 4) ? 8 : 4;
+}
+
+// printf() format for host/dbger_decode, dst == nullptr to get the length only
+template<fixed_string Fmt, typename... Args>
+consteval size_t put_deferred_fmt(char *dst)
+{
+	constexpr auto &p = parsed<Fmt>;
+	const arg_t a[] = { arg_of<Args>()..., arg_t{} };
+	size_t n = 0, t = 0;
+
+	for(size_t i = 0; i <= p.num; i++) {
+		for(size_t end = (i < p.num) ? p.pos[i] : p.text_len; t < end; t++) {
+			if(p.text[t] == '%') {
+				if(dst) dst[n] = '%';
+				n++;
+			}
+			if(dst) dst[n] = p.text[t];
+			n++;
+		}
+		if(i < p.num) {
+			char c = conv_of(a[i], p.spec[i]);
+			const char *len_mod = (a[i].kind == K_INT && c != 'c' && a[i].size > 4) ? "ll" : "";
+			if(a[i].kind == K_INT && !a[i].is_signed && (c == 'd' || c == 'i')) {
+				c = 'u';				// the host only knows the size of arg
+			}
+			n += put_spec(dst ? dst + n : nullptr, p.spec[i], len_mod, c);
+		}
+	}
+	return n;
+}
+
+template<fixed_string Fmt, typename... Args>
+consteval str_t<put_deferred_fmt<Fmt, Args...>(nullptr) + 1> deferred_fmt()
+{
+	str_t<put_deferred_fmt<Fmt, Args...>(nullptr) + 1> r{};
+	put_deferred_fmt<Fmt, Args...>(r.str);
+	return r;
+}
+
+template<fixed_string Fmt, typename... Args>
+consteval unsigned deferred_min_len()
+{
+	constexpr auto &p = parsed<Fmt>;
+	const arg_t a[] = { arg_of<Args>()..., arg_t{} };
+	unsigned n = 0;
+
+	for(size_t i = 0; i < p.num; i++) {
+		n += rec_size(a[i], conv_of(a[i], p.spec[i]));
+	}
+	return n;
+}
+
+struct rec_t {
+	uint8_t *p;
+	uint8_t *end;
+	bool full;				// an arg didn't fit, the rest are dropped like dbger_deferred()
+
+	void put(uint64_t v, unsigned n)
+	{
+		if(full || p + n > end) {
+			full = true;
+			return;
+		}
+		for(unsigned i = 0; i < n; i++, v >>= 8) {
+			*p++ = (uint8_t)v;
+		}
+	}
+};
+
+template<spec_t S, typename T>
+inline void pack(rec_t &r, const T &v)
+{
+	constexpr arg_t a = arg_of<T>();
+	constexpr char c = conv_of(a, S);
+
+	if constexpr(c == 's') {
+		const char *s = v;
+		if(s == nullptr) {
+			s = "(null)";
+		}
+		if(r.full || r.p >= r.end) {
+			r.full = true;
+			return;
+		}
+		while(*s && r.p < r.end - 1) {
+			*r.p++ = (uint8_t)*s++;
+		}
+		*r.p++ = '\0';
+	} else if constexpr(c == 'p') {
+		r.put((uintptr_t)(const void *)v, sizeof(uintptr_t));
+	} else if constexpr(a.kind == K_FLOAT) {
+		double d = (double)v;
+		uint64_t u;
+		memcpy(&u, &d, 8);
+		r.put(u, 8);
+	} else {
+		using I = typename int_of<std::remove_cv_t<T>>::type;
+		const I i = static_cast<I>(v);
+
+		if constexpr(a.is_signed && (c == 'd' || c == 'i')) {
+			r.put((uint64_t)(int64_t)i, (sizeof(I) > 4) ? 8 : 4);		// sign extended, decoded by "%d" or "%lld"
+		} else {
+			r.put((uint64_t)(std::make_unsigned_t<I>)i, (sizeof(I) > 4) ? 8 : 4);
+		}
+	}
+}
+
+template<fixed_string Fmt, typename... Args, size_t... I>
+inline void defer(std::index_sequence<I...>, const Args &...args)
+{
+	static_assert(deferred_min_len<Fmt, Args...>() <= LOG_DEFERRED_ARG_LEN, "dbg: args don't fit in LOG_DEFERRED_ARG_LEN");
+	// only referenced by address like DBGER_DEFER(), GCC (12 at least) ignores the section of a static in template, then it's in .rodata
+	static const auto fmt __attribute__((section("dbger_fmt"))) = deferred_fmt<Fmt, Args...>();
+	constexpr auto &p = parsed<Fmt>;
+	uint8_t arg[LOG_DEFERRED_ARG_LEN];
+	rec_t r = { arg, arg + sizeof(arg), false };
+
+	(pack<p.spec[I]>(r, args), ...);
+	dbger_record(fmt.str, arg, (unsigned)(r.p - arg));
+}
+
+#endif  // LOG_DEFERRED
+
+// level n: LOG_AST/ERR/WAR (to terminal 0) for n <= 3, printf() for others
+template<unsigned char N, fixed_string Fmt, typename... Args>
+inline void write(const Args &...args)
+{
+#if LOG_ENABLE && LOG_BY_RTT && LOG_DEFERRED
+	defer<Fmt>(std::index_sequence_for<Args...>{}, args...);
+#elif LOG_ENABLE
+	char msg[LOG_MSG_LEN + 2];		// one more, so a cut message is longer than LOG_MSG_LEN
+	unsigned len = format<Fmt>(msg, sizeof(msg), args...);
+
+	if constexpr(N <= 3) {
+		dbger_log_str(msg, len);
+	} else {
+		dbger_print(msg, (len > LOG_MSG_LEN) ? LOG_MSG_LEN : len);
+	}
+#else
+	((void)args, ...);
+#endif
+}
+
+}  // namespace detail
+
+namespace {		// LOG_ON() reads dbger_module of the including file
+
+#define DBGER_HPP_LEVEL(name, n)											\
+	template<fixed_string Fmt, typename... Args>							\
+	inline void name(const Args &...args)									\
+	{																		\
+		detail::check<Fmt, Args...>();										\
+		if constexpr(LOG_ENABLE && LOG_LEVEL >= (n)) {						\
+			if(LOG_ON(n)) {													\
+				detail::write<(n), Fmt>(args...);							\
+			}																\
+		}																	\
+	}
+
+DBGER_HPP_LEVEL(ast, 1)
+DBGER_HPP_LEVEL(err, 2)
+DBGER_HPP_LEVEL(war, 3)
+DBGER_HPP_LEVEL(inf, 4)
+DBGER_HPP_LEVEL(log, 4)
+DBGER_HPP_LEVEL(dbg, 5)
+DBGER_HPP_LEVEL(vbs, 6)
+
+#undef DBGER_HPP_LEVEL
+
+}  // namespace
+
+}  // namespace dbg
+
+#if LOG_ENABLE
+#ifndef DBGER_STR
+	#define _DBGER_STR(x)	#x
+	#define DBGER_STR(x)	_DBGER_STR(x)
+#endif
+// the prefix is joined to the format by the preprocessor, so it costs nothing at runtime
+#define DBG_AST(fmt, ...)	dbg::ast<COLOR_RED		"[AST:" DBGER_FILE ":" DBGER_STR(__LINE__) "] " fmt COLOR_DEFAULT>(__VA_ARGS__)
+#define DBG_ERR(fmt, ...)	dbg::err<COLOR_PINK		"[ERR:" DBGER_FILE ":" DBGER_STR(__LINE__) "] " fmt COLOR_DEFAULT>(__VA_ARGS__)
+#define DBG_WAR(fmt, ...)	dbg::war<COLOR_YELLOW	"[WAR:" DBGER_FILE ":" DBGER_STR(__LINE__) "] " fmt COLOR_DEFAULT>(__VA_ARGS__)
+#else
+#define DBG_AST(fmt, ...)	dbg::ast<fmt>(__VA_ARGS__)		// args are still checked
+#define DBG_ERR(fmt, ...)	dbg::err<fmt>(__VA_ARGS__)
+#define DBG_WAR(fmt, ...)	dbg::war<fmt>(__VA_ARGS__)
+#endif
+
+#endif // __DBGER_HPP__
@@ -0,0 +1,692 @@
+/**
+ * @file	dbger_decode.c
+ * @brief	Host tool. Rebuild the text of deferred LOG (LOG_DEFERRED = 1) from the binary records and the firmware ELF.
+ *			The records are decoded by a thread on each core, in pieces of the channel, and printed in order.
+ *
+ * @note HOW TO USE:
+ *        1. build: gcc -O2 -pthread -o dbger_decode dbger_decode.c
+ *        2. log the RTT channel LOG_DEFERRED_CHANNEL into a file, eg: JLinkRTTLogger -RTTChannel 2 channel.bin,
+ *           or capture all channels with host/rtt_capture
+ *        3. ./dbger_decode [-t] [-f hz] [-j threads] [-c chan] firmware.elf channel.bin|capture.cap
+ *              -t         print the timestamp of each record, with LOG_TIME the ticks since the first record
+ *              -f hz      print the time in seconds, the ticks per second of LOG_TIME_HZ() (LOG_TIME only)
+ *              -j threads threads which decode (Default: the cores), the text is the same for any number
+ *              -c chan    channel of a capture of host/rtt_capture (Default: 2, LOG_DEFERRED_CHANNEL)
+ *
+ * @author	shadowthreed@gmail.com
+ * @date	20261017
+ */
+#include <elf.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdio_ext.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define DBGER_SYNC		0xDB
+#define DBGER_HEAD_LEN	10
+#define DBGER_SYNC_TIME	0xDA		// LOG_TIME: the timestamp is a varint of the time since the last record
+#define DBGER_FIX_LEN	6			// sync + arg len + fmt id
+
+#define MAX_SECT		64
+
+// capture file, as written by host/rtt_capture.c
+#define CAP_MAGIC		0x50414352u		// "RCAP"
+#define CAP_ALIGN		8u
+
+typedef struct {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t head_len;
+	uint32_t num_up;
+	uint64_t start_ns;
+	uint64_t end;
+	uint32_t done;
+	uint32_t res;
+} cap_head_t;
+
+typedef struct {
+	uint64_t t_ns;
+	uint32_t len;
+	uint8_t chan;
+	uint8_t term;
+	uint8_t res[2];
+} cap_chunk_t;
+
+typedef struct {
+	const char *data;
+	uint64_t addr;
+	uint64_t size;
+} sect_t;
+
+typedef struct {
+	sect_t sect[MAX_SECT];	// allocated sections with content, the format is in "dbger_fmt", or in .rodata if the compiler ignored its section (dbger.hpp)
+	unsigned num;
+	uint64_t base;			// address of section "dbger_fmt"
+	int is_64;				// ELF64: format id is the offset to "dbger_fmt" (LOG_PLATFORM 1), ELF32: format id is the address
+} fmt_table_t;
+
+static char *load_file(const char *path, size_t *len)
+{
+	FILE *f = fopen(path, "rb");
+	char *buf;
+	long n;
+
+	if(f == NULL) {
+		return NULL;
+	}
+	fseek(f, 0, SEEK_END);
+	n = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	buf = malloc(n > 0 ? n : 1);
+	if(buf && fread(buf, 1, n, f) != (size_t)n) {
+		free(buf);
+		buf = NULL;
+	}
+	fclose(f);
+	*len = (size_t)n;
+	return buf;
+}
+
+static void add_sect(fmt_table_t *t, const char *elf, const char *name, uint64_t type, uint64_t flags, uint64_t addr, uint64_t off, uint64_t size)
+{
+	if(strcmp(name, "dbger_fmt") == 0) {
+		t->base = addr;
+	}
+	if(type != SHT_PROGBITS || !(flags & SHF_ALLOC) || t->num >= MAX_SECT) {
+		return;
+	}
+	t->sect[t->num].data = elf + off;
+	t->sect[t->num].addr = addr;
+	t->sect[t->num].size = size;
+	t->num++;
+}
+
+static int load_fmt_table(fmt_table_t *t, const char *elf, size_t len)
+{
+	if(len < EI_NIDENT || memcmp(elf, ELFMAG, SELFMAG) != 0) {
+		return -1;
+	}
+	t->num = 0;
+	t->base = 0;
+	t->is_64 = (elf[EI_CLASS] == ELFCLASS64);
+	if(t->is_64) {
+		const Elf64_Ehdr *eh = (const Elf64_Ehdr *)elf;
+		const Elf64_Shdr *sh = (const Elf64_Shdr *)(elf + eh->e_shoff);
+		const char *names = elf + sh[eh->e_shstrndx].sh_offset;
+		for(unsigned i = 0; i < eh->e_shnum; i++) {
+			add_sect(t, elf, names + sh[i].sh_name, sh[i].sh_type, sh[i].sh_flags, sh[i].sh_addr, sh[i].sh_offset, sh[i].sh_size);
+		}
+	} else {
+		const Elf32_Ehdr *eh = (const Elf32_Ehdr *)elf;
+		const Elf32_Shdr *sh = (const Elf32_Shdr *)(elf + eh->e_shoff);
+		const char *names = elf + sh[eh->e_shstrndx].sh_offset;
+		for(unsigned i = 0; i < eh->e_shnum; i++) {
+			add_sect(t, elf, names + sh[i].sh_name, sh[i].sh_type, sh[i].sh_flags, sh[i].sh_addr, sh[i].sh_offset, sh[i].sh_size);
+		}
+	}
+	return t->num ? 0 : -1;
+}
+
+static const char *lookup_fmt(const fmt_table_t *t, uint32_t id)
+{
+	uint64_t addr = t->is_64 ? t->base + (uint64_t)(int64_t)(int32_t)id : id;		// the offset is negative for .rodata before "dbger_fmt"
+
+	for(unsigned i = 0; i < t->num; i++) {
+		if(addr >= t->sect[i].addr && addr - t->sect[i].addr < t->sect[i].size) {
+			return t->sect[i].data + (addr - t->sect[i].addr);
+		}
+	}
+	return NULL;
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// varint of LOG_TIME, return its length, 0 if it does not end before <end>
+static unsigned get_var(const uint8_t *p, const uint8_t *end, uint64_t *v)
+{
+	unsigned n = 0, shift = 0;
+
+	*v = 0;
+	while(p + n < end && shift < 64) {
+		*v |= (uint64_t)(p[n] & 0x7Fu) << shift;
+		if((p[n++] & 0x80u) == 0) {
+			return n;
+		}
+		shift += 7;
+	}
+	return 0;
+}
+
+static uint64_t get64(const uint8_t *p)
+{
+	return (uint64_t)get32(p) | ((uint64_t)get32(p + 4) << 32);
+}
+
+// fprintf() of one conversion with the values of its '*' (width and precision) in front of the arg
+#define PRINT_SPEC(out, spec, nstar, star, v)	\
+	((nstar) == 2 ? fprintf(out, spec, (star)[0], (star)[1], v) : (nstar) == 1 ? fprintf(out, spec, (star)[0], v) : fprintf(out, spec, v))
+
+/**
+ * @brief	print one record, args are taken by the same rules as dbger_deferred().
+ */
+static void print_record(FILE *out, const fmt_table_t *t, const char *fmt, const uint8_t *arg, unsigned arg_len)
+{
+	const uint8_t *end = arg + arg_len;
+	unsigned long_len = t->is_64 ? 8 : 4;		// sizeof(long), sizeof(size_t) and sizeof(void *) of target
+	char spec[32];
+	const char *s;
+
+	for(s = fmt; *s; s++) {
+		const char *start;
+		unsigned n, len = 0, nstar = 0;
+		int star[2];
+
+		if(*s != '%') {
+			fputc(*s, out);
+			continue;
+		}
+		start = s++;
+		while(*s == '-' || *s == '+' || *s == ' ' || *s == '#' || *s == '0') s++;
+		while((*s >= '0' && *s <= '9') || *s == '.' || *s == '*') {
+			if(*s == '*') {
+				if(arg + 4 > end || nstar == 2) return;
+				star[nstar++] = (int32_t)get32(arg);
+				arg += 4;
+			}
+			s++;
+		}
+		n = (unsigned)(s - start);
+		while(*s == 'l' || *s == 'h' || *s == 'z' || *s == 'j' || *s == 't' || *s == 'L') {
+			if(*s == 'l') len++;
+			if(*s == 'j' || ((*s == 'z' || *s == 't') && long_len == 8)) len = 2;
+			s++;
+		}
+		if(*s == '\0' || n + 4 > sizeof(spec)) {
+			break;
+		}
+		memcpy(spec, start, n);			// flags, width, precision, the length modifier is rebuilt for host types
+		switch(*s) {
+		case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+			if(len >= 2 || (len == 1 && long_len == 8)) {
+				if(arg + 8 > end) return;
+				memcpy(spec + n, "ll", 2);
+				spec[n + 2] = *s;
+				spec[n + 3] = '\0';
+				if(*s == 'd' || *s == 'i') {
+					PRINT_SPEC(out, spec, nstar, star, (long long)get64(arg));
+				} else {
+					PRINT_SPEC(out, spec, nstar, star, (unsigned long long)get64(arg));
+				}
+				arg += 8;
+			} else {
+				if(arg + 4 > end) return;
+				spec[n] = *s;
+				spec[n + 1] = '\0';
+				PRINT_SPEC(out, spec, nstar, star, get32(arg));
+				arg += 4;
+			}
+			break;
+		case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A': {
+			double v;
+			if(arg + 8 > end) return;
+			memcpy(&v, arg, 8);
+			spec[n] = *s;
+			spec[n + 1] = '\0';
+			PRINT_SPEC(out, spec, nstar, star, v);
+			arg += 8;
+			break;
+		}
+		case 'p':
+			if(arg + long_len > end) return;
+			fprintf(out, "0x%0*llx", (int)long_len * 2, (unsigned long long)(long_len == 8 ? get64(arg) : get32(arg)));
+			arg += long_len;
+			break;
+		case 's': {
+			const uint8_t *str = arg;
+			while(arg < end && *arg) arg++;
+			if(arg >= end) return;
+			arg++;
+			spec[n] = 's';
+			spec[n + 1] = '\0';
+			PRINT_SPEC(out, spec, nstar, star, (const char *)str);
+			break;
+		}
+		case '%':
+			fputc('%', out);
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+/**
+ * @brief	one step of the walk over the records: a record at <pos>, or the walk goes on at the next byte (lost sync).
+ *			The walk from a position is always the same, so walks from two positions are the same once they meet.
+ * @return	length of the record, 0: no record
+ */
+static unsigned record_at(const fmt_table_t *t, const uint8_t *buf, size_t len, size_t pos, unsigned *head, uint64_t *v, const char **fmt)
+{
+	unsigned arg_len;
+
+	if(buf[pos] == DBGER_SYNC) {
+		*head = DBGER_HEAD_LEN;
+	} else if(buf[pos] == DBGER_SYNC_TIME) {
+		*head = get_var(buf + pos + DBGER_FIX_LEN, buf + len, v);
+		*head = *head ? DBGER_FIX_LEN + *head : 0;
+	} else {
+		return 0;
+	}
+	if(*head == 0) {
+		return 0;
+	}
+	arg_len = buf[pos + 1];
+	*fmt = lookup_fmt(t, get32(buf + pos + 2));
+	if(*fmt == NULL || pos + *head + arg_len > len) {
+		return 0;
+	}
+	return *head + arg_len;
+}
+
+// LOG_TIME over a run of records: abs ? ts = v : ts += v
+typedef struct {
+	int abs;
+	uint64_t v;
+	size_t num;				// records with LOG_TIME
+} time_fn_t;
+
+static void time_add(time_fn_t *fn, uint64_t v)
+{
+	fn->num++;
+	if(v & 1u) {
+		fn->abs = 1;
+		fn->v = v >> 1;
+	} else {
+		fn->v += v >> 1;
+	}
+}
+
+// first <a>, then <b>
+static time_fn_t time_then(time_fn_t a, time_fn_t b)
+{
+	if(!b.abs) {
+		b.abs = a.abs;
+		b.v += a.v;
+	}
+	b.num += a.num;
+	return b;
+}
+
+/**
+ * @brief	walk from <pos> until the first position >= <limit>, only LOG_TIME is taken from the records
+ * @param	fn			LOG_TIME of the records walked over
+ * @param	first		stop after the first record with LOG_TIME
+ * @return	the position where the walk stopped
+ */
+static size_t walk(const fmt_table_t *t, const uint8_t *buf, size_t len, size_t pos, size_t limit, time_fn_t *fn, int first)
+{
+	unsigned n, head;
+	uint64_t v;
+	const char *fmt;
+
+	memset(fn, 0, sizeof(*fn));
+	while(pos < limit && pos + DBGER_FIX_LEN < len) {
+		n = record_at(t, buf, len, pos, &head, &v, &fmt);
+		if(n == 0) {
+			pos++;
+			continue;
+		}
+		if(buf[pos] == DBGER_SYNC_TIME) {
+			time_add(fn, v);
+			if(first) {
+				return pos + n;
+			}
+		}
+		pos += n;
+	}
+	return pos;
+}
+
+/**
+ * @brief	decode the records from <pos> until the first position >= <limit>, bytes which are not a valid record are skipped.
+ *			LOG_TIME: bit 0 of the time is set for an absolute time, else it's the delta to the last record.
+ * @param	ts			LOG_TIME at <pos>
+ * @param	t0			LOG_TIME of the first record with it, the times start there
+ * @param	show_ts		print the timestamp of each record
+ * @param	hz			> 0: print LOG_TIME in seconds
+ * @return	number of decoded records
+ */
+static size_t decode(FILE *out, const fmt_table_t *t, const uint8_t *buf, size_t len, size_t pos, size_t limit,
+					 uint64_t ts, uint64_t t0, int show_ts, double hz)
+{
+	size_t cnt = 0;
+
+	while(pos < limit && pos + DBGER_FIX_LEN < len) {
+		const char *fmt;
+		unsigned head, n;
+		uint64_t v = 0;
+
+		n = record_at(t, buf, len, pos, &head, &v, &fmt);
+		if(n == 0) {
+			pos++;				// lost sync, try next byte
+			continue;
+		}
+		if(buf[pos] == DBGER_SYNC_TIME) {
+			ts = (v & 1u) ? (v >> 1) : (ts + (v >> 1));
+			if(show_ts && hz > 0) {
+				fprintf(out, "[%12.6f] ", (ts - t0) / hz);
+			} else if(show_ts) {
+				fprintf(out, "[%12llu] ", (unsigned long long)(ts - t0));
+			}
+		} else if(show_ts) {
+			fprintf(out, "[%10u] ", (unsigned)get32(buf + pos + 6));
+		}
+		print_record(out, t, fmt, buf + pos + head, n - head);
+		pos += n;
+		cnt++;
+	}
+	return cnt;
+}
+
+/*********************************************************************
+*
+*       parallel decode
+*
+*  The channel is cut into pieces, each is walked by a thread from its start, which may be in the middle of a record.
+*  Then the walk coming from the piece before tells where it really starts, both walks are the same from where they meet,
+*  which is checked at DEC_MAX_REC after the start (else that piece is walked again). With the starts and LOG_TIME at
+*  each start known, the pieces are decoded by the threads into memory and written in order.
+*  A thread takes the next piece when it is done with one, so a slow piece does not hold up the others.
+*/
+#define DEC_MAX_REC		(DBGER_FIX_LEN + 10 + 255)		// head with the varint of 64 bits, max. args
+#define DEC_MIN_PIECE	(256u << 10)
+#define DEC_MAX_PIECE	(4u << 20)
+#define DEC_MAX_THREADS	256
+#define DEC_AHEAD		4				// pieces decoded ahead of the output for each thread
+
+typedef struct {
+	size_t start;			// first position: the cut, then where the walk from the piece before comes in
+	size_t limit;			// the cut of the next piece
+	size_t end;				// the first position >= <limit>, where the next piece really starts
+	size_t tail;			// the first position >= <start> + DEC_MAX_REC of the walk from the cut
+	time_fn_t tail_fn;		// LOG_TIME from <tail> to <end>
+	time_fn_t fn;			// LOG_TIME from <start> to <end>
+	uint64_t ts;			// LOG_TIME at <start>
+	char *text;				// decoded
+	size_t text_len;
+	int done;
+} piece_t;
+
+static struct {
+	const fmt_table_t *t;
+	const uint8_t *buf;
+	size_t len;
+	piece_t *pieces;
+	size_t num;
+	size_t next;			// next piece to take
+	size_t written;			// pieces written to the output
+	size_t ahead;
+	uint64_t t0;
+	int show_ts;
+	double hz;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+} dec = { .lock = PTHREAD_MUTEX_INITIALIZER, .cond = PTHREAD_COND_INITIALIZER };
+
+static void *walk_pieces(void *arg)
+{
+	size_t i;
+
+	(void)arg;
+	while((i = __atomic_fetch_add(&dec.next, 1, __ATOMIC_RELAXED)) < dec.num) {
+		piece_t *p = &dec.pieces[i];
+		time_fn_t fn;
+
+		p->tail = walk(dec.t, dec.buf, dec.len, p->start, p->start + DEC_MAX_REC, &fn, 0);
+		p->end = walk(dec.t, dec.buf, dec.len, p->tail, p->limit, &p->tail_fn, 0);
+	}
+	return NULL;
+}
+
+static void *decode_pieces(void *arg)
+{
+	size_t i;
+
+	(void)arg;
+	for(;;) {
+		piece_t *p;
+		FILE *out;
+
+		pthread_mutex_lock(&dec.lock);
+		while(dec.next < dec.num && dec.next >= dec.written + dec.ahead) {
+			pthread_cond_wait(&dec.cond, &dec.lock);		// the output is behind, the text would pile up in memory
+		}
+		i = dec.next++;
+		pthread_mutex_unlock(&dec.lock);
+		if(i >= dec.num) {
+			return NULL;
+		}
+		p = &dec.pieces[i];
+		out = open_memstream(&p->text, &p->text_len);
+		if(out) {
+			__fsetlocking(out, FSETLOCKING_BYCALLER);		// only this thread writes it, no lock for each character
+			decode(out, dec.t, dec.buf, dec.len, p->start, p->end, p->ts, dec.t0, dec.show_ts, dec.hz);
+			fclose(out);
+		}
+		pthread_mutex_lock(&dec.lock);
+		p->done = 1;
+		pthread_cond_broadcast(&dec.cond);
+		pthread_mutex_unlock(&dec.lock);
+	}
+}
+
+static int run(void *(*fn)(void *), unsigned threads)
+{
+	pthread_t th[DEC_MAX_THREADS];
+	unsigned i;
+
+	dec.next = 0;
+	for(i = 0; i < threads; i++) {
+		if(pthread_create(&th[i], NULL, fn, NULL) != 0) {
+			break;
+		}
+	}
+	if(i == 0) {
+		return -1;
+	}
+	threads = i;
+	if(fn == decode_pieces) {
+		//
+		// write the pieces in order as they are done
+		//
+		pthread_mutex_lock(&dec.lock);
+		while(dec.written < dec.num) {
+			piece_t *p = &dec.pieces[dec.written];
+
+			if(!p->done) {
+				pthread_cond_wait(&dec.cond, &dec.lock);
+				continue;
+			}
+			pthread_mutex_unlock(&dec.lock);
+			if(p->text == NULL) {
+				fprintf(stderr, "out of memory\n");
+				exit(1);
+			}
+			fwrite(p->text, 1, p->text_len, stdout);
+			free(p->text);
+			pthread_mutex_lock(&dec.lock);
+			dec.written++;
+			pthread_cond_broadcast(&dec.cond);
+		}
+		pthread_mutex_unlock(&dec.lock);
+	}
+	for(i = 0; i < threads; i++) {
+		pthread_join(th[i], NULL);
+	}
+	return 0;
+}
+
+static int decode_parallel(const fmt_table_t *t, const uint8_t *buf, size_t len, unsigned threads, int show_ts, double hz)
+{
+	size_t piece = len / ((size_t)threads * 16u), i;
+	uint64_t ts = 0;
+	int t0_found = 0;
+
+	if(piece < DEC_MIN_PIECE) {
+		piece = DEC_MIN_PIECE;
+	}
+	if(piece > DEC_MAX_PIECE) {
+		piece = DEC_MAX_PIECE;
+	}
+	dec.t = t;
+	dec.buf = buf;
+	dec.len = len;
+	dec.num = len ? (len + piece - 1) / piece : 0;
+	dec.ahead = (size_t)threads * DEC_AHEAD;
+	dec.show_ts = show_ts;
+	dec.hz = hz;
+	dec.pieces = calloc(dec.num ? dec.num : 1, sizeof(piece_t));
+	if(dec.pieces == NULL) {
+		return -1;
+	}
+	for(i = 0; i < dec.num; i++) {
+		dec.pieces[i].start = i * piece;
+		dec.pieces[i].limit = (i + 1 == dec.num) ? len : (i + 1) * piece;
+	}
+	if(run(walk_pieces, threads) != 0) {
+		return -1;
+	}
+	//
+	// where each piece really starts, LOG_TIME there, and the time of the first record with it
+	//
+	for(i = 0; i < dec.num; i++) {
+		piece_t *p = &dec.pieces[i];
+		size_t in = i ? dec.pieces[i - 1].end : 0;
+		time_fn_t head;
+
+		if(walk(t, buf, len, in, p->start + DEC_MAX_REC, &head, 0) == p->tail) {
+			p->fn = time_then(head, p->tail_fn);
+		} else {
+			p->end = walk(t, buf, len, in, p->limit, &p->fn, 0);			// the walks did not meet
+		}
+		p->start = in;
+		p->ts = ts;
+		if(!t0_found && p->fn.num) {
+			time_fn_t first;
+
+			walk(t, buf, len, p->start, p->end, &first, 1);
+			dec.t0 = first.abs ? first.v : ts + first.v;
+			t0_found = 1;
+		}
+		ts = p->fn.abs ? p->fn.v : ts + p->fn.v;
+	}
+	return run(decode_pieces, threads);
+}
+
+/*********************************************************************
+*
+*       channel
+*/
+// the data of RTT channel <chan> in a capture of host/rtt_capture, the chunks one after the other
+static uint8_t *cap_channel(const uint8_t *cap, size_t cap_len, unsigned chan, size_t *len)
+{
+	const cap_head_t *h = (const cap_head_t *)cap;
+	uint64_t pos = h->head_len, end = h->end < cap_len ? h->end : cap_len;
+	uint8_t *buf = malloc(cap_len);
+
+	*len = 0;
+	if(buf == NULL) {
+		return NULL;
+	}
+	while(pos + sizeof(cap_chunk_t) <= end) {
+		const cap_chunk_t *c = (const cap_chunk_t *)(cap + pos);
+
+		if(c->chan == chan && pos + sizeof(cap_chunk_t) + c->len <= end) {
+			memcpy(buf + *len, c + 1, c->len);
+			*len += c->len;
+		}
+		pos += sizeof(cap_chunk_t) + ((c->len + CAP_ALIGN - 1) & ~(CAP_ALIGN - 1));
+	}
+	return buf;
+}
+
+int main(int argc, char *argv[])
+{
+	fmt_table_t table;
+	size_t elf_len, bin_len = 0, len;
+	char *elf;
+	const uint8_t *bin, *data;
+	uint8_t *chan_data = NULL;
+	unsigned threads = (unsigned)sysconf(_SC_NPROCESSORS_ONLN), chan = 2;
+	int show_ts = 0, a, fd;
+	double hz = 0;
+	struct stat st;
+
+	for(a = 1; a < argc && argv[a][0] == '-'; a++) {
+		if(strcmp(argv[a], "-t") == 0) {
+			show_ts = 1;
+		} else if(strcmp(argv[a], "-f") == 0 && a + 1 < argc) {
+			hz = strtod(argv[++a], NULL);
+			show_ts = 1;
+		} else if(strcmp(argv[a], "-j") == 0 && a + 1 < argc) {
+			threads = (unsigned)strtoul(argv[++a], NULL, 0);
+		} else if(strcmp(argv[a], "-c") == 0 && a + 1 < argc) {
+			chan = (unsigned)strtoul(argv[++a], NULL, 0);
+		} else {
+			break;
+		}
+	}
+	if(argc - a != 2) {
+		fprintf(stderr, "usage: %s [-t] [-f hz] [-j threads] [-c chan] <firmware.elf> <channel.bin | capture.cap>\n", argv[0]);
+		return 1;
+	}
+	if(threads == 0) {
+		threads = 1;
+	}
+	if(threads > DEC_MAX_THREADS) {
+		threads = DEC_MAX_THREADS;
+	}
+	elf = load_file(argv[a], &elf_len);
+	if(elf == NULL || load_fmt_table(&table, elf, elf_len) != 0) {
+		fprintf(stderr, "no section with format in %s\n", argv[a]);
+		return 1;
+	}
+	fd = open(argv[a + 1], O_RDONLY);
+	if(fd < 0 || fstat(fd, &st) != 0) {
+		fprintf(stderr, "can't read %s\n", argv[a + 1]);
+		return 1;
+	}
+	bin_len = (size_t)st.st_size;
+	bin = bin_len ? mmap(NULL, bin_len, PROT_READ, MAP_PRIVATE, fd, 0) : (const uint8_t *)"";
+	close(fd);
+	if(bin == MAP_FAILED) {
+		fprintf(stderr, "can't read %s\n", argv[a + 1]);
+		return 1;
+	}
+	data = bin;
+	len = bin_len;
+	if(bin_len >= sizeof(cap_head_t) && ((const cap_head_t *)bin)->magic == CAP_MAGIC) {
+		chan_data = cap_channel(bin, bin_len, chan, &len);
+		if(chan_data == NULL) {
+			fprintf(stderr, "out of memory\n");
+			return 1;
+		}
+		data = chan_data;
+	}
+	if(decode_parallel(&table, data, len, threads, show_ts, hz) != 0) {
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+	free(chan_data);
+	free(elf);
+	return 0;
+}
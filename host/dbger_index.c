@@ -0,0 +1,702 @@
+/**
+ * @file	dbger_index.c
+ * @brief	Host tool. Index the LOG lines of channel 0 in a capture of host/rtt_capture, and query them without reading the capture again.
+ *			The index holds, for each line, the time it was read, its terminal, and level, file and line of its prefix
+ *			"[ERR:motor.c:120] " (LOG_AST/ERR/WAR, lines without a prefix have no level). A query maps the index,
+ *			finds the time range by binary search and only reads the lines it prints.
+ *			The lines are parsed by a thread for each part of the capture, the chunks are found by their heads first.
+ *
+ *			index file <capture>.idx: idx_head_t, idx_chunk_t for each chunk of channel 0 (sorted by time),
+ *			idx_line_t for each line (sorted by chunk), then the file names of IDX_FILE_LEN bytes each.
+ *
+ * @note HOW TO USE:
+ *        1. build: gcc -O2 -pthread -o dbger_index dbger_index.c
+ *        2. index: ./dbger_index [-j threads] file.cap       writes file.cap.idx (Default threads: the cores)
+ *        3. query: ./dbger_index -q [-l levels] [-F file] [-L line] [-t term] [-s t1] [-e t2] [-n] file.cap
+ *              -l levels     AST,ERR,WAR,INF,DBG,VBS or '-' for lines without a prefix, eg: -l ERR,WAR (Default: all)
+ *              -F file       only lines of this source file, eg: -F motor.c
+ *              -L line       only this source line
+ *              -t term       only terminal <term> (Default: all)
+ *              -s t1 -e t2   only lines read between t1 and t2, in seconds since the start of the capture
+ *              -n            print the number of lines found instead of them
+ *           the index is built first when it is missing or older than the capture, eg of a capture still running.
+ *           each line is printed with its time like rtt_capture -x -s, LOG_TIME stamps are left in it for host/dbger_time.c:
+ *              ./dbger_index -q -l ERR -F motor.c -s 3600 -e 7200 soak.cap
+ *        4. the time is that of the poll which read the line, a line which is cut by a poll is found by the time of the first part.
+ *
+ * @author	shadowthreed@gmail.com
+ * @date	20261017
+ */
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// capture file, as written by host/rtt_capture.c
+#define CAP_MAGIC		0x50414352u		// "RCAP"
+#define CAP_VERSION		1u
+#define CAP_ALIGN		8u
+
+typedef struct {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t head_len;
+	uint32_t num_up;
+	uint64_t start_ns;
+	uint64_t end;
+	uint32_t done;
+	uint32_t res;
+} cap_head_t;
+
+typedef struct {
+	uint64_t t_ns;
+	uint32_t len;
+	uint8_t chan;
+	uint8_t term;
+	uint8_t res[2];
+} cap_chunk_t;
+
+#define IDX_MAGIC		0x58444944u		// "DIDX"
+#define IDX_VERSION		1u
+#define IDX_FILE_LEN	64				// file name in the index, longer ones are cut
+#define IDX_MAX_FILES	4096			// different source files
+#define IDX_PREFIX_LEN	128				// a line is parsed up to this length
+#define IDX_MAX_THREADS	64
+#define IDX_NONE		0xFFFFFFFFu
+
+typedef struct {
+	uint32_t magic;
+	uint32_t version;
+	uint64_t cap_end;			// <end> of the capture which was indexed
+	uint64_t num_chunks;
+	uint64_t num_lines;
+	uint64_t num_files;
+} idx_head_t;
+
+typedef struct {
+	uint64_t t_ns;				// time of the poll, since the start of the capture
+	uint64_t off;				// offset of the chunk head in the capture
+	uint32_t len;
+	uint32_t term;
+} idx_chunk_t;
+
+typedef struct {
+	uint32_t chunk;				// chunk where the line starts
+	uint32_t pos;				// offset of the line in its chunk
+	uint32_t line;				// source line of the prefix, 0: no prefix
+	uint16_t file;				// source file of the prefix
+	uint8_t level;				// 1: AST .. 6: VBS like LOG_ON(), 0: no prefix
+	uint8_t res;
+} idx_line_t;
+
+typedef struct {
+	char (*name)[IDX_FILE_LEN];
+	uint16_t slot[IDX_MAX_FILES * 2];		// hash -> file + 1
+	unsigned num;
+} file_table_t;
+
+// part of the capture which is parsed by one thread
+typedef struct {
+	pthread_t thread;
+	uint32_t c0, c1;			// chunks [c0, c1)
+	idx_line_t *lines;
+	size_t num, cap;
+	file_table_t files;
+	int err;
+} part_t;
+
+static const char level_name[7][4] = { "-", "AST", "ERR", "WAR", "INF", "DBG", "VBS" };
+
+static const uint8_t *cap;			// the capture, mapped
+static idx_chunk_t *chunks;
+static uint32_t *prev_same, *next_same;		// chunk of the same terminal before / after
+static size_t num_chunks;
+
+/*********************************************************************
+*
+*       capture
+*/
+static const uint8_t *map_file(const char *path, size_t *len, int quiet)
+{
+	struct stat st;
+	void *p;
+	int fd = open(path, O_RDONLY);
+
+	if(fd < 0 || fstat(fd, &st) != 0 || st.st_size == 0) {
+		if(!quiet) {
+			perror(path);
+		}
+		if(fd >= 0) {
+			close(fd);
+		}
+		return NULL;
+	}
+	p = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(p == MAP_FAILED) {
+		perror(path);
+		return NULL;
+	}
+	*len = st.st_size;
+	return p;
+}
+
+static const cap_head_t *map_cap(const char *path, size_t *len)
+{
+	const cap_head_t *h;
+
+	cap = map_file(path, len, 0);
+	if(cap == NULL) {
+		return NULL;
+	}
+	h = (const cap_head_t *)cap;
+	if(*len < sizeof(cap_head_t) || h->magic != CAP_MAGIC || h->version != CAP_VERSION) {
+		fprintf(stderr, "%s: no capture file\n", path);
+		return NULL;
+	}
+	return h;
+}
+
+static const uint8_t *chunk_data(uint32_t c)
+{
+	return cap + chunks[c].off + sizeof(cap_chunk_t);
+}
+
+/**
+ * @brief	the chunks of channel 0, they can only be found one after the other by their heads
+ * @return	0 ok, -1 out of memory
+ */
+static int find_chunks(uint64_t end, size_t len)
+{
+	uint32_t last[256];
+	size_t max = 0;
+	uint64_t pos = ((const cap_head_t *)cap)->head_len;
+
+	memset(last, 0xFF, sizeof(last));
+	num_chunks = 0;
+	if(end > len) {
+		end = len;
+	}
+	while(pos + sizeof(cap_chunk_t) <= end) {
+		const cap_chunk_t *c = (const cap_chunk_t *)(cap + pos);
+
+		if(c->chan == 0) {
+			if(num_chunks == max) {
+				max = max ? max * 2 : 65536;
+				chunks = realloc(chunks, max * sizeof(*chunks));
+				prev_same = realloc(prev_same, max * sizeof(*prev_same));
+				next_same = realloc(next_same, max * sizeof(*next_same));
+				if(chunks == NULL || prev_same == NULL || next_same == NULL) {
+					return -1;
+				}
+			}
+			chunks[num_chunks].t_ns = c->t_ns;
+			chunks[num_chunks].off = pos;
+			chunks[num_chunks].len = c->len;
+			chunks[num_chunks].term = c->term;
+			prev_same[num_chunks] = last[c->term];
+			next_same[num_chunks] = IDX_NONE;
+			if(last[c->term] != IDX_NONE) {
+				next_same[last[c->term]] = (uint32_t)num_chunks;
+			}
+			last[c->term] = (uint32_t)num_chunks;
+			num_chunks++;
+		}
+		pos += sizeof(cap_chunk_t) + ((c->len + CAP_ALIGN - 1) & ~(CAP_ALIGN - 1));
+	}
+	return 0;
+}
+
+/**
+ * @brief	skip the stamps of LOG_TIME at the start of a line, their varint may hold a '\n'.
+ *			rtt_capture writes them into the chunk of the byte which follows them.
+ */
+static const uint8_t *skip_stamps(const uint8_t *p, const uint8_t *e)
+{
+	while(e - p >= 2 && p[0] == 0xFF && (p[1] == 'T' || p[1] == 'H')) {
+		for(p += 2; p < e && (*p & 0x80); p++) {
+		}
+		if(p < e) {
+			p++;
+		}
+	}
+	return p;
+}
+
+// copy up to <max> bytes of the line at <pos> of chunk <c>, which may go on in the next chunks of its terminal
+static unsigned get_line(uint32_t c, uint32_t pos, uint8_t *buf, unsigned max, const uint32_t *next)
+{
+	unsigned n = 0;
+
+	while(c != IDX_NONE && n < max) {
+		const uint8_t *d = chunk_data(c) + pos;
+		unsigned len = chunks[c].len - pos;
+		const uint8_t *s = n ? d : skip_stamps(d, d + len);
+		const uint8_t *nl = memchr(s, '\n', d + len - s);
+
+		if(nl) {
+			len = (unsigned)(nl - d) + 1u;
+		}
+		if(len > max - n) {
+			len = max - n;
+		}
+		memcpy(buf + n, d, len);
+		n += len;
+		if(nl) {
+			break;
+		}
+		c = next[c];
+		pos = 0;
+	}
+	return n;
+}
+
+/*********************************************************************
+*
+*       parsing
+*/
+static unsigned file_hash(const char *s)
+{
+	unsigned h = 2166136261u;
+
+	while(*s) {
+		h = (h ^ (uint8_t)*s++) * 16777619u;
+	}
+	return h;
+}
+
+// id of the file name, it is added when new, -1 the table is full
+static int file_id(file_table_t *t, const char *name)
+{
+	unsigned i = file_hash(name) % (IDX_MAX_FILES * 2);
+
+	while(t->slot[i]) {
+		if(strcmp(t->name[t->slot[i] - 1u], name) == 0) {
+			return t->slot[i] - 1;
+		}
+		i = (i + 1u) % (IDX_MAX_FILES * 2);
+	}
+	if(t->num == IDX_MAX_FILES) {
+		return -1;
+	}
+	snprintf(t->name[t->num], IDX_FILE_LEN, "%s", name);
+	t->slot[i] = (uint16_t)++t->num;
+	return (int)t->num - 1;
+}
+
+static int file_table_init(file_table_t *t)
+{
+	memset(t->slot, 0, sizeof(t->slot));
+	t->num = 0;
+	t->name = malloc(IDX_MAX_FILES * IDX_FILE_LEN);
+	return t->name ? 0 : -1;
+}
+
+static int level_of(const char *s)
+{
+	int i;
+
+	for(i = 1; i < 7; i++) {
+		if(memcmp(s, level_name[i], 3) == 0) {
+			return i;
+		}
+	}
+	return 0;
+}
+
+/**
+ * @brief	prefix "[ERR:motor.c:120] " of a line, after the stamps of LOG_TIME (0xFF 'T' / 'H' + varint) and a color
+ * @return	level, 0: no prefix
+ */
+static int parse_prefix(const uint8_t *p, unsigned n, char *file, uint32_t *line)
+{
+	const uint8_t *e = p + n;
+	unsigned len = 0;
+	int level;
+
+	p = skip_stamps(p, e);
+	if(e - p >= 2 && p[0] == 0x1B && p[1] == '[') {			// COLOR_xxx
+		for(p += 2; p < e && *p != 'm'; p++) {
+		}
+		p++;
+	}
+	if(e - p < 8 || p[0] != '[' || p[4] != ':' || (level = level_of((const char *)p + 1)) == 0) {
+		return 0;
+	}
+	for(p += 5; p < e && *p != ':' && *p != ']' && *p != '\n'; p++) {
+		if(len < IDX_FILE_LEN - 1u) {
+			file[len++] = (char)*p;
+		}
+	}
+	file[len] = '\0';
+	if(p >= e || *p != ':') {
+		return 0;
+	}
+	*line = 0;
+	for(p++; p < e && *p >= '0' && *p <= '9'; p++) {
+		*line = *line * 10u + (*p - '0');
+	}
+	return (p < e && *p == ']') ? level : 0;
+}
+
+static int add_line(part_t *part, uint32_t c, uint32_t pos)
+{
+	uint8_t buf[IDX_PREFIX_LEN];
+	char file[IDX_FILE_LEN];
+	idx_line_t *l;
+	unsigned n = get_line(c, pos, buf, sizeof(buf), next_same);
+	int id;
+
+	if(part->num == part->cap) {
+		part->cap = part->cap ? part->cap * 2 : 65536;
+		l = realloc(part->lines, part->cap * sizeof(*l));
+		if(l == NULL) {
+			return -1;
+		}
+		part->lines = l;
+	}
+	l = &part->lines[part->num++];
+	memset(l, 0, sizeof(*l));
+	l->chunk = c;
+	l->pos = pos;
+	l->level = (uint8_t)parse_prefix(buf, n, file, &l->line);
+	if(l->level) {
+		id = file_id(&part->files, file);
+		if(id < 0) {
+			return -1;
+		}
+		l->file = (uint16_t)id;
+	}
+	return 0;
+}
+
+// a line starts at each chunk whose terminal ended with a whole line before, and after each '\n'
+static void *parse_part(void *arg)
+{
+	part_t *part = arg;
+	uint32_t c;
+
+	for(c = part->c0; c < part->c1 && !part->err; c++) {
+		const uint8_t *d = chunk_data(c), *nl;
+		uint32_t p = prev_same[c], len = chunks[c].len, pos = 0;
+
+		if(p != IDX_NONE && chunk_data(p)[chunks[p].len - 1u] != '\n') {
+			nl = memchr(d, '\n', len);			// the rest of a line of the chunk before
+			if(nl == NULL) {
+				continue;
+			}
+			pos = (uint32_t)(nl - d) + 1u;
+		}
+		while(pos < len) {
+			if(add_line(part, c, pos) != 0) {
+				part->err = 1;
+				break;
+			}
+			nl = skip_stamps(d + pos, d + len);
+			nl = memchr(nl, '\n', d + len - nl);
+			if(nl == NULL) {
+				break;
+			}
+			pos = (uint32_t)(nl - d) + 1u;
+		}
+	}
+	return NULL;
+}
+
+/*********************************************************************
+*
+*       index
+*/
+static int build(const char *path, const char *idx_path, unsigned threads)
+{
+	static part_t parts[IDX_MAX_THREADS];
+	static file_table_t files;
+	size_t len, num_lines = 0;
+	const cap_head_t *h = map_cap(path, &len);
+	uint64_t cap_end, total = 0, acc = 0;
+	idx_head_t ih;
+	unsigned i, k;
+	uint32_t c;
+	FILE *f;
+
+	if(h == NULL) {
+		return -1;
+	}
+	cap_end = __atomic_load_n(&h->end, __ATOMIC_ACQUIRE);
+	if(find_chunks(cap_end, len) != 0 || file_table_init(&files) != 0) {
+		fprintf(stderr, "out of memory\n");
+		return -1;
+	}
+	//
+	// parts of about the same size, a thread for each
+	//
+	if(threads > IDX_MAX_THREADS) {
+		threads = IDX_MAX_THREADS;
+	}
+	if(threads == 0) {
+		threads = 1;
+	}
+	for(c = 0; c < num_chunks; c++) {
+		total += chunks[c].len;
+	}
+	for(k = 0, c = 0; k < threads; k++) {
+		parts[k].c0 = c;
+		while(c < num_chunks && (k == threads - 1u || acc < total * (k + 1u) / threads)) {
+			acc += chunks[c++].len;
+		}
+		parts[k].c1 = c;
+		if(file_table_init(&parts[k].files) != 0 || pthread_create(&parts[k].thread, NULL, parse_part, &parts[k]) != 0) {
+			fprintf(stderr, "no thread\n");
+			return -1;
+		}
+	}
+	for(k = 0; k < threads; k++) {
+		pthread_join(parts[k].thread, NULL);
+		if(parts[k].err) {
+			fprintf(stderr, "out of memory, or more than %u source files\n", IDX_MAX_FILES);
+			return -1;
+		}
+		num_lines += parts[k].num;
+	}
+	//
+	// the file ids of each part are mapped to those of the index
+	//
+	for(k = 0; k < threads; k++) {
+		uint16_t map[IDX_MAX_FILES];
+		size_t j;
+
+		for(i = 0; i < parts[k].files.num; i++) {
+			int id = file_id(&files, parts[k].files.name[i]);
+
+			if(id < 0) {
+				fprintf(stderr, "more than %u source files\n", IDX_MAX_FILES);
+				return -1;
+			}
+			map[i] = (uint16_t)id;
+		}
+		for(j = 0; j < parts[k].num; j++) {
+			if(parts[k].lines[j].level) {
+				parts[k].lines[j].file = map[parts[k].lines[j].file];
+			}
+		}
+	}
+	f = fopen(idx_path, "wb");
+	if(f == NULL) {
+		perror(idx_path);
+		return -1;
+	}
+	memset(&ih, 0, sizeof(ih));
+	ih.magic = IDX_MAGIC;
+	ih.version = IDX_VERSION;
+	ih.cap_end = cap_end;
+	ih.num_chunks = num_chunks;
+	ih.num_lines = num_lines;
+	ih.num_files = files.num;
+	fwrite(&ih, sizeof(ih), 1, f);
+	fwrite(chunks, sizeof(*chunks), num_chunks, f);
+	for(k = 0; k < threads; k++) {
+		fwrite(parts[k].lines, sizeof(idx_line_t), parts[k].num, f);
+		free(parts[k].lines);
+		free(parts[k].files.name);
+	}
+	fwrite(files.name, IDX_FILE_LEN, files.num, f);
+	free(files.name);
+	if(fclose(f) != 0) {
+		perror(idx_path);
+		return -1;
+	}
+	fprintf(stderr, "%s: %zu lines, %zu chunks, %u source files, %u threads\n", idx_path, num_lines, num_chunks, files.num, threads);
+	munmap((void *)cap, len);
+	return 0;
+}
+
+typedef struct {
+	unsigned levels;			// bit n: level n
+	int file;					// -1: all
+	uint32_t line;				// 0: all
+	int term;					// -1: all
+	uint64_t t1, t2;
+	int count;
+} query_t;
+
+// first chunk with a time >= t
+static size_t chunk_at(const idx_chunk_t *ch, size_t n, uint64_t t)
+{
+	size_t lo = 0, hi = n;
+
+	while(lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+
+		if(ch[mid].t_ns < t) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+// first line in chunk >= c
+static size_t line_at(const idx_line_t *l, size_t n, uint32_t c)
+{
+	size_t lo = 0, hi = n;
+
+	while(lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+
+		if(l[mid].chunk < c) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+static int query(const char *path, const char *idx_path, query_t *q, const char *file)
+{
+	size_t cap_len, idx_len, i, first, last, found = 0;
+	const idx_head_t *ih;
+	const idx_line_t *lines;
+	const char (*names)[IDX_FILE_LEN];
+	uint32_t c;
+
+	if(map_cap(path, &cap_len) == NULL) {
+		return -1;
+	}
+	ih = (const idx_head_t *)map_file(idx_path, &idx_len, 1);
+	if(ih == NULL || idx_len < sizeof(*ih) || ih->magic != IDX_MAGIC || ih->version != IDX_VERSION
+	   || ih->cap_end != ((const cap_head_t *)cap)->end) {
+		if(ih) {
+			munmap((void *)ih, idx_len);
+		}
+		munmap((void *)cap, cap_len);
+		if(build(path, idx_path, (unsigned)sysconf(_SC_NPROCESSORS_ONLN)) != 0 || map_cap(path, &cap_len) == NULL) {
+			return -1;
+		}
+		ih = (const idx_head_t *)map_file(idx_path, &idx_len, 0);
+		if(ih == NULL) {
+			return -1;
+		}
+	}
+	if(idx_len < sizeof(*ih) + ih->num_chunks * sizeof(idx_chunk_t) + ih->num_lines * sizeof(idx_line_t) + ih->num_files * IDX_FILE_LEN) {
+		fprintf(stderr, "%s: cut\n", idx_path);
+		return -1;
+	}
+	chunks = (idx_chunk_t *)(ih + 1);
+	num_chunks = ih->num_chunks;
+	lines = (const idx_line_t *)(chunks + num_chunks);
+	names = (const char (*)[IDX_FILE_LEN])(lines + ih->num_lines);
+	if(file) {
+		for(q->file = 0; (uint64_t)q->file < ih->num_files && strcmp(names[q->file], file) != 0; q->file++) {
+		}
+		if((uint64_t)q->file == ih->num_files) {
+			q->file = -2;			// no line of it
+		}
+	}
+	//
+	// the time range by binary search in the chunks, then the lines of those chunks
+	//
+	first = line_at(lines, ih->num_lines, (uint32_t)chunk_at(chunks, num_chunks, q->t1));
+	last = (q->t2 == UINT64_MAX) ? ih->num_lines : line_at(lines, ih->num_lines, (uint32_t)chunk_at(chunks, num_chunks, q->t2 + 1u));
+	for(i = first; i < last && q->file != -2; i++) {
+		const idx_line_t *l = &lines[i];
+		unsigned n;
+
+		if(!(q->levels & (1u << l->level)) || (q->file >= 0 && (!l->level || l->file != q->file))
+		   || (q->line && l->line != q->line) || (q->term >= 0 && chunks[l->chunk].term != (uint32_t)q->term)) {
+			continue;
+		}
+		found++;
+		if(q->count) {
+			continue;
+		}
+		//
+		// the line goes on in the next chunk of its terminal, the chunks of channel 0 follow each other in the index
+		//
+		printf("[%12.6f] ", chunks[l->chunk].t_ns / 1e9);
+		c = l->chunk;
+		n = l->pos;
+		for(;;) {
+			const uint8_t *d = chunk_data(c) + n;
+			unsigned len = chunks[c].len - n;
+			const uint8_t *s = (c == l->chunk) ? skip_stamps(d, d + len) : d;
+			const uint8_t *nl = memchr(s, '\n', d + len - s);
+
+			fwrite(d, 1, nl ? (size_t)(nl - d) + 1u : len, stdout);
+			if(nl) {
+				break;
+			}
+			for(c++; c < num_chunks && chunks[c].term != chunks[l->chunk].term; c++) {
+			}
+			if(c >= num_chunks) {
+				putchar('\n');			// the rest is not captured yet
+				break;
+			}
+			n = 0;
+		}
+	}
+	if(q->count) {
+		printf("%zu\n", found);
+	}
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	query_t q = { 0x7F, -1, 0, -1, 0, UINT64_MAX, 0 };
+	unsigned threads = (unsigned)sysconf(_SC_NPROCESSORS_ONLN);
+	const char *file = NULL;
+	char idx_path[4096];
+	int opt, do_query = 0;
+
+	while((opt = getopt(argc, argv, "j:ql:F:L:t:s:e:n")) != -1) {
+		switch(opt) {
+		case 'j': threads = (unsigned)strtoul(optarg, NULL, 0); break;
+		case 'q': do_query = 1; break;
+		case 'l': {
+			char *s = optarg;
+
+			q.levels = 0;
+			while(*s) {
+				int level = (*s == '-') ? 0 : level_of(s);
+
+				if(level == 0 && *s != '-') {
+					fprintf(stderr, "unknown level %s\n", s);
+					return 1;
+				}
+				q.levels |= 1u << level;
+				s += (*s == '-') ? 1 : 3;
+				if(*s == ',') {
+					s++;
+				}
+			}
+			break;
+		}
+		case 'F': file = optarg; break;
+		case 'L': q.line = (uint32_t)strtoul(optarg, NULL, 0); break;
+		case 't': q.term = (int)strtol(optarg, NULL, 16); break;
+		case 's': q.t1 = (uint64_t)(strtod(optarg, NULL) * 1e9); break;
+		case 'e': q.t2 = (uint64_t)(strtod(optarg, NULL) * 1e9); break;
+		case 'n': q.count = 1; break;
+		default:
+			optind = argc + 1;
+			break;
+		}
+	}
+	if(optind != argc - 1) {
+		fprintf(stderr, "usage: %s [-j threads] file.cap\n"
+						"       %s -q [-l levels] [-F file] [-L line] [-t term] [-s t1] [-e t2] [-n] file.cap\n", argv[0], argv[0]);
+		return 1;
+	}
+	snprintf(idx_path, sizeof(idx_path), "%s.idx", argv[optind]);
+	if(do_query) {
+		return query(argv[optind], idx_path, &q, file) ? 1 : 0;
+	}
+	return build(argv[optind], idx_path, threads) ? 1 : 0;
+}
@@ -0,0 +1,217 @@
+/**
+ * @file	dbger_merge.c
+ * @brief	Host tool. Merge the RTT channels of all contexts (LOG_CTX_CHANNEL = 1) into one stream in the order they were written.
+ *
+ * @note HOW TO USE:
+ *        1. build: gcc -O2 -o dbger_merge dbger_merge.c
+ *        2. log each context channel into a file, eg: JLinkRTTLogger -RTTChannel 1 ctx0.bin, JLinkRTTLogger -RTTChannel 3 ctx1.bin
+ *        3. ./dbger_merge [-t] [-f hz] [-c] ctx0.bin ctx1.bin ...
+ *              -t    print the timestamp of each record, with LOG_TIME the ticks since the first record
+ *              -f hz print the time in seconds, the ticks per second of LOG_TIME_HZ() (LOG_TIME only)
+ *              -c    print the context (index of file) of each record
+ *
+ * @author	shadowthreed@gmail.com
+ * @date	20261017
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DBGER_CTX_SYNC		0xDC
+#define DBGER_CTX_HEAD_LEN	10
+#define DBGER_CTX_SYNC_TIME	0xDE		// LOG_TIME: the timestamp is a varint of the time since the last record
+#define DBGER_CTX_FIX_LEN	6			// sync + len + seq
+
+typedef struct {
+	uint64_t seq;			// unwrapped
+	uint64_t ts;			// LOG_TIME: absolute ticks rebuilt from the deltas
+	unsigned ctx;
+	unsigned len;
+	const uint8_t *text;
+} record_t;
+
+static record_t *recs;
+static size_t rec_num, rec_cap;
+static int timed;						// LOG_TIME records found
+
+static uint8_t *load_file(const char *path, size_t *len)
+{
+	FILE *f = fopen(path, "rb");
+	uint8_t *buf;
+	long n;
+
+	if(f == NULL) {
+		return NULL;
+	}
+	fseek(f, 0, SEEK_END);
+	n = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	buf = malloc(n > 0 ? n : 1);
+	if(buf && fread(buf, 1, n, f) != (size_t)n) {
+		free(buf);
+		buf = NULL;
+	}
+	fclose(f);
+	*len = (size_t)n;
+	return buf;
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// varint of LOG_TIME, return its length, 0 if it does not end before <end>
+static unsigned get_var(const uint8_t *p, const uint8_t *end, uint64_t *v)
+{
+	unsigned n = 0, shift = 0;
+
+	*v = 0;
+	while(p + n < end && shift < 64) {
+		*v |= (uint64_t)(p[n] & 0x7Fu) << shift;
+		if((p[n++] & 0x80u) == 0) {
+			return n;
+		}
+		shift += 7;
+	}
+	return 0;
+}
+
+/**
+ * @brief	collect the records of one channel, bytes which are not a valid record are skipped.
+ *			seq is unwrapped by the distance to the previous record of the same channel.
+ *			LOG_TIME: bit 0 of the time is set for an absolute time, else it's the delta to the last record.
+ */
+static void parse(const uint8_t *buf, size_t len, unsigned ctx)
+{
+	size_t pos = 0;
+	uint64_t last = 0, t = 0;
+	int first = 1;
+
+	while(pos + DBGER_CTX_FIX_LEN < len) {
+		record_t *r;
+		uint32_t seq;
+		unsigned head;
+		uint64_t v = 0;
+
+		if(buf[pos] == DBGER_CTX_SYNC) {
+			head = DBGER_CTX_HEAD_LEN;
+		} else if(buf[pos] == DBGER_CTX_SYNC_TIME) {
+			head = get_var(buf + pos + DBGER_CTX_FIX_LEN, buf + len, &v);
+			head = head ? DBGER_CTX_FIX_LEN + head : 0;
+		} else {
+			head = 0;
+		}
+		if(head == 0 || pos + head + buf[pos + 1] > len) {
+			pos++;
+			continue;
+		}
+		if(rec_num == rec_cap) {
+			rec_cap = rec_cap ? rec_cap * 2 : 1024;
+			recs = realloc(recs, rec_cap * sizeof(*recs));
+			if(recs == NULL) {
+				fprintf(stderr, "out of memory\n");
+				exit(1);
+			}
+		}
+		seq = get32(buf + pos + 2);
+		r = &recs[rec_num++];
+		r->seq = first ? seq : last + (int64_t)(int32_t)(seq - (uint32_t)last);
+		if(buf[pos] == DBGER_CTX_SYNC_TIME) {
+			t = (v & 1u) ? (v >> 1) : (t + (v >> 1));
+			r->ts = t;
+			timed = 1;
+		} else {
+			r->ts = get32(buf + pos + 6);
+		}
+		r->ctx = ctx;
+		r->len = buf[pos + 1];
+		r->text = buf + pos + head;
+		last = r->seq;
+		first = 0;
+		pos += head + r->len;
+	}
+}
+
+static int cmp_seq(const void *a, const void *b)
+{
+	const record_t *ra = a, *rb = b;
+
+	return (ra->seq > rb->seq) - (ra->seq < rb->seq);
+}
+
+// text without RTT terminal switch (0xFF + terminal id)
+static void print_text(const uint8_t *p, unsigned len)
+{
+	unsigned i;
+
+	for(i = 0; i < len; i++) {
+		if(p[i] == 0xFF) {
+			i++;
+			continue;
+		}
+		putchar(p[i]);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	int show_ts = 0, show_ctx = 0;
+	unsigned ctx = 0;
+	double hz = 0;
+	uint64_t t0 = UINT64_MAX;
+	size_t i;
+	int a;
+
+	for(a = 1; a < argc && argv[a][0] == '-'; a++) {
+		if(strcmp(argv[a], "-t") == 0) {
+			show_ts = 1;
+		} else if(strcmp(argv[a], "-f") == 0 && a + 1 < argc) {
+			hz = strtod(argv[++a], NULL);
+			show_ts = 1;
+		} else if(strcmp(argv[a], "-c") == 0) {
+			show_ctx = 1;
+		} else {
+			break;
+		}
+	}
+	if(a >= argc) {
+		fprintf(stderr, "usage: %s [-t] [-f hz] [-c] <ctx0.bin> [ctx1.bin ...]\n", argv[0]);
+		return 1;
+	}
+	for(; a < argc; a++, ctx++) {
+		size_t len;
+		uint8_t *buf = load_file(argv[a], &len);		// kept until exit, records point into it
+		if(buf == NULL) {
+			fprintf(stderr, "can't read %s\n", argv[a]);
+			return 1;
+		}
+		parse(buf, len, ctx);
+	}
+	qsort(recs, rec_num, sizeof(*recs), cmp_seq);
+	for(i = 0; timed && i < rec_num; i++) {		// all contexts count the same clock, times start at the earliest record
+		if(recs[i].ts < t0) {
+			t0 = recs[i].ts;
+		}
+	}
+	for(i = 0; i < rec_num; i++) {
+		if(i && recs[i].seq > recs[i - 1].seq + 1) {
+			printf("\n--- %llu record(s) lost ---\n", (unsigned long long)(recs[i].seq - recs[i - 1].seq - 1));
+		}
+		if(recs[i].len > 2 || recs[i].text[0] != 0xFF) {		// a terminal switch only has no text
+			if(show_ts && timed && hz > 0) {
+				printf("[%12.6f] ", (recs[i].ts - t0) / hz);
+			} else if(show_ts && timed) {
+				printf("[%12llu] ", (unsigned long long)(recs[i].ts - t0));
+			} else if(show_ts) {
+				printf("[%10u] ", (unsigned)recs[i].ts);
+			}
+			if(show_ctx) {
+				printf("[%u] ", recs[i].ctx);
+			}
+		}
+		print_text(recs[i].text, recs[i].len);
+	}
+	return 0;
+}
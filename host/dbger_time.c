@@ -0,0 +1,97 @@
+/**
+ * @file	dbger_time.c
+ * @brief	Host tool. Print the time of each LOG line of RTT channel 0 (LOG_TIME = 1) in front of it.
+ *			The stamps 0xFF 'T' + varint are replaced by the time since the first stamp, 0xFF 'H' + varint gives
+ *			the ticks per second (LOG_TIME_HZ()), the other RTT terminal switches (0xFF + terminal id) are removed.
+ *
+ * @note HOW TO USE:
+ *        1. build: gcc -O2 -o dbger_time dbger_time.c
+ *        2. ./dbger_time [-f hz] [-a] [file]      read stdin without file, eg: rtt_probe | dbger_time
+ *              -f hz    ticks per second, instead of the one sent by LOG_INIT(), 0: print ticks
+ *              -a       print the absolute ticks of the counter
+ *
+ * @author	shadowthreed@gmail.com
+ * @date	20261017
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// varint of LOG_TIME from the stream, return -1 at the end of the stream
+static int get_var(FILE *in, uint64_t *v)
+{
+	unsigned shift = 0;
+	int c;
+
+	*v = 0;
+	while((c = getc(in)) != EOF) {
+		if(shift < 64) {
+			*v |= (uint64_t)(c & 0x7F) << shift;
+		}
+		if((c & 0x80) == 0) {
+			return 0;
+		}
+		shift += 7;
+	}
+	return -1;
+}
+
+int main(int argc, char *argv[])
+{
+	FILE *in = stdin;
+	double hz = 0;
+	int hz_given = 0, absolute = 0, first = 1, c, a;
+	uint64_t t = 0, t0 = 0, v;
+
+	for(a = 1; a < argc && argv[a][0] == '-' && argv[a][1]; a++) {
+		if(strcmp(argv[a], "-f") == 0 && a + 1 < argc) {
+			hz = strtod(argv[++a], NULL);
+			hz_given = 1;
+		} else if(strcmp(argv[a], "-a") == 0) {
+			absolute = 1;
+		} else {
+			fprintf(stderr, "usage: %s [-f hz] [-a] [file]\n", argv[0]);
+			return 1;
+		}
+	}
+	if(a < argc) {
+		in = fopen(argv[a], "rb");
+		if(in == NULL) {
+			perror(argv[a]);
+			return 1;
+		}
+	}
+	setvbuf(stdout, NULL, _IOLBF, 0);		// follow a live stream line by line
+	while((c = getc(in)) != EOF) {
+		if(c != 0xFF) {
+			putchar(c);
+			continue;
+		}
+		c = getc(in);
+		if(c == 'T') {
+			if(get_var(in, &v) != 0) {
+				break;
+			}
+			t = (v & 1u) ? (v >> 1) : (t + (v >> 1));		// bit 0: absolute time, at first and after a lost line
+			if(first) {
+				t0 = absolute ? 0 : t;
+				first = 0;
+			}
+			if(hz > 0) {
+				printf("[%12.6f] ", (t - t0) / hz);
+			} else {
+				printf("[%12llu] ", (unsigned long long)(t - t0));
+			}
+		} else if(c == 'H') {
+			if(get_var(in, &v) != 0) {
+				break;
+			}
+			if(!hz_given) {
+				hz = (double)v;
+			}
+		}
+		// else a terminal switch, or the end
+	}
+	return 0;
+}
@@ -0,0 +1,481 @@
+/**
+ * @file	lockfree_stress.c
+ * @brief	Host tool. Stress test of SEGGER_RTT_WriteLockFree(): N threads write tagged records into one up-buffer
+ *			at the same time, and a timer signal preempts them in the middle of a write and writes its own records,
+ *			like an ISR on the target. The ring is small, so the writers race across the wrap-around all the time,
+ *			and in TRIM mode the writers which find the ring full commit a part of their record.
+ *
+ *			The up-buffer is in section "rtt_shm" (host/rtt_shm.c), the reader maps the shared memory object
+ *			on its own and reads it through <RdOff>/<WrOff> like host/rtt_probe.c does.
+ *			It checks each record against its tag: content, length and sequence,
+ *			so a torn, mixed, duplicated or reordered record is an error,
+ *			and the counts of full and trimmed records must match what the writers got back.
+ *
+ *			record: '{' tag (2 hex) seq (8 hex) payload len (2 hex) payload '}', the payload is a function of tag, seq and index,
+ *			tag 0..N-1 are the threads, N..2N-1 the signal handler on each thread.
+ *
+ * @note HOW TO USE:
+ *        1. build in host/: gcc -O2 -I.. -DSEGGER_RTT_SECTION='"rtt_shm"' -o lockfree_stress lockfree_stress.c rtt_shm.c ../SEGGER_RTT.c -lpthread -lrt
+ *           add -DSEGGER_RTT_BUFFER_SIZE_POW2=1 for the masked wrap-around, -fsanitize=thread to let tsan watch it too
+ *        2. ./lockfree_stress [-w writers] [-n records] [-s size] [-l len] [-i rate] [-m skip|trim]
+ *              -w writers    writer threads (Default: 4)
+ *              -n records    records per writer (Default: 200000)
+ *              -s size       up-buffer size, at most 65536 (Default: 1000, 1024 with SEGGER_RTT_BUFFER_SIZE_POW2)
+ *              -l len        max payload length, at most 200 (Default: 64)
+ *              -i rate       timer signals per second, 0: none (Default: 20000)
+ *              -m mode       skip or trim, both if not given
+ *        3. one line per mode, exit code 1 if any record is wrong, the first errors are on stderr.
+ *
+ * @author	shadowthreed@gmail.com
+ * @date	20261017
+ */
+#include "SEGGER_RTT.h"
+#include "rtt_shm.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifndef SEGGER_RTT_SECTION
+	#error	build with -DSEGGER_RTT_SECTION='"rtt_shm"', the up-buffer is read through the shared memory
+#endif
+#if !SEGGER_RTT_LOCKFREE
+	#error	SEGGER_RTT_WriteLockFree() falls back to SEGGER_RTT_Write() on this compiler
+#endif
+
+#define STRESS_CH			1
+#define STRESS_MAX_BUF		0x10000u			// limit of SEGGER_RTT_WriteLockFree()
+#define STRESS_MAX_WRITERS	64
+#define STRESS_MAX_LEN		200
+#define STRESS_HEAD_LEN		12					// tag, seq, payload len, in hex
+#define STRESS_REC_LEN		(STRESS_HEAD_LEN + STRESS_MAX_LEN + 2)
+#define STRESS_MAX_ERRORS	10					// printed
+
+typedef struct {
+	unsigned tag;
+	uint32_t seq;
+	uint32_t rnd;
+	uint64_t full, trimmed, dropped, bytes;		// what SEGGER_RTT_WriteLockFree() returned
+} tag_t;
+
+typedef struct {
+	pthread_t th;
+	tag_t own;
+	tag_t irq;
+} writer_t;
+
+static char ring[STRESS_MAX_BUF] __attribute__((section(SEGGER_RTT_SECTION)));
+static writer_t writers[STRESS_MAX_WRITERS];
+static __thread writer_t *self;					// writer of the thread, for the signal handler
+static unsigned num_writers = 4, num_records = 200000, max_len = 64;
+static int go;
+
+static struct {
+	uint8_t *mem;								// the shared memory object, target memory from mem[RTT_SHM_HEAD_LEN]
+	uint64_t base;
+	rtt_shm_buf_t *up;
+	int writing;								// 0: read all what is left and stop
+	// parser
+	char cur[STRESS_REC_LEN];
+	unsigned len;
+	int open;
+	int64_t last[2 * STRESS_MAX_WRITERS];
+	uint64_t full[2 * STRESS_MAX_WRITERS], trimmed[2 * STRESS_MAX_WRITERS];
+	uint64_t trimmed_head;						// trimmed in the head, the tag is not known
+	uint64_t bytes, errors;
+} rd;
+
+static const char hex[] = "0123456789abcdef";
+
+static char payload(unsigned tag, uint32_t seq, unsigned i)
+{
+	return (char)('a' + (tag * 7u + seq + i) % 26u);
+}
+
+static void put_hex(char *p, uint32_t v, unsigned n)
+{
+	while(n--) {
+		p[n] = hex[v & 0x0F];
+		v >>= 4;
+	}
+}
+
+static int get_hex(const char *p, unsigned n, uint32_t *v)
+{
+	*v = 0;
+	while(n--) {
+		const char *h = memchr(hex, *p++, 16);
+
+		if(h == NULL) {
+			return -1;
+		}
+		*v = (*v << 4) | (uint32_t)(h - hex);
+	}
+	return 0;
+}
+
+// one record, also called by the signal handler in the middle of another one
+static unsigned put(tag_t *t)
+{
+	char rec[STRESS_REC_LEN];
+	unsigned len, n, i;
+
+	t->rnd ^= t->rnd << 13;
+	t->rnd ^= t->rnd >> 17;
+	t->rnd ^= t->rnd << 5;
+	len = t->rnd % (max_len + 1);
+	rec[0] = '{';
+	put_hex(rec + 1, t->tag, 2);
+	put_hex(rec + 3, t->seq, 8);
+	put_hex(rec + 11, len, 2);
+	for(i = 0; i < len; i++) {
+		rec[1 + STRESS_HEAD_LEN + i] = payload(t->tag, t->seq, i);
+	}
+	rec[1 + STRESS_HEAD_LEN + len] = '}';
+	len += STRESS_HEAD_LEN + 2;
+	n = SEGGER_RTT_WriteLockFree(STRESS_CH, rec, len);
+	if(n == len) {
+		t->full++;
+	} else if(n) {
+		t->trimmed++;
+	} else {
+		t->dropped++;
+	}
+	t->bytes += n;
+	t->seq++;
+	return n;
+}
+
+static void irq(int sig)
+{
+	(void)sig;
+	if(self) {
+		put(&self->irq);
+		sched_yield();			// the reader runs while the preempted writer is in the middle of its record, also on a single core
+	}
+}
+
+static void *writer(void *arg)
+{
+	writer_t *w = arg;
+	sigset_t set;
+	unsigned i;
+
+	self = w;
+	sigemptyset(&set);
+	sigaddset(&set, SIGALRM);
+	pthread_sigmask(SIG_UNBLOCK, &set, NULL);
+	while(!__atomic_load_n(&go, __ATOMIC_ACQUIRE)) {
+		sched_yield();
+	}
+	for(i = 0; i < num_records; i++) {
+		if(put(&w->own) == 0) {
+			sched_yield();				// ring full, let the reader run (on a single core)
+		}
+	}
+	return NULL;
+}
+
+static void error(const char *what)
+{
+	if(rd.errors++ < STRESS_MAX_ERRORS) {
+		fprintf(stderr, "%s at byte %llu: %.*s\n", what, (unsigned long long)rd.bytes, (int)rd.len, rd.cur);
+	}
+}
+
+// the record in cur[] ends, full: with '}', else with the '{' of the next one or the end of the stream
+static void check(int full)
+{
+	uint32_t tag, seq, len;
+	unsigned i;
+
+	if(rd.len < 1 + STRESS_HEAD_LEN) {
+		if(full) {
+			error("short record");
+		} else {
+			rd.trimmed_head++;
+		}
+		return;
+	}
+	if(get_hex(rd.cur + 1, 2, &tag) || get_hex(rd.cur + 3, 8, &seq) || get_hex(rd.cur + 11, 2, &len)
+	   || tag >= 2 * num_writers || len > max_len) {
+		error("bad head");
+		return;
+	}
+	if(full ? (rd.len != 1 + STRESS_HEAD_LEN + len) : (rd.len > 1 + STRESS_HEAD_LEN + len)) {
+		error("bad length");
+		return;
+	}
+	for(i = 1 + STRESS_HEAD_LEN; i < rd.len; i++) {
+		if(rd.cur[i] != payload(tag, seq, i - 1 - STRESS_HEAD_LEN)) {
+			error("torn record");
+			return;
+		}
+	}
+	if((int64_t)seq <= rd.last[tag]) {
+		error("duplicated or reordered record");
+		return;
+	}
+	rd.last[tag] = seq;
+	if(full) {
+		rd.full[tag]++;
+	} else {
+		rd.trimmed[tag]++;
+	}
+}
+
+static void parse(const char *p, unsigned n)
+{
+	while(n--) {
+		char c = *p++;
+
+		rd.bytes++;
+		if(c == '{') {
+			if(rd.open) {
+				check(0);
+			}
+			rd.open = 1;
+			rd.len = 0;
+		} else if(!rd.open) {
+			error("data out of record");
+			continue;
+		} else if(c == '}') {
+			check(1);
+			rd.open = 0;
+			continue;
+		} else if(rd.len == sizeof(rd.cur)) {
+			error("record too long");
+			rd.open = 0;
+			continue;
+		}
+		rd.cur[rd.len++] = c;
+	}
+}
+
+// what the probe does in one poll: from <RdOff> to <WrOff>, then move <RdOff>
+static unsigned read_up(void)
+{
+	rtt_shm_buf_t *b = rd.up;
+#ifdef __SANITIZE_THREAD__
+	const char *data = (const char *)b->pBuffer;
+#else
+	const char *data = (const char *)rd.mem + RTT_SHM_HEAD_LEN + (b->pBuffer - rd.base);
+#endif
+	unsigned size = b->SizeOfBuffer;
+	unsigned wr = __atomic_load_n(&b->WrOff, __ATOMIC_ACQUIRE);
+	unsigned r = b->RdOff;
+	unsigned n = (wr >= r) ? (wr - r) : (size - r);
+
+	if(wr >= size) {
+		error("WrOff out of range");
+		return 0;
+	}
+	parse(data + r, n);
+	r += n;
+	__atomic_store_n(&b->RdOff, (r == size) ? 0 : r, __ATOMIC_RELEASE);
+	return n;
+}
+
+static void *reader(void *arg)
+{
+	(void)arg;
+	for(;;) {
+		int writing = __atomic_load_n(&rd.writing, __ATOMIC_ACQUIRE);
+
+		if(read_up() == 0) {
+			if(!writing) {
+				break;
+			}
+			sched_yield();
+		}
+	}
+	if(rd.open) {
+		check(0);			// the last record may be trimmed
+		rd.open = 0;
+	}
+	return NULL;
+}
+
+static int map_shm(void)
+{
+	const char *name = getenv("RTT_SHM_NAME");
+	rtt_shm_head_t *head;
+	struct stat st;
+	int fd;
+
+	fd = shm_open(name ? name : RTT_SHM_NAME, O_RDWR, 0);
+	if(fd < 0 || fstat(fd, &st) != 0) {
+		return -1;
+	}
+	rd.mem = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if(rd.mem == MAP_FAILED) {
+		return -1;
+	}
+	head = (rtt_shm_head_t *)rd.mem;
+	if(head->magic != RTT_SHM_MAGIC || head->pid != (int32_t)getpid()
+	   || (uintptr_t)&_SEGGER_RTT < head->base || (uintptr_t)(ring + sizeof(ring)) > head->base + head->len) {
+		return -1;
+	}
+	rd.base = head->base;
+	rd.up = (rtt_shm_buf_t *)(rd.mem + RTT_SHM_HEAD_LEN + ((uintptr_t)&_SEGGER_RTT.aUp[STRESS_CH] - head->base));
+#ifdef __SANITIZE_THREAD__
+	// tsan tracks addresses, not memory: a writer can reuse the space of another one as soon as the reader moved <RdOff>,
+	// which tsan only sees if the reader goes through the addresses of the writers, the same shared memory
+	rd.up = (rtt_shm_buf_t *)&_SEGGER_RTT.aUp[STRESS_CH];
+#endif
+	return 0;
+}
+
+static int run(unsigned flags, unsigned size, unsigned rate)
+{
+	uint64_t full = 0, trimmed = 0, dropped = 0, bytes = 0, irqs = 0, trimmed_read = 0;
+	struct sigevent sev;
+	struct itimerspec its;
+	timer_t timer;
+	pthread_t th;
+	unsigned i, t;
+	int bad = 0;
+
+	memset(writers, 0, sizeof(writers));
+	for(t = 0; t < 2 * num_writers; t++) {
+		rd.last[t] = -1;
+		rd.full[t] = 0;
+		rd.trimmed[t] = 0;
+	}
+	rd.len = 0;
+	rd.open = 0;
+	rd.trimmed_head = 0;
+	rd.bytes = 0;
+	rd.errors = 0;
+	if(SEGGER_RTT_ConfigUpBuffer(STRESS_CH, "stress", ring, size, flags) < 0) {
+		fprintf(stderr, "up-buffer size %u rejected\n", size);
+		exit(2);
+	}
+	rd.writing = 1;
+	go = 0;
+	pthread_create(&th, NULL, reader, NULL);
+	for(i = 0; i < num_writers; i++) {
+		writers[i].own.tag = i;
+		writers[i].own.rnd = 2 * i + 1;
+		writers[i].irq.tag = num_writers + i;
+		writers[i].irq.rnd = 2 * i + 2;
+		pthread_create(&writers[i].th, NULL, writer, &writers[i]);
+	}
+	if(rate) {
+		memset(&sev, 0, sizeof(sev));
+		sev.sigev_notify = SIGEV_SIGNAL;
+		sev.sigev_signo = SIGALRM;
+		its.it_value.tv_sec = 0;
+		its.it_value.tv_nsec = 1000000000 / rate;
+		its.it_interval = its.it_value;
+		timer_create(CLOCK_MONOTONIC, &sev, &timer);
+		timer_settime(timer, 0, &its, NULL);
+	}
+	__atomic_store_n(&go, 1, __ATOMIC_RELEASE);
+	for(i = 0; i < num_writers; i++) {
+		pthread_join(writers[i].th, NULL);
+	}
+	if(rate) {
+		timer_delete(timer);
+	}
+	__atomic_store_n(&rd.writing, 0, __ATOMIC_RELEASE);
+	pthread_join(th, NULL);
+
+	for(i = 0; i < num_writers; i++) {
+		tag_t *tags[2] = { &writers[i].own, &writers[i].irq };
+
+		for(t = 0; t < 2; t++) {
+			tag_t *g = tags[t];
+
+			full += g->full;
+			trimmed += g->trimmed;
+			dropped += g->dropped;
+			bytes += g->bytes;
+			if(t) {
+				irqs += g->seq;
+			}
+			if(rd.full[g->tag] != g->full || rd.trimmed[g->tag] > g->trimmed) {
+				fprintf(stderr, "tag %u: %llu full and %llu trimmed read, %llu and %llu written\n", g->tag,
+						(unsigned long long)rd.full[g->tag], (unsigned long long)rd.trimmed[g->tag],
+						(unsigned long long)g->full, (unsigned long long)g->trimmed);
+				bad = 1;
+			}
+			trimmed_read += rd.trimmed[g->tag];
+		}
+	}
+	if(trimmed_read + rd.trimmed_head != trimmed || rd.bytes != bytes) {
+		fprintf(stderr, "%llu trimmed and %llu bytes read, %llu and %llu written\n",
+				(unsigned long long)(trimmed_read + rd.trimmed_head), (unsigned long long)rd.bytes,
+				(unsigned long long)trimmed, (unsigned long long)bytes);
+		bad = 1;
+	}
+	printf("%-4s  %7u  %5u  %10llu  %10llu  %10llu  %10llu  %12llu  %6llu\n",
+		   (flags == SEGGER_RTT_MODE_NO_BLOCK_TRIM) ? "trim" : "skip", num_writers, size,
+		   (unsigned long long)irqs, (unsigned long long)full, (unsigned long long)trimmed,
+		   (unsigned long long)dropped, (unsigned long long)bytes, (unsigned long long)rd.errors);
+	return bad || rd.errors;
+}
+
+int main(int argc, char *argv[])
+{
+#if SEGGER_RTT_BUFFER_SIZE_POW2
+	unsigned size = 1024;
+#else
+	unsigned size = 1000;
+#endif
+	unsigned rate = 20000;
+	int mode = -1, bad = 0, opt;
+	struct sigaction sa;
+	sigset_t set;
+
+	while((opt = getopt(argc, argv, "w:n:s:l:i:m:")) != -1) {
+		switch(opt) {
+		case 'w': num_writers = (unsigned)strtoul(optarg, NULL, 0); break;
+		case 'n': num_records = (unsigned)strtoul(optarg, NULL, 0); break;
+		case 's': size = (unsigned)strtoul(optarg, NULL, 0); break;
+		case 'l': max_len = (unsigned)strtoul(optarg, NULL, 0); break;
+		case 'i': rate = (unsigned)strtoul(optarg, NULL, 0); break;
+		case 'm': mode = (strcmp(optarg, "trim") == 0) ? 1 : 0; break;
+		default:
+			fprintf(stderr, "usage: %s [-w writers] [-n records] [-s size] [-l len] [-i rate] [-m skip|trim]\n", argv[0]);
+			return 2;
+		}
+	}
+	if(num_writers == 0 || num_writers > STRESS_MAX_WRITERS || size < 2 || size > STRESS_MAX_BUF
+	   || max_len > STRESS_MAX_LEN || rate > 1000000) {
+		fprintf(stderr, "out of range: 1..%u writers, 2..%u bytes, len <= %u, rate <= 1000000\n",
+				STRESS_MAX_WRITERS, STRESS_MAX_BUF, STRESS_MAX_LEN);
+		return 2;
+	}
+	SEGGER_RTT_Init();
+	if(map_shm() != 0) {
+		fprintf(stderr, "RTT is not in shared memory, see host/rtt_shm.c\n");
+		return 2;
+	}
+	// only the writers take the signal, the reader and this thread are the host side
+	sigemptyset(&set);
+	sigaddset(&set, SIGALRM);
+	pthread_sigmask(SIG_BLOCK, &set, NULL);
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = irq;
+	sigaction(SIGALRM, &sa, NULL);
+
+	printf("mode  writers   size        irqs        full     trimmed     dropped         bytes  errors\n");
+	if(mode != 1) {
+		bad |= run(SEGGER_RTT_MODE_NO_BLOCK_SKIP, size, rate);
+	}
+	if(mode != 0) {
+		bad |= run(SEGGER_RTT_MODE_NO_BLOCK_TRIM, size, rate);
+	}
+	return bad;
+}
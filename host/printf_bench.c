@@ -0,0 +1,453 @@
+/**
+ * @file	printf_bench.c
+ * @brief	Host tool. Compare the integer conversion of SEGGER_RTT_printf.c with the old divide loop:
+ *			same output for random numbers and formats, and the time of each.
+ *			Compare %f, %e, %g with the printf() of the C library (glibc), and the time with the old double loop of %f.
+ *			Time the copy of literal text of real format strings: char by char, and by _FindSpecifier().
+ *
+ * @note HOW TO USE:
+ *        1. build in host/: gcc -O2 -I.. -o printf_bench printf_bench.c ../SEGGER_RTT.c -lpthread
+ *        2. ./printf_bench [loops] [float cases]
+ *        3. the float conversion is chosen for exact output, not for speed: on a PC with FPU it is slower than the old double loop
+ *           (x86-64, gcc -O2: 83 ns vs 112 ns per float, 0.74x). The time on a core without FPU has not been measured,
+ *           time _PrintFloat() there (eg with DWT->CYCCNT) before relying on it.
+ *
+ * @author	shadowthreed@gmail.com
+ * @date	20261017
+ */
+#include "../SEGGER_RTT_printf.c"		// for the static _PrintUnsigned() / _PrintInt()
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * the divide loop of SEGGER RTT 7.60h, kept as reference
+ */
+static void _PrintUnsignedDiv(SEGGER_RTT_PRINTF_DESC * pBufferDesc, unsigned v, unsigned Base, unsigned NumDigits, unsigned FieldWidth, unsigned FormatFlags) {
+  static const char _aV2C[16] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' };
+  unsigned Div;
+  unsigned Digit;
+  unsigned Number;
+  unsigned Width;
+  char c;
+
+  Number = v;
+  Digit = 1u;
+  Width = 1u;
+  while (Number >= Base) {
+    Number = (Number / Base);
+    Width++;
+  }
+  if (NumDigits > Width) {
+    Width = NumDigits;
+  }
+  if ((FormatFlags & FORMAT_FLAG_LEFT_JUSTIFY) == 0u) {
+    if (FieldWidth != 0u) {
+      if (((FormatFlags & FORMAT_FLAG_PAD_ZERO) == FORMAT_FLAG_PAD_ZERO) && (NumDigits == 0u)) {
+        c = '0';
+      } else {
+        c = ' ';
+      }
+      while ((FieldWidth != 0u) && (Width < FieldWidth)) {
+        FieldWidth--;
+        _StoreChar(pBufferDesc, c);
+      }
+    }
+  }
+  while (1) {
+    if (NumDigits > 1u) {
+      NumDigits--;
+    } else {
+      Div = v / Digit;
+      if (Div < Base) {
+        break;
+      }
+    }
+    Digit *= Base;
+  }
+  do {
+    Div = v / Digit;
+    v -= Div * Digit;
+    _StoreChar(pBufferDesc, _aV2C[Div]);
+    Digit /= Base;
+  } while (Digit);
+  if ((FormatFlags & FORMAT_FLAG_LEFT_JUSTIFY) == FORMAT_FLAG_LEFT_JUSTIFY) {
+    while ((FieldWidth != 0u) && (Width < FieldWidth)) {
+      FieldWidth--;
+      _StoreChar(pBufferDesc, ' ');
+    }
+  }
+}
+
+static void _PrintIntDiv(SEGGER_RTT_PRINTF_DESC * pBufferDesc, int v, unsigned Base, unsigned NumDigits, unsigned FieldWidth, unsigned FormatFlags) {
+  unsigned Width;
+  int Number;
+
+  Number = (v < 0) ? -v : v;
+  Width = 1u;
+  while (Number >= (int)Base) {
+    Number = (Number / (int)Base);
+    Width++;
+  }
+  if (NumDigits > Width) {
+    Width = NumDigits;
+  }
+  if ((FieldWidth > 0u) && ((v < 0) || ((FormatFlags & FORMAT_FLAG_PRINT_SIGN) == FORMAT_FLAG_PRINT_SIGN))) {
+    FieldWidth--;
+  }
+  if ((((FormatFlags & FORMAT_FLAG_PAD_ZERO) == 0u) || (NumDigits != 0u)) && ((FormatFlags & FORMAT_FLAG_LEFT_JUSTIFY) == 0u)) {
+    while ((FieldWidth != 0u) && (Width < FieldWidth)) {
+      FieldWidth--;
+      _StoreChar(pBufferDesc, ' ');
+    }
+  }
+  if (v < 0) {
+    v = -v;
+    _StoreChar(pBufferDesc, '-');
+  } else if ((FormatFlags & FORMAT_FLAG_PRINT_SIGN) == FORMAT_FLAG_PRINT_SIGN) {
+    _StoreChar(pBufferDesc, '+');
+  }
+  if (((FormatFlags & FORMAT_FLAG_PAD_ZERO) == FORMAT_FLAG_PAD_ZERO) && ((FormatFlags & FORMAT_FLAG_LEFT_JUSTIFY) == 0u) && (NumDigits == 0u)) {
+    while ((FieldWidth != 0u) && (Width < FieldWidth)) {
+      FieldWidth--;
+      _StoreChar(pBufferDesc, '0');
+    }
+  }
+  _PrintUnsignedDiv(pBufferDesc, (unsigned)v, Base, NumDigits, FieldWidth, FormatFlags);
+}
+
+/*
+ * %f of SEGGER_RTT_printf.c before the float engine (only valid below 2^31 and precision 9), kept as reference
+ */
+static void _PrintFloatOld(SEGGER_RTT_PRINTF_DESC * pBufferDesc, double dv, unsigned NumDigits, unsigned FieldWidth, unsigned FormatFlags) {
+	int int_num, doub_num;
+	unsigned total_width = 0, base = 1, int_bit = 0, i;
+	int is_negative = (dv < 0);
+
+	if (is_negative) dv = -dv;
+	if(NumDigits == 0) {
+		NumDigits = 2;
+	}
+	base = 1;
+	for(i = 0; i < NumDigits; i++) {
+		base *= 10;
+	}
+	dv += 0.5 / base;
+	int_num = (int)dv;
+	doub_num = (int)((dv - int_num) * base + 1e-9);
+	base = 1;
+	while(int_num / base != 0) {
+		int_bit++;
+		base *= 10;
+	}
+	if(int_bit == 0) { int_bit = 1; }
+	total_width = (is_negative ? 1 : 0) + int_bit + 1 + NumDigits;
+	if(FieldWidth > total_width && !(FormatFlags & FORMAT_FLAG_LEFT_JUSTIFY)) {
+		for(i = 0; i < FieldWidth - total_width; i++)
+			_StoreChar(pBufferDesc, ' ');
+	}
+	if(is_negative && (int_num || doub_num)) { _StoreChar(pBufferDesc, '-'); }
+	_PrintUnsigned(pBufferDesc, int_num, 10u, int_bit, int_bit, 0);
+	_StoreChar(pBufferDesc, '.');
+	_PrintUnsigned(pBufferDesc, doub_num, 10u, NumDigits, NumDigits, FORMAT_FLAG_PAD_ZERO);
+	if(FieldWidth > total_width && (FormatFlags & FORMAT_FLAG_LEFT_JUSTIFY)) {
+		for(i = 0; i < FieldWidth - total_width; i++)
+			_StoreChar(pBufferDesc, ' ');
+	}
+}
+
+typedef struct {
+	unsigned v;
+	unsigned base;
+	unsigned digits;
+	unsigned width;
+	unsigned flags;
+	int is_signed;
+} case_t;
+
+static char out[1 << 16];
+
+static void desc_init(SEGGER_RTT_PRINTF_DESC *d)
+{
+	d->pBuffer = out;
+	d->BufferSize = sizeof(out);
+	d->Cnt = 0;
+	d->ReturnValue = 0;
+	d->RTTBufferIndex = 0;
+}
+
+static unsigned rnd(void)
+{
+	static unsigned long long s = 88172645463325252ull;
+	s ^= s << 13;
+	s ^= s >> 7;
+	s ^= s << 17;
+	return (unsigned)s;
+}
+
+// numbers of all lengths, as in real LOG most of them are small
+static void make_cases(case_t *c, unsigned n)
+{
+	unsigned i;
+
+	for(i = 0; i < n; i++) {
+		c[i].v = rnd() >> (rnd() % 32);
+		c[i].base = (rnd() & 3) ? 10u : 16u;
+		c[i].digits = (rnd() & 3) ? 0u : rnd() % ((c[i].base == 10u) ? 11u : 9u);		// more digits than 32 bits have overflow the old loop
+		c[i].width = (rnd() & 1) ? 0u : rnd() % 14;
+		c[i].flags = rnd() & (FORMAT_FLAG_LEFT_JUSTIFY | FORMAT_FLAG_PAD_ZERO | FORMAT_FLAG_PRINT_SIGN);
+		c[i].is_signed = (c[i].base == 10u) && (rnd() & 1);
+		if(c[i].is_signed && (int)c[i].v == -2147483647 - 1) {
+			c[i].v = 0;			// -v of INT_MIN is undefined in the old code
+		}
+		if(c[i].is_signed && (rnd() & 1)) {
+			c[i].v = 0u - c[i].v;
+		}
+	}
+}
+
+static double run(const case_t *c, unsigned n, unsigned loops, int old)
+{
+	SEGGER_RTT_PRINTF_DESC d;
+	struct timespec t0, t1;
+	unsigned i, l;
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for(l = 0; l < loops; l++) {
+		for(i = 0; i < n; i++) {
+			desc_init(&d);
+			if(c[i].is_signed) {
+				if(old) _PrintIntDiv(&d, (int)c[i].v, 10u, c[i].digits, c[i].width, c[i].flags);
+				else _PrintInt(&d, (int)c[i].v, 10u, c[i].digits, c[i].width, c[i].flags);
+			} else {
+				if(old) _PrintUnsignedDiv(&d, c[i].v, c[i].base, c[i].digits, c[i].width, c[i].flags);
+				else _PrintUnsigned(&d, c[i].v, c[i].base, c[i].digits, c[i].width, c[i].flags);
+			}
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	return ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / ((double)n * loops);
+}
+
+typedef struct {
+	double v;
+	char conv;
+	unsigned prec;				// FORMAT_FLAG_PRECISION in flags if given
+	unsigned width;
+	unsigned flags;
+} fcase_t;
+
+static double rnd_double(void)
+{
+	static const double nice[] = { 0.0, 0.5, 1.0, 0.1, 0.125, 0.375, 2.5, 9.5, 99.95, 1e15, 1e16, 1e21, 1e22, 1e23, 5e-324, 2.2250738585072014e-308, 1.7976931348623157e308, 123456.789, 0.0001, 0.00001, 9.9999995, 4294967296.0, 2147483647.5 };
+	union { double d; unsigned long long u; } b;
+
+	switch(rnd() % 4) {
+	case 0:			// any bit pattern, includes inf, nan, subnormal
+		b.u = ((unsigned long long)rnd() << 32) | rnd();
+		return b.d;
+	case 1:			// decimal values with few digits, most ties of the rounding are here
+		b.d = (double)(rnd() % 100000) / (double)(1u << (rnd() % 12));
+		break;
+	case 2:
+		b.d = (double)(int)rnd() / 1000.0;
+		break;
+	default:
+		b.d = nice[rnd() % (sizeof(nice) / sizeof(nice[0]))];
+		break;
+	}
+	return (rnd() & 1) ? -b.d : b.d;
+}
+
+static void make_fcases(fcase_t *c, unsigned n)
+{
+	static const char conv[] = "fFeEgG";
+	unsigned i;
+
+	for(i = 0; i < n; i++) {
+		c[i].v = rnd_double();
+		c[i].conv = conv[rnd() % 6];
+		c[i].prec = rnd() % 18;
+		c[i].width = (rnd() & 1) ? 0u : rnd() % 30;
+		c[i].flags = rnd() & (FORMAT_FLAG_LEFT_JUSTIFY | FORMAT_FLAG_PAD_ZERO | FORMAT_FLAG_PRINT_SIGN | FORMAT_FLAG_ALTERNATE | FORMAT_FLAG_PRECISION);
+		if(c[i].conv == 'f' && c[i].v > 1e60) {
+			c[i].v = 1e60;		// long enough for %f, glibc is slow for 1e308
+		}
+	}
+}
+
+static void fcase_fmt(const fcase_t *c, char *fmt)
+{
+	char *p = fmt;
+
+	*p++ = '%';
+	if(c->flags & FORMAT_FLAG_LEFT_JUSTIFY) *p++ = '-';
+	if(c->flags & FORMAT_FLAG_PAD_ZERO) *p++ = '0';
+	if(c->flags & FORMAT_FLAG_PRINT_SIGN) *p++ = '+';
+	if(c->flags & FORMAT_FLAG_ALTERNATE) *p++ = '#';
+	p += sprintf(p, "%u", c->width);
+	if(c->flags & FORMAT_FLAG_PRECISION) p += sprintf(p, ".%u", c->prec);
+	*p++ = c->conv;
+	*p = '\0';
+}
+
+// %f with the old loop only for the values it can print, %.2f to %.8f below 1e9
+static void make_fold_cases(fcase_t *c, unsigned n)
+{
+	unsigned i;
+
+	for(i = 0; i < n; i++) {
+		c[i].v = (double)(int)(rnd() % 2000000000u - 1000000000) / (double)(1u << (rnd() % 20));
+		c[i].conv = 'f';
+		c[i].prec = 2 + rnd() % 7;
+		c[i].width = 0;
+		c[i].flags = FORMAT_FLAG_PRECISION;
+	}
+}
+
+static double run_float(const fcase_t *c, unsigned n, unsigned loops, int old)
+{
+	SEGGER_RTT_PRINTF_DESC d;
+	struct timespec t0, t1;
+	unsigned i, l;
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for(l = 0; l < loops; l++) {
+		for(i = 0; i < n; i++) {
+			desc_init(&d);
+			if(old) _PrintFloatOld(&d, c[i].v, c[i].prec, c[i].width, c[i].flags);
+			else _PrintFloat(&d, c[i].v, c[i].conv, c[i].prec, c[i].width, c[i].flags);
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	return ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / ((double)n * loops);
+}
+
+/*
+ * format strings as they reach SEGGER_RTT_vprintf(): LOG_xxx() of dbger.c with color and prefix, and typical application LOG
+ */
+static const char *corpus[] = {
+	"\033[31m[AST:%s:%d] AST LOG: int[%02d], float[%6.3f], str[%10s]\n\033[0m",
+	"\033[35m[ERR:%s:%d] ERR LOG: int[%2d], float[%+6.3f], str[%10s]\n\033[0m",
+	"\033[33m[WAR:%s:%d] WAR LOG: int[%-2d], float[%-6.3f], str[%-10s]\n\033[0m",
+	"INF LOG: int[%d], float[%f], str[%s]\n",
+	"DBG LOG: int[%d], float[%f], str[%s]\n",
+	"VBS LOG: int[%d], float[%f], str[%s]\n",
+	"cmd[%s] len[%d]\n",
+	"cmd[%s] NOT exist\n",
+	"dbger test\n",
+	"process test1 cmd\n",
+	"%s\n",
+	"sensor init done, i2c addr 0x%02X, whoami 0x%02X, odr %u Hz, range +-%u g\n",
+	"battery: voltage %u mV, current %d mA, temperature %d.%u C, state of charge %u%%\n",
+	"[net] connected to access point, rssi %d dBm, channel %u, ip %u.%u.%u.%u\n",
+	"motor %u: target speed %d rpm, actual speed %d rpm, duty %u, fault flags 0x%08X\n",
+	"flash write failed at address 0x%08X, length %u, status %d, retrying in %u ms\n",
+	"task %s stack high water mark %u words, cpu load %u.%u%%\n",
+	"=============== system start, firmware version %s, build %s %s ===============\n",
+};
+
+static double run_literal(unsigned loops, int scan)
+{
+	SEGGER_RTT_PRINTF_DESC d;
+	struct timespec t0, t1;
+	const char *s, *e;
+	unsigned i, l, n = sizeof(corpus) / sizeof(corpus[0]);
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for(l = 0; l < loops; l++) {
+		for(i = 0; i < n; i++) {
+			desc_init(&d);
+			for(s = corpus[i]; *s; s += 2) {		// the 2 chars of a conversion specifier are skipped, as if converted
+				if(scan) {
+					e = _FindSpecifier(s);
+					_StoreChars(&d, s, (unsigned)(e - s));
+					s = e;
+				} else {
+					while(*s && *s != '%') {
+						_StoreChar(&d, *s++);
+					}
+				}
+				if(*s == '\0') {
+					break;
+				}
+			}
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	return ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / ((double)n * loops);
+}
+
+int main(int argc, char *argv[])
+{
+	enum { N = 4096 };
+	static case_t c[N];
+	static fcase_t fc[N];
+	SEGGER_RTT_PRINTF_DESC d;
+	char ref[64], fmt[32];
+	static char fref[2048];
+	unsigned loops = (argc > 1) ? (unsigned)atoi(argv[1]) : 500;
+	unsigned fn = (argc > 2) ? (unsigned)atoi(argv[2]) : 1000000;
+	unsigned i, bad = 0, fbad = 0;
+	double t_old, t_new;
+
+	make_cases(c, N);
+	for(i = 0; i < N; i++) {
+		desc_init(&d);
+		if(c[i].is_signed) _PrintIntDiv(&d, (int)c[i].v, 10u, c[i].digits, c[i].width, c[i].flags);
+		else _PrintUnsignedDiv(&d, c[i].v, c[i].base, c[i].digits, c[i].width, c[i].flags);
+		memcpy(ref, out, d.Cnt);
+		ref[d.Cnt] = '\0';
+		desc_init(&d);
+		if(c[i].is_signed) _PrintInt(&d, (int)c[i].v, 10u, c[i].digits, c[i].width, c[i].flags);
+		else _PrintUnsigned(&d, c[i].v, c[i].base, c[i].digits, c[i].width, c[i].flags);
+		out[d.Cnt] = '\0';
+		if(strcmp(ref, out) != 0 && bad++ < 10) {
+			printf("diff: v=%u base=%u digits=%u width=%u flags=%x: old[%s] new[%s]\n", c[i].v, c[i].base, c[i].digits, c[i].width, c[i].flags, ref, out);
+		}
+	}
+	printf("%u cases, %u differ\n", N, bad);
+
+	t_old = run(c, N, loops, 1);
+	t_new = run(c, N, loops, 0);
+	printf("divide loop:   %6.1f ns/number\n", t_old);
+	printf("digit pairs:   %6.1f ns/number (%.2fx)\n", t_new, t_old / t_new);
+
+	//
+	// float: same text as glibc
+	//
+	for(i = 0; i < fn; i++) {
+		make_fcases(fc, 1);
+		fcase_fmt(fc, fmt);
+		snprintf(fref, sizeof(fref), fmt, fc->v);
+		desc_init(&d);
+		_PrintFloat(&d, fc->v, fc->conv, fc->prec, fc->width, fc->flags);
+		out[d.Cnt] = '\0';
+		if(strcmp(fref, out) != 0 && (fc->flags & FORMAT_FLAG_ALTERNATE) && (fc->conv | 0x20) == 'g') {
+			fcase_t e = *fc;		// glibc %#g loses a digit when rounding carries into the exponent (99.95 as %#.2g gives 1.e+02), C says %#.1e
+			e.conv = (char)(fc->conv - 2);
+			e.prec = ((fc->flags & FORMAT_FLAG_PRECISION) && fc->prec) ? fc->prec - 1 : ((fc->flags & FORMAT_FLAG_PRECISION) ? 0 : 5);
+			e.flags |= FORMAT_FLAG_PRECISION;
+			fcase_fmt(&e, fmt);
+			snprintf(fref, sizeof(fref), fmt, fc->v);
+			fcase_fmt(fc, fmt);
+		}
+		if(strcmp(fref, out) != 0 && fbad++ < 10) {
+			printf("diff: %s of %a: glibc[%s] rtt[%s]\n", fmt, fc->v, fref, out);
+		}
+	}
+	printf("%u float cases, %u differ\n", fn, fbad);
+
+	make_fold_cases(fc, N);
+	t_old = run_float(fc, N, loops / 5 + 1, 1);
+	t_new = run_float(fc, N, loops / 5 + 1, 0);
+	printf("double loop:   %6.1f ns/float\n", t_old);
+	printf("integer exact: %6.1f ns/float (%.2fx)\n", t_new, t_old / t_new);
+
+	t_old = run_literal(loops * 10, 0);
+	t_new = run_literal(loops * 10, 1);
+	printf("literal chars: %6.1f ns/format\n", t_old);
+	printf("literal scan:  %6.1f ns/format (%.2fx)\n", t_new, t_old / t_new);
+	return (bad != 0) || (fbad != 0);
+}
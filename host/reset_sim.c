@@ -0,0 +1,165 @@
+/**
+ * @file	reset_sim.c
+ * @brief	Host tool. Checks that the post-mortem up-buffer (SEGGER_RTT_POSTMORTEM) survives a reset.
+ *			A child process is the target before the reset: it boots (SEGGER_RTT_Init(), SEGGER_RTT_ConfigPostMortem())
+ *			and writes numbered lines until it is killed at a random time, like by a watchdog, or until it aborts.
+ *			Then the parent is the target after the reset: it boots on the same memory, which is shared by host/rtt_shm.c,
+ *			and reads the up-buffer. The lines kept must be in order without a gap and end with the last line written,
+ *			only the first one may be cut. Each reset continues the numbering, so the lines kept over several resets are checked too.
+ *			At the end the magic is cleared, the buffer must start empty like after power-on.
+ *
+ * @note HOW TO USE:
+ *        1. build in host/: gcc -O2 -I.. -I. -DSEGGER_RTT_POSTMORTEM=1 -DSEGGER_RTT_SECTION='"rtt_shm"' -o reset_sim reset_sim.c rtt_shm.c ../SEGGER_RTT.c -lpthread -lrt
+ *        2. ./reset_sim [-n resets] [-k us] [-l lines]
+ *              -n resets     number of resets (Default: 200)
+ *              -k us         max. time until the target is killed, 0: the target writes <lines> lines, then abort() (Default: 2000)
+ *              -l lines      lines written before abort() with -k 0 (Default: 1000)
+ *        3. a line for each failed reset and a summary, exit code 1 if any reset failed.
+ *
+ * @author	shadowthreed@gmail.com
+ * @date	20261017
+ */
+#include "SEGGER_RTT.h"
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SIM_CH			1
+#define SIM_LINE_LEN	64
+
+// next line to write, shared with the target like _SEGGER_RTT, the target counts it after the line is written
+static volatile unsigned sim_next __attribute__((section("rtt_shm")));
+
+static unsigned sim_line(char *buf, unsigned seq)
+{
+	return (unsigned)snprintf(buf, SIM_LINE_LEN, "line %u %.*s\n", seq, (int)(seq % 23u), "abcdefghijklmnopqrstuvw");
+}
+
+// the target before the reset
+static void sim_target(unsigned lines)
+{
+	char buf[SIM_LINE_LEN];
+	unsigned seq, end = sim_next + lines;
+
+	SEGGER_RTT_Init();
+	SEGGER_RTT_ConfigPostMortem(SIM_CH, "pm");
+	for(seq = sim_next; lines == 0 || seq != end; seq++) {
+		SEGGER_RTT_WritePostMortem(buf, sim_line(buf, seq));
+		sim_next = seq + 1u;
+	}
+	abort();			// "hard fault"
+}
+
+/**
+ * @brief	the target after the reset: check what is kept
+ * @return	0 ok, -1 lost or out of order
+ */
+static int sim_check(unsigned reset, unsigned *kept)
+{
+	static char data[SEGGER_RTT_POSTMORTEM_SIZE + 1];
+	char expect[SIM_LINE_LEN];
+	unsigned next = sim_next, len, n, seq, last = 0;
+	int r, lines = 0;
+	char *p, *end;
+	pthread_mutexattr_t attr;
+
+	// startup code: the variables next to section "rtt_shm" share its pages with the dead target, the lock may be held
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);		// as SEGGER_RTT.c sets it up before main()
+	pthread_mutex_init(&SEGGER_RTT_Mutex, &attr);
+	pthread_mutexattr_destroy(&attr);
+	SEGGER_RTT_Init();
+	r = SEGGER_RTT_ConfigPostMortem(SIM_CH, "pm");
+	len = SEGGER_RTT_ReadUpBufferNoLock(SIM_CH, data, sizeof(data));
+	*kept = len;
+	if(r < 0 || (unsigned)r != len) {
+		printf("reset %u: %d bytes kept, %u read\n", reset, r, len);
+		return -1;
+	}
+	data[len] = '\0';
+	p = memchr(data, '\n', len);		// the first line may be cut by the overwrite
+	for(p = p ? p + 1 : data + len; p < data + len; p = end + 1) {
+		end = memchr(p, '\n', data + len - p);
+		if(end == NULL || sscanf(p, "line %u", &seq) != 1) {
+			printf("reset %u: garbage at %u\n", reset, (unsigned)(p - data));
+			return -1;
+		}
+		n = sim_line(expect, seq);
+		if(n != (unsigned)(end + 1 - p) || memcmp(p, expect, n) != 0 || (lines && seq != last + 1u)) {
+			printf("reset %u: line %u after line %u, %.*s", reset, seq, last, (int)(end + 1 - p), p);
+			return -1;
+		}
+		last = seq;
+		lines++;
+	}
+	// the last line is the one counted last, or one more which was written but not counted yet
+	if(next && (!lines || (last + 1u != next && last != next))) {
+		printf("reset %u: last line %u kept, %u written\n", reset, last, next);
+		return -1;
+	}
+	if(lines) {
+		sim_next = last + 1u;			// the next boot goes on after what is kept
+	}
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned resets = 200, kill_us = 2000, lines = 1000, i, kept, failed = 0;
+	unsigned long long kept_sum = 0;
+	unsigned seed = (unsigned)time(NULL);
+	int opt, r;
+
+	while((opt = getopt(argc, argv, "n:k:l:")) != -1) {
+		switch(opt) {
+		case 'n': resets = (unsigned)strtoul(optarg, NULL, 0); break;
+		case 'k': kill_us = (unsigned)strtoul(optarg, NULL, 0); break;
+		case 'l': lines = (unsigned)strtoul(optarg, NULL, 0); break;
+		default:
+			fprintf(stderr, "usage: %s [-n resets] [-k us] [-l lines]\n", argv[0]);
+			return 1;
+		}
+	}
+	signal(SIGABRT, SIG_DFL);
+	for(i = 0; i < resets; i++) {
+		pid_t pid = fork();
+
+		if(pid < 0) {
+			perror("fork");
+			return 1;
+		}
+		if(pid == 0) {
+			sim_target(kill_us ? 0 : lines);
+		}
+		if(kill_us) {
+			struct timespec ts = { 0, (long)(rand_r(&seed) % kill_us) * 1000 };
+
+			nanosleep(&ts, NULL);
+			kill(pid, SIGKILL);
+		}
+		waitpid(pid, NULL, 0);
+		if(sim_check(i, &kept) != 0) {
+			failed++;
+		}
+		kept_sum += kept;
+	}
+	//
+	// power-on: the RAM holds anything but a valid buffer
+	//
+	_SEGGER_RTT_PostMortem.Magic ^= 1u;
+	SEGGER_RTT_Init();
+	r = SEGGER_RTT_ConfigPostMortem(SIM_CH, "pm");
+	if(r != 0) {
+		printf("power-on: %d bytes kept\n", r);
+		failed++;
+	}
+	printf("%u resets, %u lines written, %llu bytes kept on average of %u, %u failed\n", resets, sim_next,
+		   resets ? kept_sum / resets : 0, SEGGER_RTT_POSTMORTEM_SIZE - 1u, failed);
+	return failed ? 1 : 0;
+}
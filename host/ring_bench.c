@@ -0,0 +1,144 @@
+/**
+ * @file	ring_bench.c
+ * @brief	Host tool. Cycles per call of the RTT up-buffer write paths, to compare the
+ *			compare-and-reset wrap-around with the masked one of SEGGER_RTT_BUFFER_SIZE_POW2.
+ *			The buffer is drained between the timed batches like J-Link does, so all wrap-around positions are hit.
+ *			The check value of the drained data must be the same for both builds.
+ *
+ * @note HOW TO USE:
+ *        1. build in host/ twice:
+ *              gcc -O2 -I.. -DSEGGER_RTT_BUFFER_SIZE_POW2=0 -o ring_bench      ring_bench.c ../SEGGER_RTT.c -lpthread
+ *              gcc -O2 -I.. -DSEGGER_RTT_BUFFER_SIZE_POW2=1 -o ring_bench_pow2 ring_bench.c ../SEGGER_RTT.c -lpthread
+ *        2. ./ring_bench [loops] [buffer size] and ./ring_bench_pow2 [loops] [buffer size]
+ *        cycles are TSC cycles on x86 and ns elsewhere. On a Cortex-M the gain is larger,
+ *        a taken branch costs a pipeline refill there and the loads of SizeOfBuffer are not cached.
+ *
+ * @author	shadowthreed@gmail.com
+ * @date	20261017
+ */
+#include "SEGGER_RTT.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#define BENCH_CH		1
+#define BENCH_BATCH		64			// calls between two drains
+#define BENCH_MAX_LEN	32
+
+static char ring[1 << 16];
+static uint8_t lens[4096];			// same message lengths for both builds
+static uint32_t check;
+
+static uint64_t now(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+#endif
+}
+
+// what J-Link does: read all, the data goes into the check value (FNV-1a)
+static void drain(void)
+{
+	char buf[256];
+	unsigned n, i;
+
+	while((n = SEGGER_RTT_ReadUpBufferNoLock(BENCH_CH, buf, sizeof(buf))) != 0) {
+		for(i = 0; i < n; i++) {
+			check = (check ^ (uint8_t)buf[i]) * 16777619u;
+		}
+	}
+}
+
+static unsigned op_skip(unsigned i, const char *msg)
+{
+	return SEGGER_RTT_WriteSkipNoLock(BENCH_CH, msg, lens[i & 4095]);
+}
+
+static unsigned op_write(unsigned i, const char *msg)
+{
+	return SEGGER_RTT_WriteNoLock(BENCH_CH, msg, lens[i & 4095]);
+}
+
+static unsigned op_putchar(unsigned i, const char *msg)
+{
+	return SEGGER_RTT_PutCharSkipNoLock(BENCH_CH, msg[i & 31]);
+}
+
+static unsigned op_reserve(unsigned i, const char *msg)
+{
+	SEGGER_RTT_RESERVATION res;
+	unsigned n = SEGGER_RTT_ReserveNoLock(BENCH_CH, lens[i & 4095], &res);
+
+	memcpy((void*)res.pData0, msg, res.NumBytes0);
+	memcpy((void*)res.pData1, msg + res.NumBytes0, res.NumBytes1);
+	SEGGER_RTT_CommitNoLock(BENCH_CH, n);
+	return n;
+}
+
+static unsigned op_avail(unsigned i, const char *msg)
+{
+	(void)msg;
+	SEGGER_RTT_PutCharSkipNoLock(BENCH_CH, (char)i);		// move WrOff, else the branch is always predicted
+	return SEGGER_RTT_GetAvailWriteSpace(BENCH_CH);
+}
+
+static void run(const char *name, unsigned (*op)(unsigned, const char *), unsigned flags, unsigned size, unsigned loops)
+{
+	static const char msg[BENCH_MAX_LEN * 2] = "0123456789abcdefghijklmnopqrstuvwxyz0123456789ABCDEFGHIJKLMNOPQR";
+	uint64_t cycles = 0, t;
+	unsigned i, j, sum = 0;
+
+	check = 2166136261u;
+	if(SEGGER_RTT_ConfigUpBuffer(BENCH_CH, "bench", ring, size, flags) < 0) {
+		fprintf(stderr, "buffer size %u is not supported by this build\n", size);
+		exit(1);
+	}
+	for(i = 0; i < loops; i += BENCH_BATCH) {
+		drain();
+		t = now();
+		for(j = i; j < i + BENCH_BATCH; j++) {
+			sum += op(j, msg);
+		}
+		cycles += now() - t;
+	}
+	drain();
+	printf("%-28s %7.2f cycles/call   stored %10u   check %08x\n", name, (double)cycles / loops, sum, (unsigned)check);
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned loops = argc > 1 ? (unsigned)strtoul(argv[1], NULL, 0) : 10000000u;
+	unsigned size = argc > 2 ? (unsigned)strtoul(argv[2], NULL, 0) : 4096u;
+	unsigned i, seed = 1;
+
+	if(size < 2 || size > sizeof(ring)) {
+		fprintf(stderr, "buffer size 2 .. %u\n", (unsigned)sizeof(ring));
+		return 1;
+	}
+	for(i = 0; i < sizeof(lens); i++) {
+		seed = seed * 1103515245u + 12345u;
+		lens[i] = 1 + (seed >> 16) % BENCH_MAX_LEN;
+	}
+	SEGGER_RTT_Init();
+	printf("SEGGER_RTT_BUFFER_SIZE_POW2 %d, buffer %u bytes, %u calls\n", SEGGER_RTT_BUFFER_SIZE_POW2, size, loops);
+	run("WriteSkipNoLock", op_skip, SEGGER_RTT_MODE_NO_BLOCK_SKIP, size, loops);
+	run("WriteNoLock (TRIM)", op_write, SEGGER_RTT_MODE_NO_BLOCK_TRIM, size, loops);
+	if(size > BENCH_BATCH * BENCH_MAX_LEN) {		// a batch must fit, nobody drains while it blocks
+		run("WriteNoLock (BLOCK)", op_write, SEGGER_RTT_MODE_BLOCK_IF_FIFO_FULL, size, loops);
+	}
+	run("PutCharSkipNoLock", op_putchar, SEGGER_RTT_MODE_NO_BLOCK_SKIP, size, loops);
+	run("ReserveNoLock + CommitNoLock", op_reserve, SEGGER_RTT_MODE_NO_BLOCK_TRIM, size, loops);
+	run("GetAvailWriteSpace", op_avail, SEGGER_RTT_MODE_NO_BLOCK_SKIP, size, loops);
+	return 0;
+}
@@ -0,0 +1,328 @@
+/**
+ * @file	rtt_bench.c
+ * @brief	Host tool. Throughput, latency and drops of the RTT write modes, with a simulated J-Link reading the up-buffer:
+ *			SKIP, TRIM and BLOCK (SEGGER_RTT_Write()) and OVERWRITE (SEGGER_RTT_WriteWithOverwriteNoLock()),
+ *			for each message length, buffer size and drain rate.
+ *			The writer floods the buffer, the reader thread polls at a fixed rate and reads at most the drain rate.
+ *
+ *			bytes/s and msgs/s are what the reader got (msgs/s counts the message ends), latency is per write call;
+ *			drop is the part of the written bytes which never reached the reader (not stored, trimmed or overwritten).
+ *			The buffer size is the size of up-buffer 1, set by SEGGER_RTT_ConfigUpBuffer(), the same code as BUFFER_SIZE_UP of buffer 0.
+ *
+ * @note HOW TO USE:
+ *        1. build in host/: gcc -O2 -I.. -o rtt_bench rtt_bench.c ../SEGGER_RTT.c -lpthread
+ *        2. ./rtt_bench [-m lens] [-s sizes] [-d rates] [-r rate] [-t seconds] [-f csv|json] [-o file]
+ *              -m lens       message lengths (Default: 16,64,256)
+ *              -s sizes      buffer sizes (Default: 1024,4096,16384)
+ *              -d rates      drain rates in bytes/s, 0: no limit (Default: 0,1000000,100000)
+ *              -r rate       reader polls per second (Default: 1000)
+ *              -t seconds    time of each case (Default: 0.2)
+ *              -f csv|json   format of the results (Default: csv)
+ *              -o file       results into file (Default: stdout)
+ *        3. one line (csv) or object (json) per case, eg to track the numbers between releases:
+ *              ./rtt_bench -f json -o rtt_bench_760h.json
+ *
+ * @author	shadowthreed@gmail.com
+ * @date	20261017
+ */
+#include "SEGGER_RTT.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#define BENCH_CH		1
+#define BENCH_MAX_BUF	(1u << 20)
+#define BENCH_MAX_LEN	4096
+#define BENCH_MAX_CALLS	(4u << 20)		// latencies kept for the percentiles
+#define BENCH_MAX_LIST	16
+
+enum { MODE_SKIP, MODE_TRIM, MODE_BLOCK, MODE_OVERWRITE, MODE_NUM };
+static const char *const mode_name[MODE_NUM] = { "skip", "trim", "block", "overwrite" };
+static const unsigned mode_flags[MODE_NUM] = {
+	SEGGER_RTT_MODE_NO_BLOCK_SKIP, SEGGER_RTT_MODE_NO_BLOCK_TRIM, SEGGER_RTT_MODE_BLOCK_IF_FIFO_FULL, SEGGER_RTT_MODE_NO_BLOCK_SKIP
+};
+
+typedef struct {
+	const char *mode;
+	unsigned msg_len, buf_size, drain, poll;
+	uint64_t calls;
+	double bytes_s, msgs_s, p50, p99, p999, drop;
+} result_t;
+
+static char ring[BENCH_MAX_BUF];
+static uint32_t *lat;					// ticks of each call
+static double ns_per_tick = 1.0;
+
+static struct {
+	unsigned drain, poll;
+	volatile int writing;				// 0: read all what is left and stop
+	uint64_t bytes;
+	uint64_t msgs;						// whole messages, each one ends with '\n'
+} rd;
+
+static uint64_t ticks(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+#endif
+}
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static void calibrate(void)
+{
+	uint64_t t0 = now_ns(), c0 = ticks(), t1, c1;
+	struct timespec ts = { 0, 50000000 };
+
+	nanosleep(&ts, NULL);
+	t1 = now_ns();
+	c1 = ticks();
+	ns_per_tick = (double)(t1 - t0) / (double)(c1 - c0);
+}
+
+// what J-Link does in one poll, offsets out of range are skipped: SEGGER_RTT_WriteWithOverwriteNoLock() moves <RdOff> in steps
+static unsigned read_up(char *dst, unsigned max)
+{
+	SEGGER_RTT_BUFFER_UP *ring = &_SEGGER_RTT.aUp[BENCH_CH];
+	unsigned size = ring->SizeOfBuffer;
+	unsigned wr = __atomic_load_n(&ring->WrOff, __ATOMIC_ACQUIRE);
+	unsigned rd = ring->RdOff;
+	unsigned n, first;
+
+	if(wr >= size || rd >= size) {
+		return 0;
+	}
+	n = (wr >= rd) ? (wr - rd) : (size - rd + wr);
+	n = (n < max) ? n : max;
+	first = (n < size - rd) ? n : (size - rd);
+	memcpy(dst, ring->pBuffer + rd, first);
+	memcpy(dst + first, ring->pBuffer, n - first);
+	rd += n;
+	__atomic_store_n(&ring->RdOff, (rd >= size) ? rd - size : rd, __ATOMIC_RELEASE);
+	return n;
+}
+
+// J-Link: poll at a fixed rate, read at most the drain rate (token bucket), no lock
+static void *reader(void *arg)
+{
+	static char buf[BENCH_MAX_BUF];
+	uint64_t next = now_ns(), last = next, period = 1000000000u / rd.poll;
+	double tokens = 0;
+
+	(void)arg;
+	for(;;) {
+		int writing = rd.writing;
+		unsigned max = sizeof(buf), n, i;
+		struct timespec ts;
+
+		if(rd.drain && writing) {
+			uint64_t t = now_ns();
+
+			tokens += (double)(t - last) * rd.drain / 1e9;
+			if(tokens > rd.drain / 10.0 + 1) {
+				tokens = rd.drain / 10.0 + 1;
+			}
+			last = t;
+			max = (tokens < max) ? (unsigned)tokens : max;
+		}
+		n = read_up(buf, max);
+		tokens -= n;
+		for(i = 0; i < n; i++) {
+			rd.msgs += (buf[i] == '\n');
+		}
+		__atomic_store_n(&rd.bytes, rd.bytes + n, __ATOMIC_RELEASE);
+		if(!writing && n == 0) {
+			break;
+		}
+		if(writing) {
+			next += period;
+			ts.tv_sec = (time_t)(next / 1000000000u);
+			ts.tv_nsec = (long)(next % 1000000000u);
+			clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+		}
+	}
+	return NULL;
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+
+	return (x > y) - (x < y);
+}
+
+static double pct(uint64_t n, double p)
+{
+	return n ? lat[(uint64_t)(p * (n - 1))] * ns_per_tick : 0;
+}
+
+static void run(result_t *r, unsigned mode, unsigned msg_len, unsigned buf_size, unsigned drain, unsigned poll, double seconds)
+{
+	char msg[BENCH_MAX_LEN];
+	uint64_t t_start, t_end, n = 0, offered = 0, got, got_msgs;
+	pthread_t th;
+
+	memset(msg, 'a' + mode, msg_len - 1);
+	msg[msg_len - 1] = '\n';
+	SEGGER_RTT_ConfigUpBuffer(BENCH_CH, "bench", ring, buf_size, mode_flags[mode]);
+	rd.drain = drain;
+	rd.poll = poll;
+	rd.bytes = 0;
+	rd.msgs = 0;
+	rd.writing = 1;
+	pthread_create(&th, NULL, reader, NULL);
+	t_start = now_ns();
+	t_end = t_start + (uint64_t)(seconds * 1e9);
+	do {
+		uint64_t c = ticks();
+
+		if(mode == MODE_OVERWRITE) {
+			SEGGER_RTT_LOCK();
+			SEGGER_RTT_WriteWithOverwriteNoLock(BENCH_CH, msg, msg_len);
+			SEGGER_RTT_UNLOCK();
+		} else {
+			SEGGER_RTT_Write(BENCH_CH, msg, msg_len);
+		}
+		c = ticks() - c;
+		lat[n++] = (c > UINT32_MAX) ? UINT32_MAX : (uint32_t)c;
+		offered += msg_len;
+	} while(n < BENCH_MAX_CALLS && ((n & 63) || now_ns() < t_end));
+	t_end = now_ns();
+	got = __atomic_load_n(&rd.bytes, __ATOMIC_ACQUIRE);		// the rate is what was read during the case, not the rest read after it
+	got_msgs = rd.msgs;
+	rd.writing = 0;
+	pthread_join(th, NULL);
+	qsort(lat, n, sizeof(*lat), cmp_u32);
+	r->mode = mode_name[mode];
+	r->msg_len = msg_len;
+	r->buf_size = buf_size;
+	r->drain = drain;
+	r->poll = poll;
+	r->calls = n;
+	r->bytes_s = got / ((t_end - t_start) / 1e9);
+	r->msgs_s = got_msgs / ((t_end - t_start) / 1e9);
+	r->p50 = pct(n, 0.5);
+	r->p99 = pct(n, 0.99);
+	r->p999 = pct(n, 0.999);
+	r->drop = (offered > rd.bytes) ? (double)(offered - rd.bytes) / offered : 0;
+}
+
+static unsigned parse_list(const char *s, unsigned *v)
+{
+	unsigned n = 0;
+	char *end;
+
+	while(n < BENCH_MAX_LIST && *s) {
+		v[n++] = (unsigned)strtoul(s, &end, 0);
+		s = (*end == ',') ? end + 1 : end;
+		if(end == s && *s) {
+			break;
+		}
+	}
+	return n;
+}
+
+static void print(FILE *f, const result_t *r, int json, int first)
+{
+	if(json) {
+		fprintf(f, "%s  {\"mode\": \"%s\", \"msg_len\": %u, \"buf_size\": %u, \"drain_bps\": %u, \"poll_hz\": %u, \"calls\": %llu, "
+				   "\"bytes_s\": %.0f, \"msgs_s\": %.0f, \"p50_ns\": %.1f, \"p99_ns\": %.1f, \"p999_ns\": %.1f, \"drop\": %.6f}",
+				first ? "" : ",\n", r->mode, r->msg_len, r->buf_size, r->drain, r->poll, (unsigned long long)r->calls,
+				r->bytes_s, r->msgs_s, r->p50, r->p99, r->p999, r->drop);
+	} else {
+		if(first) {
+			fprintf(f, "mode,msg_len,buf_size,drain_bps,poll_hz,calls,bytes_s,msgs_s,p50_ns,p99_ns,p999_ns,drop\n");
+		}
+		fprintf(f, "%s,%u,%u,%u,%u,%llu,%.0f,%.0f,%.1f,%.1f,%.1f,%.6f\n", r->mode, r->msg_len, r->buf_size, r->drain, r->poll,
+				(unsigned long long)r->calls, r->bytes_s, r->msgs_s, r->p50, r->p99, r->p999, r->drop);
+	}
+	fflush(f);
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned lens[BENCH_MAX_LIST] = { 16, 64, 256 }, sizes[BENCH_MAX_LIST] = { 1024, 4096, 16384 }, drains[BENCH_MAX_LIST] = { 0, 1000000, 100000 };
+	unsigned num_len = 3, num_size = 3, num_drain = 3, poll = 1000;
+	unsigned m, l, s, d;
+	double seconds = 0.2;
+	int json = 0, first = 1, a;
+	FILE *f = stdout;
+
+	for(a = 1; a + 1 < argc && argv[a][0] == '-'; a += 2) {
+		switch(argv[a][1]) {
+		case 'm': num_len = parse_list(argv[a + 1], lens); break;
+		case 's': num_size = parse_list(argv[a + 1], sizes); break;
+		case 'd': num_drain = parse_list(argv[a + 1], drains); break;
+		case 'r': poll = (unsigned)strtoul(argv[a + 1], NULL, 0); break;
+		case 't': seconds = atof(argv[a + 1]); break;
+		case 'f': json = (strcmp(argv[a + 1], "json") == 0); break;
+		case 'o':
+			f = fopen(argv[a + 1], "w");
+			if(f == NULL) {
+				perror(argv[a + 1]);
+				return 1;
+			}
+			break;
+		default:
+			a = argc;
+			break;
+		}
+	}
+	if(a < argc || poll == 0) {
+		fprintf(stderr, "usage: %s [-m lens] [-s sizes] [-d rates] [-r rate] [-t seconds] [-f csv|json] [-o file]\n", argv[0]);
+		return 1;
+	}
+	for(l = 0; l < num_len; l++) {
+		for(s = 0; s < num_size; s++) {
+			if(lens[l] < 1 || lens[l] > BENCH_MAX_LEN || sizes[s] < 2 || sizes[s] > BENCH_MAX_BUF) {
+				fprintf(stderr, "message length 1 .. %u, buffer size 2 .. %u\n", BENCH_MAX_LEN, BENCH_MAX_BUF);
+				return 1;
+			}
+		}
+	}
+	lat = malloc(BENCH_MAX_CALLS * sizeof(*lat));
+	if(lat == NULL) {
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+	calibrate();
+	SEGGER_RTT_Init();
+	if(json) {
+		fprintf(f, "[\n");
+	}
+	for(m = 0; m < MODE_NUM; m++) {
+		for(l = 0; l < num_len; l++) {
+			for(s = 0; s < num_size; s++) {
+				for(d = 0; d < num_drain; d++) {
+					result_t r;
+
+					run(&r, m, lens[l], sizes[s], drains[d], poll, seconds);
+					print(f, &r, json, first);
+					first = 0;
+				}
+			}
+		}
+	}
+	if(json) {
+		fprintf(f, "\n]\n");
+	}
+	return 0;
+}
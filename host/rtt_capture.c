@@ -0,0 +1,784 @@
+/**
+ * @file	rtt_capture.c
+ * @brief	Host tool. Capture all RTT up-buffers of a target into one file, also bursts which the J-Link RTT Viewer cannot keep up with.
+ *			The control block is found by its ID "SEGGER RTT" in the shared memory of host/rtt_shm.c, in the memory of
+ *			a running Linux process (/proc/<pid>/mem), or in a raw memory dump (eg J-Link savebin), and the up-buffers
+ *			are read through <RdOff>/<WrOff> like rtt_probe does. The target is polled without pause while data comes.
+ *			The data is appended to a memory-mapped capture file in chunks, each with its channel, terminal and time.
+ *			Channel 0 is split by the terminal switches 0xFF + '0'..'F' (SEGGER_RTT_SetTerminal(), SEGGER_RTT_TerminalOut()),
+ *			the stamps of LOG_TIME (0xFF 'T' / 'H' + varint) are kept in the data for host/dbger_time.c.
+ *
+ *			capture file: cap_head_t, then the chunks, each cap_chunk_t + data padded to CAP_ALIGN.
+ *			<end> of cap_head_t is written after the chunks of each poll, a reader stops there, the rest of the file is not written yet.
+ *
+ * @note HOW TO USE:
+ *        1. build: gcc -O2 -o rtt_capture rtt_capture.c -lrt
+ *        2. capture: ./rtt_capture [-n name | -p pid | -m dump[@addr]] [-w 4|8] [-r rate] [-q] file.cap
+ *              -n name       shared memory object of host/rtt_shm.c (Default: env RTT_SHM_NAME or /dbger_rtt)
+ *              -p pid        a process which runs RTT in its memory, the up-buffers are read and <RdOff> written by /proc/<pid>/mem,
+ *                            this needs the right to ptrace it (same user with kernel.yama.ptrace_scope 0, or root),
+ *                            what is written after the last poll is lost with the memory of the process when it exits
+ *              -m dump@addr  raw memory dump, <addr> is the target address of its first byte (Default: 0), read once from <RdOff> to <WrOff>
+ *              -w 4|8        pointer size of the dump, 4: Cortex-M (Default: 4, -n and -p: the host)
+ *              -r rate       polls per second while the target sends nothing (Default: 1000)
+ *              -q            no statistics on stderr at the end
+ *           the capture waits for the control block, and stops when the target process is gone and all up-buffers are empty,
+ *           or by Ctrl-C. The statistics count the polls which found an up-buffer full, data may be lost there.
+ *        3. read: ./rtt_capture -x [-c chan] [-t term] [-s] [-f] file.cap
+ *              -c chan       up-buffer (Default: 0)
+ *              -t term       only terminal <term> of channel 0 (Default: all)
+ *              -s            print the time a line was read in front of it, in seconds since the start of the capture
+ *              -f            follow a capture which is still running, like tail -f
+ *           eg: ./rtt_capture -x -f file.cap | ./dbger_time,   ./rtt_capture -x -c 2 file.cap > ch2.bin; ./dbger_decode fw.elf ch2.bin
+ *
+ * @author	shadowthreed@gmail.com
+ * @date	20261017
+ */
+#define _GNU_SOURCE			// mremap()
+#include "rtt_shm.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define CAP_MAGIC		0x50414352u		// "RCAP"
+#define CAP_VERSION		1u
+#define CAP_ALIGN		8u
+#define CAP_GROW		(64u << 20)		// the file grows by this, and is mapped again
+#define CAP_MAX_BUF		16				// up-buffers which are read
+#define CAP_NO_TERM		0xFFu			// terminal of the channels other than 0
+#define CAP_FIND_BLOCK	(1u << 20)		// /proc/<pid>/mem is searched in blocks
+
+typedef struct {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t head_len;			// offset of the first chunk
+	uint32_t num_up;			// up-buffers captured
+	uint64_t start_ns;			// CLOCK_REALTIME at the start of the capture
+	uint64_t end;				// end of the last complete chunk
+	uint32_t done;				// 1: the capture is complete
+	uint32_t res;
+} cap_head_t;
+
+typedef struct {
+	uint64_t t_ns;				// time of the poll which read the data, since <start_ns>
+	uint32_t len;				// data which follows
+	uint8_t chan;
+	uint8_t term;				// terminal of channel 0 (0..15), CAP_NO_TERM
+	uint8_t res[2];
+} cap_chunk_t;
+
+// the RTT buffer descriptor as read from the target
+typedef struct {
+	uint64_t addr;				// target address of the descriptor
+	uint64_t pBuffer;
+	unsigned SizeOfBuffer;
+	unsigned WrOff;
+	unsigned RdOff;
+} cap_up_t;
+
+typedef struct {
+	uint64_t bytes;
+	uint64_t chunks;
+	uint64_t polls_full;		// polls which found the buffer full
+} cap_stat_t;
+
+enum { SRC_SHM, SRC_PROC, SRC_DUMP };
+
+static const char terminal_id[16] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' };
+
+static int src = SRC_SHM;
+static unsigned ptr_size = sizeof(void *);
+static const rtt_shm_head_t *head;		// SRC_SHM
+static size_t map_len;
+static uint8_t *mem;					// SRC_SHM, SRC_DUMP: target memory, mem[0] is target address mem_base
+static uint64_t mem_base, mem_len;
+static pid_t pid;						// SRC_PROC, SRC_SHM: target process
+static int mem_fd = -1;					// SRC_PROC: /proc/<pid>/mem
+
+static int cap_fd = -1;
+static uint8_t *cap;					// the capture file, mapped
+static size_t cap_len;
+static uint64_t cap_end;				// end of the chunks written, published to cap_head_t <end> after each poll
+
+static uint8_t *data, *out;				// data read from an up-buffer, the same with the terminal switches removed
+static unsigned data_len;
+static unsigned term0;					// channel 0: active terminal
+static int esc0, var0;					// channel 0: 0xFF read, in the varint after 0xFF 'T' / 'H'
+static uint8_t held0[24];				// channel 0: stamps 0xFF 'T' / 'H' + varint not followed by a byte yet
+static unsigned held0_len;
+static cap_stat_t stats[CAP_MAX_BUF];
+
+static volatile sig_atomic_t stop;
+
+static uint64_t now_ns(clockid_t clk)
+{
+	struct timespec ts;
+
+	clock_gettime(clk, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static void on_signal(int sig)
+{
+	(void)sig;
+	stop = 1;
+}
+
+/*********************************************************************
+*
+*       target
+*/
+static int tgt_read(uint64_t addr, void *buf, size_t len)
+{
+	if(src == SRC_PROC) {
+		return (pread(mem_fd, buf, len, (off_t)addr) == (ssize_t)len) ? 0 : -1;
+	}
+	if(addr < mem_base || addr - mem_base > mem_len || len > mem_len - (addr - mem_base)) {
+		return -1;
+	}
+	memcpy(buf, mem + (addr - mem_base), len);
+	return 0;
+}
+
+// the dump is a snapshot, <RdOff> is not written back
+static void tgt_write_u32(uint64_t addr, uint32_t v)
+{
+	if(src == SRC_PROC) {
+		if(pwrite(mem_fd, &v, sizeof(v), (off_t)addr) != (ssize_t)sizeof(v)) {
+			stop = 1;			// the process is gone
+		}
+	} else if(src == SRC_SHM && addr >= mem_base && addr + sizeof(v) <= mem_base + mem_len) {
+		__atomic_store_n((uint32_t *)(mem + (addr - mem_base)), v, __ATOMIC_RELEASE);
+	}
+}
+
+static int target_alive(void)
+{
+	if(src == SRC_DUMP) {
+		return 0;
+	}
+	return !(kill(pid, 0) != 0 && errno == ESRCH);
+}
+
+static int map_shm(const char *name)
+{
+	struct stat st;
+	void *p;
+	int fd = shm_open(name, O_RDWR, 0);
+
+	if(fd < 0) {
+		return -1;
+	}
+	if(fstat(fd, &st) != 0 || (size_t)st.st_size < RTT_SHM_HEAD_LEN) {		// target between shm_open() and ftruncate()
+		close(fd);
+		return -1;
+	}
+	p = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if(p == MAP_FAILED) {
+		return -1;
+	}
+	head = p;
+	map_len = st.st_size;
+	if(head->magic != RTT_SHM_MAGIC || head->head_len + head->len > (uint64_t)st.st_size) {
+		munmap(p, map_len);
+		head = NULL;
+		return -1;
+	}
+	mem = (uint8_t *)p + head->head_len;
+	mem_base = head->base;
+	mem_len = head->len;
+	pid = head->pid;
+	return 0;
+}
+
+static int map_dump(const char *arg)
+{
+	char path[256];
+	const char *at = strrchr(arg, '@');
+	struct stat st;
+	void *p;
+	int fd;
+
+	snprintf(path, sizeof(path), "%.*s", at ? (int)(at - arg) : (int)strlen(arg), arg);
+	mem_base = at ? strtoull(at + 1, NULL, 0) : 0;
+	fd = open(path, O_RDONLY);
+	if(fd < 0 || fstat(fd, &st) != 0 || st.st_size == 0) {
+		perror(path);
+		return -1;
+	}
+	p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(p == MAP_FAILED) {
+		perror(path);
+		return -1;
+	}
+	mem = p;
+	mem_len = st.st_size;
+	return 0;
+}
+
+static int find_id_at(const uint8_t *p)
+{
+	static const char id[] = "SEGGER RTT";
+	int num_up, num_down;
+
+	if(memcmp(p, id, sizeof(id)) != 0) {
+		return 0;
+	}
+	memcpy(&num_up, p + 16, sizeof(num_up));
+	memcpy(&num_down, p + 20, sizeof(num_down));
+	return num_up > 0 && num_up <= 256 && num_down >= 0 && num_down <= 256;		// the ID alone may be a copy of the string
+}
+
+/**
+ * @brief	find the control block, the ID is written last by SEGGER_RTT_Init()
+ * @return	target address of the control block, 0 not found
+ */
+static uint64_t find_cb(void)
+{
+	static uint8_t block[CAP_FIND_BLOCK + 32];
+	char path[64], line[512];
+	uint64_t addr = 0, i;
+	FILE *maps;
+
+	if(src != SRC_PROC) {
+		for(i = 0; i + 32 <= mem_len; i += sizeof(int)) {
+			if(find_id_at(mem + i)) {
+				return mem_base + i;
+			}
+		}
+		return 0;
+	}
+	//
+	// the writable mappings of the process, in blocks which overlap by the size of the head of the control block
+	//
+	snprintf(path, sizeof(path), "/proc/%d/maps", (int)pid);
+	maps = fopen(path, "r");
+	if(maps == NULL) {
+		return 0;
+	}
+	while(addr == 0 && fgets(line, sizeof(line), maps)) {
+		unsigned long long start, end;
+		char perm[8];
+
+		if(sscanf(line, "%llx-%llx %7s", &start, &end, perm) != 3 || perm[0] != 'r' || perm[1] != 'w' || strstr(line, "[vvar")) {
+			continue;
+		}
+		for(; addr == 0 && start + 32 <= end; start += CAP_FIND_BLOCK) {
+			size_t len = (end - start < sizeof(block)) ? (size_t)(end - start) : sizeof(block);
+
+			if(tgt_read(start, block, len) != 0) {
+				break;
+			}
+			for(i = 0; i + 32 <= len; i += sizeof(int)) {
+				if(find_id_at(block + i)) {
+					addr = start + i;
+					break;
+				}
+			}
+		}
+	}
+	fclose(maps);
+	return addr;
+}
+
+static uint64_t get_ptr(const uint8_t *p)
+{
+	uint64_t v = 0;
+
+	memcpy(&v, p, ptr_size);		// little endian, like the targets of RTT
+	return v;
+}
+
+// up-buffer <idx> of the control block at <cb>, -1 it can not be read
+static int get_up(uint64_t cb, unsigned idx, cap_up_t *up)
+{
+	uint8_t d[32];					// sName, pBuffer, SizeOfBuffer, WrOff, RdOff, Flags
+	unsigned desc_len = 2 * ptr_size + 16;
+
+	up->addr = cb + 24 + (uint64_t)idx * desc_len;
+	if(tgt_read(up->addr, d, desc_len) != 0) {
+		return -1;
+	}
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);		// <WrOff> before the data
+	up->pBuffer = get_ptr(d + ptr_size);
+	memcpy(&up->SizeOfBuffer, d + 2 * ptr_size, sizeof(unsigned));
+	memcpy(&up->WrOff, d + 2 * ptr_size + 4, sizeof(unsigned));
+	memcpy(&up->RdOff, d + 2 * ptr_size + 8, sizeof(unsigned));
+	return 0;
+}
+
+/*********************************************************************
+*
+*       capture file
+*/
+static int cap_open(const char *path, unsigned num_up)
+{
+	cap_head_t *h;
+
+	cap_fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if(cap_fd < 0 || ftruncate(cap_fd, CAP_GROW) != 0) {
+		perror(path);
+		return -1;
+	}
+	cap = mmap(NULL, CAP_GROW, PROT_READ | PROT_WRITE, MAP_SHARED, cap_fd, 0);
+	if(cap == MAP_FAILED) {
+		perror(path);
+		return -1;
+	}
+	cap_len = CAP_GROW;
+	h = (cap_head_t *)cap;
+	h->version = CAP_VERSION;
+	h->head_len = sizeof(cap_head_t);
+	h->num_up = num_up;
+	h->start_ns = now_ns(CLOCK_REALTIME);
+	h->end = sizeof(cap_head_t);
+	cap_end = sizeof(cap_head_t);
+	__atomic_store_n(&h->magic, CAP_MAGIC, __ATOMIC_RELEASE);		// last, a reader waiting with -f takes the head
+	return 0;
+}
+
+// room for <len> bytes at <cap_end>, the file grows in steps of CAP_GROW
+static uint8_t *cap_room(size_t len)
+{
+	if(cap_end + len > cap_len) {
+		size_t new_len = cap_len + ((len + CAP_GROW - 1) / CAP_GROW) * CAP_GROW;
+		void *p;
+
+		if(ftruncate(cap_fd, new_len) != 0) {
+			return NULL;
+		}
+		p = mremap(cap, cap_len, new_len, MREMAP_MAYMOVE);
+		if(p == MAP_FAILED) {
+			return NULL;
+		}
+		cap = p;
+		cap_len = new_len;
+	}
+	return cap + cap_end;
+}
+
+static void cap_chunk(unsigned chan, unsigned term, uint64_t t, const uint8_t *buf, unsigned len)
+{
+	size_t n = sizeof(cap_chunk_t) + ((len + CAP_ALIGN - 1) & ~(CAP_ALIGN - 1));
+	uint8_t *p;
+	cap_chunk_t c;
+
+	if(len == 0) {
+		return;
+	}
+	p = cap_room(n);
+	if(p == NULL) {
+		perror("capture file");
+		stop = 1;
+		return;
+	}
+	memset(&c, 0, sizeof(c));
+	c.t_ns = t;
+	c.len = len;
+	c.chan = (uint8_t)chan;
+	c.term = (uint8_t)term;
+	memcpy(p, &c, sizeof(c));
+	memcpy(p + sizeof(c), buf, len);
+	cap_end += n;
+	stats[chan].chunks++;
+}
+
+// the chunks of the poll are complete
+static void cap_publish(void)
+{
+	__atomic_store_n(&((cap_head_t *)cap)->end, cap_end, __ATOMIC_RELEASE);
+}
+
+static void cap_close(void)
+{
+	((cap_head_t *)cap)->done = 1;
+	cap_publish();
+	munmap(cap, cap_len);
+	if(ftruncate(cap_fd, (off_t)cap_end) != 0) {
+		perror("capture file");
+	}
+	close(cap_fd);
+}
+
+// the held stamps go in front of the next byte of the line
+static unsigned put_held(unsigned o)
+{
+	memcpy(out + o, held0, held0_len);
+	o += held0_len;
+	held0_len = 0;
+	return o;
+}
+
+/**
+ * @brief	channel 0: one chunk for each terminal, the switches 0xFF + terminal id are removed.
+ *			0xFF 'T' / 'H' + varint are held until the next byte, a switch after them moves them to the terminal
+ *			of their line (LOG_AST/ERR/WAR). The sequences may be split over two polls.
+ */
+static void demux0(uint64_t t, const uint8_t *buf, unsigned len)
+{
+	unsigned i, o = 0;
+
+	for(i = 0; i < len; i++) {
+		uint8_t c = buf[i];
+		const char *id;
+
+		if(var0) {
+			if(held0_len == sizeof(held0)) {
+				o = put_held(o);			// no varint of LOG_TIME, keep it as data
+			}
+			held0[held0_len++] = c;
+			var0 = (c & 0x80) != 0;
+		} else if(esc0) {
+			esc0 = 0;
+			id = c ? memchr(terminal_id, c, sizeof(terminal_id)) : NULL;
+			if(id) {
+				cap_chunk(0, term0, t, out, o);
+				o = 0;
+				term0 = (unsigned)(id - terminal_id);
+			} else if((c == 'T' || c == 'H') && held0_len + 2u <= sizeof(held0)) {
+				held0[held0_len++] = 0xFF;
+				held0[held0_len++] = c;
+				var0 = 1;
+			} else {
+				o = put_held(o);
+				out[o++] = 0xFF;
+				out[o++] = c;
+			}
+		} else if(c == 0xFF) {
+			esc0 = 1;
+		} else {
+			o = put_held(o);
+			out[o++] = c;
+		}
+	}
+	cap_chunk(0, term0, t, out, o);
+}
+
+// read all from <RdOff> to <WrOff> into a chunk, then move <RdOff>
+static unsigned read_up(uint64_t cb, unsigned idx, uint64_t t)
+{
+	cap_up_t up;
+	unsigned size, rd, n, first;
+
+	if(get_up(cb, idx, &up) != 0) {
+		return 0;
+	}
+	size = up.SizeOfBuffer;
+	rd = up.RdOff;
+	if(up.pBuffer == 0 || size == 0 || up.WrOff >= size || rd >= size) {
+		return 0;			// not configured yet
+	}
+	n = (up.WrOff >= rd) ? (up.WrOff - rd) : (size - rd + up.WrOff);
+	if(n == 0) {
+		return 0;
+	}
+	if(n == size - 1u) {
+		stats[idx].polls_full++;
+	}
+	if(size + sizeof(held0) + 2u > data_len) {
+		uint8_t *d = realloc(data, size + sizeof(held0) + 2u), *o = realloc(out, size + sizeof(held0) + 2u);
+
+		if(d) {
+			data = d;
+		}
+		if(o) {
+			out = o;
+		}
+		if(d == NULL || o == NULL) {
+			return 0;
+		}
+		data_len = size + sizeof(held0) + 2u;
+	}
+	first = (n < size - rd) ? n : (size - rd);
+	if(tgt_read(up.pBuffer + rd, data, first) != 0 || tgt_read(up.pBuffer, data + first, n - first) != 0) {
+		return 0;
+	}
+	rd += n;
+	if(rd >= size) {
+		rd -= size;
+	}
+	tgt_write_u32(up.addr + 2 * ptr_size + 8, rd);
+	if(idx == 0) {
+		demux0(t, data, n);
+	} else {
+		cap_chunk(idx, CAP_NO_TERM, t, data, n);
+	}
+	stats[idx].bytes += n;
+	return n;
+}
+
+static int capture(const char *name, const char *path, unsigned long rate, int quiet)
+{
+	uint64_t cb = 0, t_start, t;
+	unsigned num_up, i, got;
+	int num;
+
+	//
+	// wait for the target and its control block, like J-Link searches the RAM until RTT is initialized
+	//
+	for(;;) {
+		struct timespec ts = { 0, 10000000 };
+
+		if(stop) {
+			return 1;
+		}
+		if(src == SRC_SHM && head == NULL && map_shm(name) != 0) {
+			nanosleep(&ts, NULL);
+			continue;
+		}
+		cb = find_cb();
+		if(src == SRC_DUMP) {
+			break;
+		}
+		if(!target_alive()) {
+			if(src == SRC_PROC) {
+				fprintf(stderr, "process %d is gone\n", (int)pid);
+				return 1;
+			}
+			munmap((void *)head, map_len);			// last run, wait for the next one
+			head = NULL;
+		} else if(cb) {
+			break;
+		}
+		nanosleep(&ts, NULL);
+	}
+	if(cb == 0) {
+		fprintf(stderr, "no RTT control block found\n");
+		return 1;
+	}
+	if(tgt_read(cb + 16, &num, sizeof(num)) != 0) {
+		return 1;
+	}
+	num_up = (num > CAP_MAX_BUF) ? CAP_MAX_BUF : (unsigned)num;
+	if(cap_open(path, num_up) != 0) {
+		return 1;
+	}
+	t_start = now_ns(CLOCK_MONOTONIC);
+	for(;;) {
+		int alive = target_alive();
+
+		t = now_ns(CLOCK_MONOTONIC) - t_start;
+		got = 0;
+		for(i = 0; i < num_up; i++) {
+			got += read_up(cb, i, t);
+		}
+		cap_publish();
+		if(stop || src == SRC_DUMP || (!alive && got == 0)) {			// nothing was left to read, the dump is read once
+			break;
+		}
+		if(got == 0 && rate) {			// poll again at once while data comes
+			struct timespec ts = { 0, (long)(1000000000u / rate) };
+
+			nanosleep(&ts, NULL);
+		}
+	}
+	cap_chunk(0, term0, t, held0, held0_len);			// a stamp without its line
+	cap_publish();
+	cap_close();
+	if(!quiet) {
+		double s = (now_ns(CLOCK_MONOTONIC) - t_start) / 1e9;
+
+		for(i = 0; i < num_up; i++) {
+			if(stats[i].bytes) {
+				fprintf(stderr, "up %u: %llu bytes in %llu chunks, %.0f bytes/s, full at %llu polls\n", i,
+						(unsigned long long)stats[i].bytes, (unsigned long long)stats[i].chunks,
+						s > 0 ? stats[i].bytes / s : 0.0, (unsigned long long)stats[i].polls_full);
+			}
+		}
+		fprintf(stderr, "%llu bytes captured in %.3f s\n", (unsigned long long)cap_end, s);
+	}
+	return 0;
+}
+
+/*********************************************************************
+*
+*       reading a capture
+*/
+// map the capture file again when it has grown past the mapping
+static const uint8_t *cap_map(int fd, size_t *len)
+{
+	struct stat st;
+	void *p;
+
+	if(fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(cap_head_t)) {
+		return NULL;
+	}
+	if(cap) {
+		munmap(cap, cap_len);
+	}
+	p = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	if(p == MAP_FAILED) {
+		cap = NULL;
+		return NULL;
+	}
+	cap = p;
+	cap_len = st.st_size;
+	*len = cap_len;
+	return cap;
+}
+
+/**
+ * @brief	skip the stamps of LOG_TIME at the start of a line, their varint may hold a '\n'.
+ *			demux0() writes them into the chunk of the byte which follows them.
+ */
+static const uint8_t *skip_stamps(const uint8_t *p, const uint8_t *e)
+{
+	while(e - p >= 2 && p[0] == 0xFF && (p[1] == 'T' || p[1] == 'H')) {
+		for(p += 2; p < e && (*p & 0x80); p++) {
+		}
+		if(p < e) {
+			p++;
+		}
+	}
+	return p;
+}
+
+static int extract(const char *path, int chan, int term, int stamp, int follow)
+{
+	const cap_head_t *h;
+	uint64_t pos, end;
+	size_t len = 0;
+	int bol = 1, fd;
+
+	for(;;) {				// -f: wait for the capture, it creates the file when the target is found
+		struct timespec ts = { 0, 10000000 };
+
+		fd = open(path, O_RDONLY);
+		if(fd >= 0 && cap_map(fd, &len) != NULL) {
+			h = (const cap_head_t *)cap;
+			if(__atomic_load_n(&h->magic, __ATOMIC_ACQUIRE) == CAP_MAGIC && h->version == CAP_VERSION) {
+				break;
+			}
+			if(!follow) {
+				fprintf(stderr, "%s: no capture file\n", path);
+				return 1;
+			}
+		} else if(!follow) {
+			perror(path);
+			return 1;
+		}
+		if(fd >= 0) {
+			close(fd);
+		}
+		if(stop) {
+			return 1;
+		}
+		nanosleep(&ts, NULL);
+	}
+	pos = h->head_len;
+	while(!stop) {
+		int done = __atomic_load_n(&h->done, __ATOMIC_ACQUIRE);
+
+		end = __atomic_load_n(&h->end, __ATOMIC_ACQUIRE);
+		if(end > len) {
+			if(cap_map(fd, &len) == NULL || end > len) {
+				fprintf(stderr, "%s: cut\n", path);
+				return 1;
+			}
+			h = (const cap_head_t *)cap;
+		}
+		while(pos + sizeof(cap_chunk_t) <= end) {
+			const cap_chunk_t *c = (const cap_chunk_t *)(cap + pos);
+			const uint8_t *p = (const uint8_t *)(c + 1), *e = p + c->len;
+
+			pos += sizeof(cap_chunk_t) + ((c->len + CAP_ALIGN - 1) & ~(CAP_ALIGN - 1));
+			if(c->chan != chan || (term >= 0 && c->term != term)) {
+				continue;
+			}
+			if(!stamp) {
+				fwrite(p, 1, c->len, stdout);
+				continue;
+			}
+			while(p < e) {			// the stamp in front of each line, with the time of the chunk where it starts
+				const uint8_t *q = bol ? skip_stamps(p, e) : p;
+				const uint8_t *nl = memchr(q, '\n', e - q);
+
+				if(bol) {
+					printf("[%12.6f] ", c->t_ns / 1e9);
+				}
+				q = nl ? nl + 1 : e;
+				fwrite(p, 1, q - p, stdout);
+				bol = (nl != NULL);
+				p = q;
+			}
+		}
+		fflush(stdout);
+		if(!follow || (done && pos >= end)) {
+			break;
+		}
+		{
+			struct timespec ts = { 0, 10000000 };
+
+			nanosleep(&ts, NULL);
+		}
+	}
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *name = getenv("RTT_SHM_NAME");
+	unsigned long rate = 1000;
+	int chan = 0, term = -1, stamp = 0, follow = 0, read_mode = 0, quiet = 0, ptr_given = 0, opt;
+
+	while((opt = getopt(argc, argv, "n:p:m:w:r:qxc:t:sf")) != -1) {
+		switch(opt) {
+		case 'n': src = SRC_SHM; name = optarg; break;
+		case 'p': src = SRC_PROC; pid = (pid_t)strtol(optarg, NULL, 0); break;
+		case 'm':
+			src = SRC_DUMP;
+			if(map_dump(optarg) != 0) {
+				return 1;
+			}
+			break;
+		case 'w': ptr_size = (unsigned)strtoul(optarg, NULL, 0); ptr_given = 1; break;
+		case 'r': rate = strtoul(optarg, NULL, 0); break;
+		case 'q': quiet = 1; break;
+		case 'x': read_mode = 1; break;
+		case 'c': chan = (int)strtol(optarg, NULL, 0); break;
+		case 't': term = (int)strtol(optarg, NULL, 16); break;
+		case 's': stamp = 1; break;
+		case 'f': follow = 1; break;
+		default:
+			optind = argc + 1;
+			break;
+		}
+	}
+	if(optind != argc - 1 || (ptr_size != 4 && ptr_size != 8)) {
+		fprintf(stderr, "usage: %s [-n name | -p pid | -m dump[@addr]] [-w 4|8] [-r rate] [-q] file.cap\n"
+						"       %s -x [-c chan] [-t term] [-s] [-f] file.cap\n", argv[0], argv[0]);
+		return 1;
+	}
+	signal(SIGINT, on_signal);
+	signal(SIGTERM, on_signal);
+	if(read_mode) {
+		return extract(argv[optind], chan, term, stamp, follow);
+	}
+	if(src == SRC_DUMP && !ptr_given) {
+		ptr_size = 4;
+	}
+	if(src == SRC_PROC) {
+		char path[64];
+
+		snprintf(path, sizeof(path), "/proc/%d/mem", (int)pid);
+		mem_fd = open(path, O_RDWR);
+		if(mem_fd < 0) {
+			perror(path);
+			return 1;
+		}
+	}
+	if(name == NULL) {
+		name = RTT_SHM_NAME;
+	}
+	return capture(name, argv[optind], rate, quiet);
+}
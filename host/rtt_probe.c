@@ -0,0 +1,376 @@
+/**
+ * @file	rtt_probe.c
+ * @brief	Host tool. Takes the place of J-Link for a target which runs on Linux with RTT in shared memory (host/rtt_shm.c):
+ *			finds the control block by its ID "SEGGER RTT", reads the up-buffers and writes the down-buffer 0
+ *			through <RdOff>/<WrOff> like the probe does, at a fixed polling rate and with an optional throughput cap.
+ *
+ * @note HOW TO USE:
+ *        1. build: gcc -O2 -o rtt_probe rtt_probe.c -lrt
+ *        2. ./rtt_probe [-n name] [-r rate] [-b bytes/s] [-o prefix] [-d] [-q]
+ *              -n name       shared memory object (Default: env RTT_SHM_NAME or /dbger_rtt)
+ *              -r rate       polls per second, 0: poll without pause (Default: 1000)
+ *              -b bytes/s    max. bytes read per second over all up-buffers, 0: no limit (Default: 0)
+ *              -o prefix     read all up-buffers, up-buffer N into file <prefix>N.bin (Default: only up-buffer 0, to stdout)
+ *              -d            read what is left by a target which has exited, eg after a crash, and stop
+ *              -q            no statistics on stderr at the end
+ *                            (with those counted by the target if it is built with SEGGER_RTT_STATS)
+ *           stdin is written to down-buffer 0, eg the RTT cmd of dbger: echo "log 3" | ./rtt_probe
+ *        3. the probe waits for a running target and its control block, and stops when the target process is gone
+ *           and all up-buffers are empty, or by Ctrl-C. The object of the last run is skipped, it is replaced by the next run.
+ *
+ * @author	shadowthreed@gmail.com
+ * @date	20261017
+ */
+#include "rtt_shm.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define PROBE_MAX_BUF	16			// up-buffers which are read
+#define PROBE_IN_LEN	4096		// stdin waiting for space in down-buffer 0
+
+static const rtt_shm_head_t *head;
+static size_t map_len;
+static uint8_t *mem;				// target memory, mem[0] is target address head->base
+static volatile sig_atomic_t stop;
+
+typedef struct {
+	FILE *out;
+	uint64_t bytes;
+	uint64_t polls_full;			// polls which found the buffer full
+} probe_up_t;
+
+static probe_up_t ups[PROBE_MAX_BUF];
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+// target address -> probe address, NULL if [addr, addr + len) is not in the shared memory
+static void *tgt(uintptr_t addr, size_t len)
+{
+	if(addr < head->base || addr - head->base > head->len || len > head->len - (addr - head->base)) {
+		return NULL;
+	}
+	return mem + (addr - head->base);
+}
+
+static void unmap(void)
+{
+	munmap((void *)head, map_len);
+	head = NULL;
+}
+
+static int target_alive(void)
+{
+	return !(kill(head->pid, 0) != 0 && errno == ESRCH);
+}
+
+static int map(const char *name)
+{
+	struct stat st;
+	void *p;
+	int fd = shm_open(name, O_RDWR, 0);
+
+	if(fd < 0) {
+		return -1;
+	}
+	if(fstat(fd, &st) != 0 || (size_t)st.st_size < RTT_SHM_HEAD_LEN) {		// target between shm_open() and ftruncate()
+		close(fd);
+		return -1;
+	}
+	p = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if(p == MAP_FAILED) {
+		return -1;
+	}
+	head = p;
+	map_len = st.st_size;
+	if(head->magic != RTT_SHM_MAGIC || head->head_len + head->len > (uint64_t)st.st_size) {
+		unmap();
+		return -1;
+	}
+	mem = (uint8_t *)p + head->head_len;
+	return 0;
+}
+
+// the ID is written last by SEGGER_RTT_Init(), when it is found the control block is valid
+static void *find_id(const char *id, size_t len, size_t size)
+{
+	size_t i;
+
+	for(i = 0; i + size <= head->len; i += sizeof(int)) {
+		if(memcmp(mem + i, id, len) == 0) {
+			return mem + i;
+		}
+	}
+	return NULL;
+}
+
+static rtt_shm_cb_t *find_cb(void)
+{
+	static const char id[] = "SEGGER RTT";
+
+	return find_id(id, sizeof(id), sizeof(rtt_shm_cb_t));
+}
+
+// statistics of the target (SEGGER_RTT_STATS), NULL if it is built without
+static rtt_shm_stats_t *find_stats(unsigned num_up)
+{
+	static const char id[] = "RTT STATS";
+	rtt_shm_stats_cb_t *s = find_id(id, sizeof(id), sizeof(rtt_shm_stats_cb_t));
+
+	if(s == NULL || (unsigned)s->MaxNumUpBuffers < num_up) {
+		return NULL;
+	}
+	return (rtt_shm_stats_t *)(s + 1);
+}
+
+// read up to <max> bytes from <RdOff> to <WrOff>, then move <RdOff>
+static unsigned read_up(unsigned idx, rtt_shm_buf_t *b, unsigned max)
+{
+	unsigned size = b->SizeOfBuffer;
+	unsigned wr = __atomic_load_n(&b->WrOff, __ATOMIC_ACQUIRE);
+	unsigned rd = b->RdOff;
+	unsigned n, first;
+	uint8_t *data = tgt(b->pBuffer, size);
+
+	if(data == NULL || wr >= size || rd >= size) {
+		return 0;			// not configured yet, or the buffer is not in the shared memory
+	}
+	n = (wr >= rd) ? (wr - rd) : (size - rd + wr);
+	if(n == size - 1u) {
+		ups[idx].polls_full++;
+	}
+	if(n > max) {
+		n = max;
+	}
+	if(n == 0) {
+		return 0;
+	}
+	first = (n < size - rd) ? n : (size - rd);
+	fwrite(data + rd, 1, first, ups[idx].out);
+	fwrite(data, 1, n - first, ups[idx].out);
+	rd += n;
+	if(rd >= size) {
+		rd -= size;
+	}
+	__atomic_store_n(&b->RdOff, rd, __ATOMIC_RELEASE);
+	ups[idx].bytes += n;
+	return n;
+}
+
+// write as much as fits into down-buffer 0, returns the bytes written
+static unsigned write_down(rtt_shm_buf_t *b, const uint8_t *src, unsigned len)
+{
+	unsigned size = b->SizeOfBuffer;
+	unsigned rd = __atomic_load_n(&b->RdOff, __ATOMIC_ACQUIRE);
+	unsigned wr = b->WrOff;
+	unsigned n, first;
+	uint8_t *data = tgt(b->pBuffer, size);
+
+	if(data == NULL || wr >= size || rd >= size) {
+		return 0;
+	}
+	n = (rd > wr) ? (rd - wr - 1u) : (size - 1u - wr + rd);
+	if(n > len) {
+		n = len;
+	}
+	first = (n < size - wr) ? n : (size - wr);
+	memcpy(data + wr, src, first);
+	memcpy(data, src + first, n - first);
+	wr += n;
+	if(wr >= size) {
+		wr -= size;
+	}
+	__atomic_store_n(&b->WrOff, wr, __ATOMIC_RELEASE);
+	return n;
+}
+
+static void on_signal(int sig)
+{
+	(void)sig;
+	stop = 1;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *name = getenv("RTT_SHM_NAME");
+	const char *prefix = NULL;
+	unsigned long rate = 1000, cap = 0;
+	int quiet = 0, dump = 0, in_open = 1, opt;
+	uint8_t in[PROBE_IN_LEN];
+	unsigned in_len = 0, first_up = 0;
+	uint64_t t_start, period, next, last;
+	double tokens = 0;
+	rtt_shm_cb_t *cb;
+	rtt_shm_buf_t *up, *down;
+	unsigned num_up, i;
+
+	while((opt = getopt(argc, argv, "n:r:b:o:dq")) != -1) {
+		switch(opt) {
+		case 'n': name = optarg; break;
+		case 'r': rate = strtoul(optarg, NULL, 0); break;
+		case 'b': cap = strtoul(optarg, NULL, 0); break;
+		case 'o': prefix = optarg; break;
+		case 'd': dump = 1; break;
+		case 'q': quiet = 1; break;
+		default:
+			fprintf(stderr, "usage: %s [-n name] [-r rate] [-b bytes/s] [-o prefix] [-d] [-q]\n", argv[0]);
+			return 1;
+		}
+	}
+	if(name == NULL) {
+		name = RTT_SHM_NAME;
+	}
+	signal(SIGINT, on_signal);
+	signal(SIGTERM, on_signal);
+	period = rate ? 1000000000u / rate : 0;
+	//
+	// wait for the target, like J-Link searches the RAM until RTT is initialized
+	//
+	for(;;) {
+		struct timespec ts = { 0, 10000000 };
+
+		if(stop) {
+			return 1;
+		}
+		if(head || map(name) == 0) {
+			cb = find_cb();
+			if(dump) {
+				if(cb == NULL) {
+					fprintf(stderr, "no RTT control block in %s\n", name);
+					return 1;
+				}
+				break;
+			}
+			if(!target_alive()) {
+				unmap();			// last run, wait for the next one
+			} else if(cb) {
+				break;
+			}
+		} else if(dump) {
+			perror(name);
+			return 1;
+		}
+		nanosleep(&ts, NULL);
+	}
+	num_up = (unsigned)cb->MaxNumUpBuffers;
+	up = (rtt_shm_buf_t *)(cb + 1);
+	down = up + num_up;
+	if(num_up > PROBE_MAX_BUF) {
+		num_up = PROBE_MAX_BUF;
+	}
+	for(i = 0; i < num_up; i++) {
+		if(prefix) {
+			char path[256];
+
+			snprintf(path, sizeof(path), "%s%u.bin", prefix, i);
+			ups[i].out = fopen(path, "wb");
+			if(ups[i].out == NULL) {
+				perror(path);
+				return 1;
+			}
+		} else if(i == 0) {
+			ups[i].out = stdout;
+		}
+	}
+	if(cb->MaxNumDownBuffers < 1) {
+		in_open = 0;
+	}
+	t_start = now_ns();
+	next = t_start;
+	last = t_start;
+	for(;;) {
+		int alive = !dump && target_alive();
+		unsigned got = 0, budget = ~0u;
+		//
+		// the cap is a budget of bytes, earned by the time since the last poll
+		//
+		if(cap) {
+			uint64_t t = now_ns();
+
+			tokens += (double)(t - last) * cap / 1e9;
+			if(tokens > cap / 10.0 + 1) {
+				tokens = cap / 10.0 + 1;		// no burst over 100 ms of throughput after a late poll
+			}
+			last = t;
+			budget = (unsigned)tokens;
+		}
+		for(i = 0; i < num_up; i++) {			// each poll starts with the next buffer, so a busy one does not starve the others
+			unsigned idx = (first_up + i) % num_up;
+			unsigned n;
+
+			if(ups[idx].out == NULL) {
+				continue;
+			}
+			n = read_up(idx, &up[idx], budget - got);
+			got += n;
+		}
+		first_up = (first_up + 1) % (num_up ? num_up : 1);
+		tokens -= got;
+		if(in_open && in_len < sizeof(in)) {
+			struct pollfd pfd = { STDIN_FILENO, POLLIN, 0 };
+
+			if(poll(&pfd, 1, 0) > 0) {
+				ssize_t n = read(STDIN_FILENO, in + in_len, sizeof(in) - in_len);
+
+				if(n > 0) {
+					in_len += (unsigned)n;
+				} else {
+					in_open = 0;		// EOF, eg stdin is a file or /dev/null
+				}
+			}
+		}
+		if(in_len) {
+			unsigned n = write_down(&down[0], in, in_len);
+
+			memmove(in, in + n, in_len - n);
+			in_len -= n;
+		}
+		fflush(NULL);
+		if(stop || (!alive && got == 0 && budget)) {		// nothing was left to read
+			break;
+		}
+		if(period) {
+			struct timespec ts;
+
+			next += period;
+			ts.tv_sec = (time_t)(next / 1000000000u);
+			ts.tv_nsec = (long)(next % 1000000000u);
+			clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+		} else {
+			next = now_ns();
+		}
+	}
+	if(!quiet) {
+		double s = (now_ns() - t_start) / 1e9;
+		const rtt_shm_stats_t *st = find_stats(num_up);
+
+		for(i = 0; i < num_up; i++) {
+			if(ups[i].out) {
+				fprintf(stderr, "up %u: %llu bytes, %.0f bytes/s, full at %llu polls\n", i,
+						(unsigned long long)ups[i].bytes, ups[i].bytes / s, (unsigned long long)ups[i].polls_full);
+			}
+			if(st && (ups[i].out || st[i].NumBytesWritten || st[i].NumMsgDropped)) {
+				fprintf(stderr, "up %u target: %u bytes written, %u messages (%u bytes) dropped, %u bytes trimmed, max fill %u of %u, blocked %u\n",
+						i, st[i].NumBytesWritten, st[i].NumMsgDropped, st[i].NumBytesDropped, st[i].NumBytesTrimmed,
+						st[i].MaxFill, up[i].SizeOfBuffer ? up[i].SizeOfBuffer - 1u : 0u, st[i].BlockedTime);
+			}
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,109 @@
+/**
+ * @file	rtt_shm.c
+ * @brief	Target side of RTT in POSIX shared memory, for running dbger on Linux (LOG_PLATFORM 1) without J-Link.
+ *			_SEGGER_RTT and the RTT buffers are placed in section "rtt_shm", whose pages are replaced by a shared mapping
+ *			of the same content at the same address before main(). host/rtt_probe.c reads them from another process.
+ *
+ * @note HOW TO USE:
+ *        1. build with the RTT section set and host/ in the include path, eg:
+ *              gcc -Ihost -I. -DSEGGER_RTT_SECTION='"rtt_shm"' -o app main.c dbger.c SEGGER_RTT.c SEGGER_RTT_printf.c host/rtt_shm.c -lpthread -lrt
+ *           buffers of the application given to SEGGER_RTT_ConfigUpBuffer() must be in the section too:
+ *              static char buf[1024] __attribute__((section("rtt_shm")));
+ *        2. environment:
+ *              RTT_SHM_NAME=/dbger_rtt     name of the shared memory object (Default: /dbger_rtt)
+ *              RTT_SHM_NOINIT=1            1: _SEGGER_RTT_PostMortem (SEGGER_RTT_POSTMORTEM) is taken from the object of the last run,
+ *                                          like no-init RAM over a reset, 0: it starts cleared, like after power-on (Default: 1)
+ *        3. ./app and host/rtt_probe in any order, the object is left for the probe when the app exits.
+ *
+ * @author	shadowthreed@gmail.com
+ * @date	20261017
+ */
+#include "rtt_shm.h"
+#include "SEGGER_RTT.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+extern char __start_rtt_shm[], __stop_rtt_shm[];		// by the linker for section "rtt_shm"
+
+#if SEGGER_RTT_POSTMORTEM
+// no-init RAM: the post-mortem buffer of the last run of the same program is at the same offset in its object,
+// its magic and CRC tell SEGGER_RTT_ConfigPostMortem() if it is valid
+static void rtt_shm_noinit(const char *name, uintptr_t start, uintptr_t len)
+{
+	uintptr_t off = (uintptr_t)&_SEGGER_RTT_PostMortem - start;
+	const char *env = getenv("RTT_SHM_NOINIT");
+	rtt_shm_head_t old;
+	int fd;
+
+	if((env && strcmp(env, "0") == 0) || off + sizeof(_SEGGER_RTT_PostMortem) > len) {
+		return;			// power-on, or SEGGER_RTT_POSTMORTEM_SECTION is not in the shared memory
+	}
+	fd = shm_open(name, O_RDONLY, 0);
+	if(fd < 0) {
+		return;
+	}
+	if(pread(fd, &old, sizeof(old), 0) == (ssize_t)sizeof(old) && old.magic == RTT_SHM_MAGIC && old.len == len) {
+		if(pread(fd, &_SEGGER_RTT_PostMortem, sizeof(_SEGGER_RTT_PostMortem), old.head_len + off) != (ssize_t)sizeof(_SEGGER_RTT_PostMortem)) {
+			memset(&_SEGGER_RTT_PostMortem, 0, sizeof(_SEGGER_RTT_PostMortem));
+		}
+	}
+	close(fd);
+}
+#endif
+
+int rtt_shm_attach(const char *name)
+{
+	uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+	uintptr_t start = (uintptr_t)__start_rtt_shm & ~(page - 1);
+	uintptr_t end = ((uintptr_t)__stop_rtt_shm + page - 1) & ~(page - 1);
+	rtt_shm_head_t head;
+	void *p;
+	int fd;
+
+	if(end == start || RTT_SHM_HEAD_LEN % page) {
+		errno = EINVAL;
+		return -1;
+	}
+	memset(&head, 0, sizeof(head));
+	head.magic = RTT_SHM_MAGIC;
+	head.head_len = RTT_SHM_HEAD_LEN;
+	head.base = start;
+	head.len = end - start;
+	head.pid = (int32_t)getpid();
+#if SEGGER_RTT_POSTMORTEM
+	rtt_shm_noinit(name, start, head.len);
+#endif
+	shm_unlink(name);			// a probe still reading the object of the last run keeps it, a new one is made
+	fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+	if(fd < 0) {
+		return -1;
+	}
+	// the pages may hold other variables next to the section, so take all of their content along
+	if(ftruncate(fd, RTT_SHM_HEAD_LEN + head.len) != 0
+	   || pwrite(fd, (const void *)start, head.len, RTT_SHM_HEAD_LEN) != (ssize_t)head.len
+	   || pwrite(fd, &head, sizeof(head), 0) != (ssize_t)sizeof(head)) {
+		close(fd);
+		return -1;
+	}
+	p = mmap((void *)start, head.len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, RTT_SHM_HEAD_LEN);
+	close(fd);
+	return (p == MAP_FAILED) ? -1 : 0;
+}
+
+__attribute__((constructor)) static void rtt_shm_init(void)
+{
+	const char *name = getenv("RTT_SHM_NAME");
+
+	if(name == NULL) {
+		name = RTT_SHM_NAME;
+	}
+	if(rtt_shm_attach(name) != 0) {
+		perror("rtt_shm");
+	}
+}
@@ -0,0 +1,82 @@
+/**
+ * @file	rtt_shm.h
+ * @brief	RTT in POSIX shared memory, the layout shared by the target side (host/rtt_shm.c)
+ *			and the host side (host/rtt_probe.c), which takes the place of J-Link.
+ *
+ *			The shared memory object is one page of rtt_shm_head_t, then the pages of the target which hold
+ *			section "rtt_shm" (_SEGGER_RTT and the RTT buffers), mapped at the same address in the target.
+ *			The pointers in the control block are target addresses, the probe translates them by <base>,
+ *			like J-Link knows the RAM range of the device.
+ *
+ * @author	shadowthreed@gmail.com
+ * @date	20261017
+ */
+#ifndef __RTT_SHM_H__
+#define __RTT_SHM_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+#define RTT_SHM_NAME		"/dbger_rtt"		// default name of the shared memory object, env RTT_SHM_NAME
+#define RTT_SHM_MAGIC		0x4D485352u		// "RSHM"
+#define RTT_SHM_HEAD_LEN	4096u			// one page, the target memory starts after it
+
+typedef struct {
+	uint32_t magic;
+	uint32_t head_len;			// offset of the target memory in the object
+	uint64_t base;				// target address of the first byte of the target memory
+	uint64_t len;				// length of the target memory
+	int32_t pid;				// target process, the probe stops when it is gone and all is read
+} rtt_shm_head_t;
+
+// SEGGER_RTT_BUFFER_UP / SEGGER_RTT_BUFFER_DOWN as seen by the probe, target and probe are built for the same host
+typedef struct {
+	uintptr_t sName;
+	uintptr_t pBuffer;
+	unsigned SizeOfBuffer;
+	unsigned WrOff;
+	unsigned RdOff;
+	unsigned Flags;
+} rtt_shm_buf_t;
+
+// head of SEGGER_RTT_CB, aUp[MaxNumUpBuffers] and aDown[MaxNumDownBuffers] follow
+typedef struct {
+	char acID[16];
+	int MaxNumUpBuffers;
+	int MaxNumDownBuffers;
+} rtt_shm_cb_t;
+
+// head of SEGGER_RTT_STATS_CB (target built with SEGGER_RTT_STATS), aUp[MaxNumUpBuffers] follow
+typedef struct {
+	char acID[16];
+	int MaxNumUpBuffers;
+} rtt_shm_stats_cb_t;
+
+// SEGGER_RTT_BUFFER_STATS
+typedef struct {
+	unsigned NumBytesWritten;
+	unsigned NumBytesDropped;
+	unsigned NumBytesTrimmed;
+	unsigned NumMsgDropped;
+	unsigned NumMsgLost;
+	unsigned MaxFill;
+	unsigned BlockedTime;
+} rtt_shm_stats_t;
+
+/**
+ * @brief	target side: move section "rtt_shm" into the shared memory object <name>.
+ *			Called by a constructor before main() with env RTT_SHM_NAME (or RTT_SHM_NAME above),
+ *			call it only for another name, before any thread is started.
+ * @return	0 ok, -1 error (errno), RTT keeps working in private memory
+ */
+int rtt_shm_attach(const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
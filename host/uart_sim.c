@@ -0,0 +1,122 @@
+/**
+ * @file	uart_sim.c
+ * @brief	Simulated UART1 with TX DMA for running LOG_BY_UART on Linux (LOG_PLATFORM 1).
+ *			A DMA transfer is done by a thread, which holds the data for the wire time and then
+ *			calls HAL_UART_TxCpltCallback() like the DMA interrupt does.
+ *
+ * @note HOW TO USE:
+ *        1. build with host/ in the include path, eg:
+ *              gcc -Ihost -I. -o app main.c dbger.c SEGGER_RTT.c host/uart_sim.c -lpthread
+ *        2. environment:
+ *              UART_SIM_BAUD=115200     baud rate of the wire, 10 bits per byte (Default: 115200)
+ *              UART_SIM_OUT=uart.log    file for the wire output (Default: stdout)
+ *              UART_SIM_BUSY=n          every n-th DMA start fails with HAL_BUSY, like a UART taken by other code (Default: 0, never)
+ *
+ * @author	shadowthreed@gmail.com
+ * @date	20261017
+ */
+#include "usart.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+UART_HandleTypeDef huart1;
+
+static pthread_t uart_sim_thread;
+static pthread_mutex_t uart_sim_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t uart_sim_cond = PTHREAD_COND_INITIALIZER;
+static const uint8_t *uart_sim_data;		// DMA source, NULL: DMA is idle
+static uint16_t uart_sim_size;
+static unsigned uart_sim_busy, uart_sim_starts;
+
+// hold the caller for the time the bytes need on the wire, then output them
+static void uart_sim_wire(UART_HandleTypeDef *huart, const uint8_t *data, uint16_t size)
+{
+	uint64_t ns = (uint64_t)size * 10u * 1000000000u / huart->Init.BaudRate;
+	struct timespec ts = { (time_t)(ns / 1000000000u), (long)(ns % 1000000000u) };
+
+	nanosleep(&ts, NULL);
+	while(size) {
+		ssize_t n = write(huart->fd, data, size);
+		if(n <= 0) {
+			break;
+		}
+		data += n;
+		size -= (uint16_t)n;
+	}
+}
+
+static void *uart_sim_dma(void *arg)
+{
+	const uint8_t *data;
+	uint16_t size;
+
+	(void)arg;
+	for(;;) {
+		pthread_mutex_lock(&uart_sim_mutex);
+		while(uart_sim_data == NULL) {
+			pthread_cond_wait(&uart_sim_cond, &uart_sim_mutex);
+		}
+		data = uart_sim_data;
+		size = uart_sim_size;
+		pthread_mutex_unlock(&uart_sim_mutex);
+
+		uart_sim_wire(&huart1, data, size);
+
+		pthread_mutex_lock(&uart_sim_mutex);
+		uart_sim_data = NULL;
+		pthread_mutex_unlock(&uart_sim_mutex);
+		HAL_UART_TxCpltCallback(&huart1);		// "DMA interrupt"
+	}
+	return NULL;
+}
+
+void MX_USART1_UART_Init(void)
+{
+	const char *baud = getenv("UART_SIM_BAUD");
+	const char *out = getenv("UART_SIM_OUT");
+	const char *busy = getenv("UART_SIM_BUSY");
+
+	huart1.Init.BaudRate = baud ? (uint32_t)strtoul(baud, NULL, 0) : 115200u;
+	if(huart1.Init.BaudRate == 0) {
+		huart1.Init.BaudRate = 115200u;
+	}
+	huart1.fd = out ? open(out, O_WRONLY | O_CREAT | O_TRUNC, 0644) : STDOUT_FILENO;
+	if(huart1.fd < 0) {
+		huart1.fd = STDOUT_FILENO;
+	}
+	uart_sim_busy = busy ? (unsigned)strtoul(busy, NULL, 0) : 0;
+	pthread_create(&uart_sim_thread, NULL, uart_sim_dma, NULL);
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+	(void)Timeout;
+	uart_sim_wire(huart, pData, Size);
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size)
+{
+	HAL_StatusTypeDef r = HAL_OK;
+
+	(void)huart;
+	pthread_mutex_lock(&uart_sim_mutex);
+	if(uart_sim_data != NULL || (uart_sim_busy && ++uart_sim_starts % uart_sim_busy == 0)) {
+		r = HAL_BUSY;
+	} else {
+		uart_sim_data = pData;
+		uart_sim_size = Size;
+		pthread_cond_signal(&uart_sim_cond);
+	}
+	pthread_mutex_unlock(&uart_sim_mutex);
+	return r;
+}
+
+__attribute__((weak)) void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+	(void)huart;
+}
@@ -0,0 +1,46 @@
+/**
+ * @file	usart.h
+ * @brief	Linux stand-in for the CubeMX usart.h, only what dbger.c needs for LOG_BY_UART.
+ *			The UART and its DMA are simulated by host/uart_sim.c.
+ *
+ * @author	shadowthreed@gmail.com
+ * @date	20261017
+ */
+#ifndef __USART_H__
+#define __USART_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+typedef enum {
+	HAL_OK = 0,
+	HAL_ERROR,
+	HAL_BUSY,
+	HAL_TIMEOUT
+} HAL_StatusTypeDef;
+
+typedef struct {
+	uint32_t BaudRate;
+} UART_InitTypeDef;
+
+typedef struct {
+	UART_InitTypeDef Init;
+	int fd;						// the "wire": bytes are written to this fd at BaudRate / 10 bytes per second
+} UART_HandleTypeDef;
+
+extern UART_HandleTypeDef huart1;
+
+void MX_USART1_UART_Init(void);
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size);
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __USART_H__